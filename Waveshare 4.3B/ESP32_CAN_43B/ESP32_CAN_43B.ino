@@ -21,14 +21,35 @@ using namespace esp_panel::board;
 
 // Core Includes
 #include "src/core/bms_data_types.h"
+#include "src/core/seqlock_snapshot.h"
+#include "src/core/deferred_log.h"
 #include "src/hardware/can_driver.h"
+#include "src/hardware/can_tx_scheduler.h"
 #include "src/managers/protocol_manager.h"
+#include "src/managers/daly_poller.h"
 
 // Protocol Includes
 #include "src/protocols/protocol_base_can.h"
 #include "src/protocols/pylontech_can.h"
 #include "src/protocols/jk_bms_can.h"
 #include "src/protocols/daly_can.h"
+#include "src/protocols/daly_poll_can.h"
+
+// Aus DBC-Dateien generierte Protokolle (host: make dbc)
+// #define BMS_ENABLE_DBC_PROTOCOLS
+#ifdef BMS_ENABLE_DBC_PROTOCOLS
+#include "src/protocols/generated/dbc_protocols.h"
+#endif
+
+// Diagnose
+#include "src/diagnostics/can_bus_monitor.h"
+#include "src/diagnostics/can_capture.h"
+
+// Benchmarks
+#include "src/bench/can_dispatch_bench.h"
+#include "src/bench/protocol_dispatch_bench.h"
+#include "src/bench/signal_decode_bench.h"
+#include "src/bench/field_extract_bench.h"
 
 // LVGL Port
 #include "lvgl_v8_port.h"
@@ -42,20 +63,45 @@ using namespace esp_panel::board;
 
 // Hardware
 CanDriver canDriver;
+CanTxScheduler txScheduler;
+CanBusMonitor busMonitor;
+CanCapture canCapture;
 Board* panel = nullptr;
 
 // Protokolle
 PylontechCan pylontechProtocol;
 JkBmsCan jkBmsProtocol;
 DalyCan dalyProtocol;
+DalyPollCan dalyPollProtocol;
+#ifdef BMS_ENABLE_DBC_PROTOCOLS
+DbcProtocolBundle<DBC_PROTOCOLS> dbcProtocols;
+#endif
 ProtocolManager protocolManager;
 
 // UI
 UIManager* uiManager = nullptr;
 
-// BMS Daten
-bms_data_t currentBmsData;
-bool dataValid = false;
+// BMS Daten: veröffentlicht vom Decode-Task, gelesen in loop() und UI.
+// connected = false bedeutet keine gültigen Daten.
+SeqlockSnapshot<bms_data_t> bmsSnapshot;
+
+// RX-Zeit des letzten Frames, auch bei unveränderten Nutzdaten (ohne neue Version)
+std::atomic<uint32_t> bmsLastFrameMs(0);
+
+// Hardware-Filter muss neu berechnet werden (aktives Protokoll gewechselt)
+volatile bool canFilterUpdatePending = false;
+
+// Neue CAN-Baudrate aus der UI (0 = keine Änderung ausstehend)
+volatile uint32_t canBaudratePending = 0;
+
+// Sniffer-Modus: Listen-Only, Accept-All, Mitschnitt läuft
+bool canSnifferMode = false;
+
+// Periodisches Pylontech Keep-Alive (Gateway-Betrieb, standardmäßig aus)
+int pylontechKeepAlive = -1;
+
+// DALY Request/Response-Abfrage (sendet auf den Bus, standardmäßig aus)
+DalyPoller dalyPoller;
 
 // ============================================================================
 // Konfiguration
@@ -65,10 +111,22 @@ struct AppConfig {
     static constexpr uint8_t CAN_TX_PIN = 12;
     static constexpr uint8_t CAN_RX_PIN = 13;
     static constexpr uint32_t CAN_BAUDRATE = 500000;
+    static constexpr uint32_t CAN_RX_RING_DEPTH = 256;     // Frames zwischen RX- und Decode-Task
+    static constexpr uint32_t CAN_CYCLE_DEADLINE = 1000;   // Max. Dauer eines BMS-Sendezyklus
+    static constexpr uint32_t LOG_RING_DEPTH = 128;        // Log-Einträge bis zur Ausgabe (32 Byte)
     static constexpr uint32_t DATA_DISPLAY_INTERVAL = 1000;
     static constexpr uint32_t STATUS_UPDATE_INTERVAL = 500;  // Status alle 500ms
     static constexpr uint32_t STATS_INTERVAL = 10000;
+    static constexpr uint32_t MONITOR_INTERVAL = 1000;      // Bus-Monitor Raten/Buslast
     static constexpr uint32_t DATA_TIMEOUT = 5000;
+    static constexpr uint32_t CAPTURE_PRE_FRAMES = 1000;    // Mitschnitt vor dem Trigger
+    static constexpr uint32_t CAPTURE_POST_FRAMES = 1000;   // Mitschnitt nach dem Trigger
+    static constexpr uint8_t DALY_POLL_FIRST_ADDRESS = 0x01; // BMS-Adressen der DALY-Packs
+    static constexpr uint8_t DALY_POLL_PACKS = 1;
+    static constexpr uint32_t DALY_POLL_INTERVAL = 1000;   // Runde je Pack
+    static constexpr uint32_t DALY_POLL_TIMEOUT = 100;     // Antwort-Timeout je Anfrage
+    static constexpr uint8_t DALY_POLL_RETRIES = 2;
+    static constexpr uint8_t DALY_POLL_WINDOW = 8;         // Offene Anfragen über alle Packs
 };
 
 // Debug Flag (kann auskommentiert werden)
@@ -78,41 +136,206 @@ struct AppConfig {
 // CAN Callbacks
 // ============================================================================
 
-void onCanMessageReceived(uint32_t canId, const uint8_t* data, uint8_t length) {
+// Läuft im CAN Decode-Task, nicht im RX-Task - darf blockieren
+void onCanMessageReceived(const CanFrame& frame) {
     #ifdef DEBUG_CAN_MESSAGES
-    Serial.printf("[CAN RX] ID: 0x%03X, LEN: %d, DATA: ", canId, length);
-    for (int i = 0; i < length; i++) {
-        Serial.printf("%02X ", data[i]);
+    Serial.printf("[CAN RX] %lld us ID: 0x%03X%s%s, LEN: %d, DATA: ", 
+                 frame.timestampUs, frame.id,
+                 frame.isExtended() ? " EXT" : "", frame.isRtr() ? " RTR" : "",
+                 frame.length);
+    for (int i = 0; i < frame.length; i++) {
+        Serial.printf("%02X ", frame.data[i]);
     }
     Serial.println();
     #endif
     
+    // DALY-Antworten der offenen Anfrage zuordnen (nur bei aktiver Abfrage)
+    dalyPoller.onFrame(frame);
+    
     // An Protocol Manager weiterleiten
-    bool processed = protocolManager.routeMessage(canId, data, length);
+    bool updated;
+    bool processed = protocolManager.routeMessage(frame, updated);
     
+    if (processed && updated) {
+        // Sendezyklus abgeschlossen: einen konsistenten Stand veröffentlichen,
+        // die UI liest den Schnappschuss in loop()
+        bms_data_t data;
+        protocolManager.getData(data);
+        bmsSnapshot.publish(data);
+    }
     if (processed) {
-        // Daten vom aktiven Protokoll holen
-        dataValid = protocolManager.getData(currentBmsData);
-        
-        // UI aktualisieren wenn auf BMS Data Screen
-        if (uiManager && dataValid && uiManager->getCurrentScreen() == SCREEN_BMS_DATA) {
-            uiManager->updateBmsData(currentBmsData);
-        }
+        // Unveränderte Nutzdaten: Werte gelten weiter, nur das Alter zurücksetzen
+        bmsLastFrameMs.store((uint32_t)(frame.timestampUs / 1000), std::memory_order_relaxed);
     }
 }
 
+/**
+ * @brief Liest den aktuellen BMS-Schnappschuss (beliebiger Task)
+ * @return false wenn keine gültigen Daten vorliegen
+ */
+bool readBmsData(bms_data_t& data) {
+    bmsSnapshot.read(data);
+    if (!data.connected) {
+        return false;
+    }
+    
+    uint32_t lastFrame = bmsLastFrameMs.load(std::memory_order_relaxed);
+    if ((int32_t)(lastFrame - data.last_update) > 0) {
+        data.last_update = lastFrame;
+    }
+    return true;
+}
+
+// Läuft im CAN RX-Task für jeden Frame - nur schnelle, nicht blockierende Abgriffe
+void onCanRxTap(const CanFrame& frame) {
+    busMonitor.recordFrame(frame);
+    canCapture.recordFrame(frame);
+}
+
+// Läuft im DALY Abfrage-Task
+void sendDalyPollRequest(const CanFrame& frame) {
+    txScheduler.enqueue(frame);
+}
+
 void onCanError(twai_state_t state) {
+    // Läuft im CAN Alert-Task. Die Bus-Off Recovery macht der Treiber
+    // selbst, die UI zeigt den Zustand beim nächsten Status-Update.
     Serial.printf("[CAN ERROR] State: %d\n", state);
+}
+
+void onProtocolChange(CanProtocolBase* protocol) {
+    // Nicht direkt umkonfigurieren - läuft im CAN Decode-Task (Lock-In
+    // beim Parsen, Stille, Revalidierung und Kommando-Anfragen im Tick).
+    // Der Filter wird im nächsten loop()-Durchlauf gesetzt; er ändert
+    // sich nur beim Wechsel zwischen Auto-Detection und manueller Wahl.
+    canFilterUpdatePending = true;
+}
+
+/**
+ * @brief Aktuelle Filterliste: leer (alles) im Sniffer-Modus, sonst
+ *        die IDs der Protokolle
+ */
+size_t getCanFilters(CanIdFilter* filters) {
+    if (canSnifferMode) {
+        return 0;  // Sniffer sieht alles
+    }
+    return protocolManager.getIdFilters(filters, CanFilterCalculator::MAX_FILTERS);
+}
+
+/**
+ * @brief Setzt den CAN-Hardwarefilter passend zu den Protokollen
+ * 
+ * Auto-Detection: Filter über alle registrierten Protokolle, auch nach
+ * dem Lock-In. Manuelle Auswahl: nur die IDs des gewählten Protokolls.
+ */
+void applyCanFilters() {
+    CanIdFilter filters[CanFilterCalculator::MAX_FILTERS];
+    size_t count = getCanFilters(filters);
+    canDriver.setAcceptanceFilters(filters, count);
+}
+
+/**
+ * @brief Schaltet den passiven Sniffer-Modus um
+ * 
+ * Ein: Listen-Only (kein ACK, kein Senden), Hardware-Filter offen,
+ * Mitschnitt wird gestartet. Aus: Normalbetrieb mit Protokoll-Filtern,
+ * der Mitschnitt bleibt für den Export erhalten. Filter und Modus
+ * werden mit einer Neuinstallation des Treibers übernommen.
+ */
+void setSnifferMode(bool enabled) {
+    if (enabled == canSnifferMode) {
+        return;
+    }
     
-    if (state == TWAI_STATE_BUS_OFF) {
-        Serial.println("[CAN] Bus-Off detected, attempting recovery...");
-        canDriver.stop();
-        delay(100);
-        canDriver.start();
-        
-        if (uiManager) {
-            uiManager->updateCanStatus("Bus-Off - Recovery attempted");
+    canSnifferMode = enabled;
+    CanIdFilter filters[CanFilterCalculator::MAX_FILTERS];
+    size_t count = getCanFilters(filters);
+    
+    if (enabled) {
+        canDriver.reconfigure(canDriver.getBaudrate(), TWAI_MODE_LISTEN_ONLY, filters, count);
+        canCapture.arm();
+        Serial.println("[Sniffer] ON - listen-only, capturing all frames");
+    } else {
+        canCapture.stop();
+        canDriver.reconfigure(canDriver.getBaudrate(), TWAI_MODE_NORMAL, filters, count);
+        Serial.println("[Sniffer] OFF - normal mode");
+    }
+}
+
+/**
+ * @brief Parst einen Trigger: <id>[/<mask>] [Nutzdaten-Muster]
+ * 
+ * ID und Maske hexadezimal, IDs > 0x7FF gelten als 29 Bit. Das Muster
+ * ist eine Hex-Bytefolge, "??" steht für ein beliebiges Byte,
+ * z.B. "capture trig 351 ????10".
+ */
+bool parseCaptureTrigger(const char* text, CanCaptureTrigger& trigger) {
+    memset(&trigger, 0, sizeof(trigger));
+    
+    char* end = nullptr;
+    trigger.id = strtoul(text, &end, 16);
+    if (end == text) {
+        return false;
+    }
+    
+    trigger.extended = trigger.id > CAN_STD_ID_MASK;
+    trigger.matchExtended = true;
+    trigger.idMask = trigger.extended ? CAN_EXT_ID_MASK : CAN_STD_ID_MASK;
+    
+    if (*end == '/') {
+        trigger.idMask = strtoul(end + 1, &end, 16);
+    }
+    
+    while (*end == ' ') {
+        end++;
+    }
+    
+    for (uint8_t i = 0; i < 8 && end[0] && end[1]; i++, end += 2) {
+        if (end[0] == '?' && end[1] == '?') {
+            continue;
         }
+        char byteText[3] = { end[0], end[1], '\0' };
+        char* byteEnd = nullptr;
+        trigger.data[i] = (uint8_t)strtoul(byteText, &byteEnd, 16);
+        if (byteEnd != byteText + 2) {
+            return false;
+        }
+        trigger.dataMask[i] = 0xFF;
+    }
+    return true;
+}
+
+/**
+ * @brief Serial-Kommandos "capture ..."
+ */
+void handleCaptureCommand(const String& args) {
+    if (args == "arm") {
+        if (canCapture.clearTrigger()) {
+            canCapture.arm();
+        }
+    }
+    else if (args.startsWith("trig ")) {
+        CanCaptureTrigger trigger;
+        if (parseCaptureTrigger(args.substring(5).c_str(), trigger)) {
+            if (canCapture.setTrigger(trigger, AppConfig::CAPTURE_PRE_FRAMES,
+                                      AppConfig::CAPTURE_POST_FRAMES)) {
+                canCapture.arm();
+            }
+        } else {
+            Serial.println("[CMD] Usage: capture trig <id>[/<mask>] [pattern, ?? = any byte]");
+        }
+    }
+    else if (args == "stop") {
+        canCapture.stop();
+    }
+    else if (args == "dump") {
+        canCapture.startExport();
+    }
+    else if (args == "status") {
+        canCapture.printStatus();
+    }
+    else {
+        Serial.println("[CMD] Usage: capture arm|trig|stop|dump|status");
     }
 }
 
@@ -120,24 +343,40 @@ void onCanError(twai_state_t state) {
 // Hardware-Konfigurations-Callbacks (von UI aufgerufen)
 // ============================================================================
 void onCanBaudrateChange(uint32_t newBaudrate) {
+    // Läuft im LVGL-Kontext - Umkonfiguration im nächsten loop()-Durchlauf
     Serial.printf("[Config] Changing CAN baudrate to %lu...\n", newBaudrate);
+    canBaudratePending = newBaudrate;
+}
+
+/**
+ * @brief Übernimmt eine neue CAN-Baudrate im laufenden Betrieb
+ */
+void applyCanBaudrate(uint32_t baudrate) {
+    if (canDriver.reconfigure(baudrate)) {
+        busMonitor.setBitrate(baudrate);
+        Serial.printf("[Config] CAN running at %lu bps\n", baudrate);
+    } else {
+        Serial.println("[Config] ERROR: CAN reconfiguration failed!");
+    }
+}
+
+/**
+ * @brief Sucht die Baudrate des Busses (Listen-Only Sweep)
+ */
+void runCanAutoBaud() {
+    CanBaudProbe probes[4];
+    uint32_t baudrate = canDriver.detectBaudrate(probes, 4);
+    busMonitor.setBitrate(canDriver.getBaudrate());
     
-    // CAN stoppen
-    canDriver.stop();
-    delay(100);
-    
-    // Neu initialisieren mit neuer Baudrate
-    if (canDriver.init(AppConfig::CAN_TX_PIN, AppConfig::CAN_RX_PIN, newBaudrate)) {
-        canDriver.setMessageCallback(onCanMessageReceived);
-        canDriver.setErrorCallback(onCanError);
-        
-        if (canDriver.start()) {
-            Serial.println("[Config] CAN restarted with new baudrate");
+    if (uiManager) {
+        char statusText[100];
+        if (baudrate) {
+            snprintf(statusText, sizeof(statusText), "Auto-baud: %lu bps detected", baudrate);
         } else {
-            Serial.println("[Config] ERROR: CAN start failed!");
+            snprintf(statusText, sizeof(statusText), "Auto-baud: no traffic, keeping %lu bps",
+                    canDriver.getBaudrate());
         }
-    } else {
-        Serial.println("[Config] ERROR: CAN init failed!");
+        uiManager->updateCanStatus(statusText);
     }
 }
 
@@ -222,6 +461,13 @@ bool initializeSystem() {
     Serial.println("    Waveshare ESP32-S3-Touch-LCD-4.3B");
     Serial.println("========================================\n");
     
+    // Log-Ausgaben aus Decode-Pfad und ProtocolManager über eigenen Task,
+    // der CAN Decode-Task wartet nie auf den UART
+    if (!DeferredLog::instance().init(AppConfig::LOG_RING_DEPTH) ||
+        !DeferredLog::instance().startTask()) {
+        Serial.println("[Init] WARNING: Deferred log unavailable, logging directly");
+    }
+    
     // Schritt 0: PSRAM Check (KRITISCH!)
     Serial.println("[Init] Step 0: PSRAM Check...");
     if (!psramFound()) {
@@ -249,10 +495,17 @@ bool initializeSystem() {
     
     // Schritt 2: Protokolle registrieren
     Serial.println("[Init] Step 2: Registering protocols...");
+#ifdef BMS_ENABLE_DBC_PROTOCOLS
+    // Zuerst: bei überlappenden IDs gewinnt die DBC-Beschreibung
+    dbcProtocols.registerAll(protocolManager);
+#endif
     protocolManager.registerProtocol(&pylontechProtocol);
     protocolManager.registerProtocol(&jkBmsProtocol);
     protocolManager.registerProtocol(&dalyProtocol);
+    protocolManager.registerProtocol(&dalyPollProtocol);
     Serial.printf("[Init] Registered %d protocols\n", protocolManager.getProtocolCount());
+    protocolManager.setProtocolChangeCallback(onProtocolChange);
+    protocolManager.setCycleDeadline(AppConfig::CAN_CYCLE_DEADLINE);
     
     // Schritt 3: Protokolle initialisieren
     Serial.println("[Init] Step 3: Initializing protocols...");
@@ -264,13 +517,18 @@ bool initializeSystem() {
     
     // Schritt 4: CAN Bus initialisieren
     Serial.println("[Init] Step 4: Initializing CAN...");
+    canDriver.setRxRingDepth(AppConfig::CAN_RX_RING_DEPTH);
+    applyCanFilters();
     if (!canDriver.init(AppConfig::CAN_TX_PIN, AppConfig::CAN_RX_PIN, AppConfig::CAN_BAUDRATE)) {
         Serial.println("[Init] ERROR: CAN initialization failed!");
         return false;
     }
     
-    canDriver.setMessageCallback(onCanMessageReceived);
-    canDriver.setErrorCallback(onCanError);
+    canDriver.setMessageSink(CanMessageSink::function<onCanMessageReceived>());
+    canDriver.setErrorSink(CanErrorSink::function<onCanError>());
+    canDriver.setRxTapSink(CanMessageSink::function<onCanRxTap>());
+    canDriver.setTickSink(CanTickSink::member<ProtocolManager, &ProtocolManager::update>(&protocolManager));
+    busMonitor.setBitrate(AppConfig::CAN_BAUDRATE);
     Serial.println("[Init] Step 4: CAN OK");
     
     // Schritt 5: CAN starten
@@ -281,6 +539,22 @@ bool initializeSystem() {
     }
     Serial.println("[Init] Step 5: CAN Started");
     
+    // TX-Scheduler mit (deaktiviertem) Pylontech Keep-Alive
+    if (txScheduler.begin(&canDriver)) {
+        CanFrame keepAlive = {};
+        keepAlive.id = PylontechCan::ID_INVERTER_KEEPALIVE;
+        keepAlive.length = 8;
+        pylontechKeepAlive = txScheduler.addPeriodic(keepAlive, PylontechCan::KEEPALIVE_PERIOD_MS, false);
+        
+        // DALY-Abfrage vorbereiten, gestartet wird sie per Kommando
+        dalyPoller.setPackRange(AppConfig::DALY_POLL_FIRST_ADDRESS, AppConfig::DALY_POLL_PACKS);
+        dalyPoller.setTiming(AppConfig::DALY_POLL_INTERVAL, AppConfig::DALY_POLL_TIMEOUT,
+                             AppConfig::DALY_POLL_RETRIES, AppConfig::DALY_POLL_WINDOW);
+        if (dalyPoller.begin(Sink<const CanFrame&>::function<sendDalyPollRequest>())) {
+            dalyPoller.startTask();
+        }
+    }
+    
     // Schritt 6: Protokolle starten
     Serial.println("[Init] Step 6: Starting protocols...");
     if (!protocolManager.startAll()) {
@@ -324,7 +598,8 @@ bool initializeSystem() {
 // Serial Commands
 // ============================================================================
 void displayBmsData() {
-    if (!dataValid) {
+    bms_data_t currentBmsData;
+    if (!readBmsData(currentBmsData)) {
         Serial.println("[BMS] No valid data available");
         return;
     }
@@ -332,7 +607,6 @@ void displayBmsData() {
     uint32_t age = millis() - currentBmsData.last_update;
     if (age > AppConfig::DATA_TIMEOUT) {
         Serial.println("[BMS] Data timeout!");
-        dataValid = false;
         return;
     }
     
@@ -345,6 +619,14 @@ void displayBmsData() {
     Serial.printf  ("║ SOC:        %6.1f %%                 ║\n", currentBmsData.soc);
     Serial.printf  ("║ Temp:       %6.1f °C                 ║\n", currentBmsData.temperature);
     Serial.printf  ("║ Cycles:     %6u                      ║\n", currentBmsData.cycles);
+    
+    const BmsCellStore& cells = currentBmsData.cells;
+    if (cells.getCellCount() > 0) {
+        Serial.printf  ("║ Cells:      %6u                    ║\n", (unsigned)cells.getCellCount());
+        Serial.printf  ("║ Cell min:   %6u mV (#%-2u)           ║\n", (unsigned)cells.getMinMv(), cells.getWeakestCell() + 1u);
+        Serial.printf  ("║ Cell max:   %6u mV (#%-2u)           ║\n", (unsigned)cells.getMaxMv(), cells.getStrongestCell() + 1u);
+        Serial.printf  ("║ Cell delta: %6u mV                 ║\n", (unsigned)cells.getDeltaMv());
+    }
     Serial.printf  ("║ Status:     %-25s ║\n", currentBmsData.status_text);
     Serial.printf  ("║ Age:        %6lu ms                  ║\n", age);
     Serial.println("╚═══════════════════════════════════════╝\n");
@@ -357,12 +639,42 @@ void displayStatistics() {
     Serial.println("========================================");
     
     // CAN Stats
-    uint32_t rx, tx, err;
-    canDriver.getStats(rx, tx, err);
-    Serial.printf("CAN: RX=%lu, TX=%lu, ERR=%lu\n", rx, tx, err);
+    CanDriverStats canStats;
+    canDriver.getStats(canStats);
+    Serial.printf("CAN: RX=%lu, TX=%lu (done %lu, failed %lu, pending %lu), ERR=%lu\n", 
+                 canStats.rxCount, canStats.txCount, canStats.txDone,
+                 canStats.txFailed, canStats.txPending, canStats.errorCount);
+    Serial.printf("CAN RX Ring: %lu/%lu, HWM=%lu, Overflows=%lu\n",
+                 canStats.ringFill, canStats.ringDepth,
+                 canStats.ringHighWater, canStats.ringOverflows);
+    
+    // Hardware-Filter: zugestellte Frames vs. von Protokollen verarbeitete
+    uint32_t routed, unrouted;
+    protocolManager.getRoutingStats(routed, unrouted);
+    Serial.printf("CAN HW Filter: %s, delivered=%lu, relevant=%lu, filtered in SW=%lu (%.1f%% relevant)\n",
+                 canStats.filterActive ? "active" : "accept all",
+                 canStats.rxCount, routed, unrouted,
+                 canStats.rxCount ? (100.0f * routed / canStats.rxCount) : 0.0f);
+    Serial.printf("CAN RX Rate: %lu frames/s, Bursts=%lu (last %lu, max %lu)\n",
+                 canStats.framesPerSecond, canStats.burstCount,
+                 canStats.lastBurst, canStats.maxBurst);
+    Serial.printf("CAN Bus: %s, Bus errors=%lu, Err-passive=%lu, Bus-off=%lu, Recovered=%lu (last %lu ms, max %lu ms)\n",
+                 CanDriver::getRecoveryStateName(canStats.recoveryState),
+                 canStats.busErrorCount, canStats.errorPassiveCount,
+                 canStats.busOffCount, canStats.recoveryCount,
+                 canStats.lastRecoveryMs, canStats.maxRecoveryMs);
+    
+    // Bus-Monitor (Buslast, Raten und Jitter pro ID)
+    busMonitor.printStats();
     
     // Protocol Detection Stats
     protocolManager.printDetectionStats();
+    Serial.printf("BMS snapshot: version %lu, read retries %lu\n",
+                 bmsSnapshot.getVersion(), bmsSnapshot.getReadRetries());
+    DeferredLog::instance().printStats();
+    if (dalyPoller.isEnabled()) {
+        dalyPoller.printStats();
+    }
     
     // Aktives Protokoll
     auto* active = protocolManager.getActiveProtocol();
@@ -386,12 +698,21 @@ void handleSerialCommands() {
         Serial.println("\n=== BMS Monitor Commands ===");
         Serial.println("data       - Show current BMS data");
         Serial.println("stats      - Show statistics");
+        Serial.println("packs      - Show BMS packs and bank summary");
         Serial.println("reset      - Reset statistics");
         Serial.println("detect     - Enable auto-detection");
         Serial.println("pylontech  - Select Pylontech protocol");
         Serial.println("jk         - Select JK BMS protocol");
         Serial.println("daly       - Select DALY protocol");
         Serial.println("debug      - Toggle debug output");
+        Serial.println("bench      - Run CAN microbenchmarks");
+        Serial.println("baud <bps> - Change CAN baudrate");
+        Serial.println("autobaud   - Detect CAN baudrate (listen-only sweep)");
+        Serial.println("sniff on|off - Passive listen-only sniffer with capture");
+        Serial.println("keepalive on|off - Send Pylontech 0x305 keep-alive");
+        Serial.println("txstats    - Show CAN TX scheduler statistics");
+        Serial.println("dalypoll on|off|stats - Poll DALY packs (request/response)");
+        Serial.println("capture arm|trig <id>[/<mask>] [pattern]|stop|dump|status");
         Serial.println("help       - Show this help");
         Serial.println("============================\n");
     }
@@ -401,8 +722,14 @@ void handleSerialCommands() {
     else if (cmd == "stats") {
         displayStatistics();
     }
+    else if (cmd == "packs") {
+        protocolManager.getPackTable().printPacks();
+    }
     else if (cmd == "reset") {
         canDriver.resetStats();
+        busMonitor.reset();
+        txScheduler.resetStats();
+        dalyPoller.resetStats();
         protocolManager.resetStats();
         Serial.println("[CMD] Statistics reset");
     }
@@ -431,6 +758,46 @@ void handleSerialCommands() {
             Serial.println("[CMD] ERROR: Failed to select DALY");
         }
     }
+    else if (cmd == "bench") {
+        CanDispatchBench::run();
+        ProtocolDispatchBench::run();
+        SignalDecodeBench::run();
+        FieldExtractBench::run();
+    }
+    else if (cmd.startsWith("baud ")) {
+        applyCanBaudrate((uint32_t)cmd.substring(5).toInt());
+    }
+    else if (cmd == "autobaud") {
+        runCanAutoBaud();
+    }
+    else if (cmd == "sniff on") {
+        setSnifferMode(true);
+    }
+    else if (cmd == "sniff off") {
+        setSnifferMode(false);
+    }
+    else if (cmd == "keepalive on" || cmd == "keepalive off") {
+        bool enabled = (cmd == "keepalive on");
+        if (txScheduler.setPeriodicEnabled(pylontechKeepAlive, enabled)) {
+            Serial.printf("[CMD] Pylontech keep-alive %s\n", enabled ? "ON" : "OFF");
+        } else {
+            Serial.println("[CMD] ERROR: TX scheduler not available");
+        }
+    }
+    else if (cmd == "txstats") {
+        txScheduler.printStats();
+    }
+    else if (cmd == "dalypoll on" || cmd == "dalypoll off") {
+        bool enabled = (cmd == "dalypoll on");
+        dalyPoller.setEnabled(enabled);
+        Serial.printf("[CMD] DALY polling %s\n", enabled ? "ON" : "OFF");
+    }
+    else if (cmd == "dalypoll stats") {
+        dalyPoller.printStats();
+    }
+    else if (cmd.startsWith("capture ")) {
+        handleCaptureCommand(cmd.substring(8));
+    }
     else if (cmd == "debug") {
         #ifdef DEBUG_CAN_MESSAGES
         Serial.println("[CMD] Debug mode is currently ON");
@@ -468,16 +835,50 @@ void loop() {
     static uint32_t lastDisplay = 0;
     static uint32_t lastStats = 0;
     static uint32_t lastStatusUpdate = 0;
+    static uint32_t lastMonitorUpdate = 0;
+    static uint32_t uiBmsVersion = 0;
     uint32_t now = millis();
     
     // Serial-Kommandos verarbeiten
     handleSerialCommands();
     
+    // Laufenden Mitschnitt-Export blockweise ausgeben
+    canCapture.serviceExport();
+    
+    // Hardware-Filter nach Protokollwechsel nachführen
+    if (canFilterUpdatePending) {
+        canFilterUpdatePending = false;
+        applyCanFilters();
+    }
+    
+    // Baudratenwechsel aus der UI übernehmen
+    if (canBaudratePending) {
+        uint32_t baudrate = canBaudratePending;
+        canBaudratePending = 0;
+        applyCanBaudrate(baudrate);
+    }
+    
+    // Neue BMS-Daten sofort in die UI übernehmen
+    if (uiManager && bmsSnapshot.changedSince(uiBmsVersion) &&
+        uiManager->getCurrentScreen() == SCREEN_BMS_DATA) {
+        bms_data_t data;
+        uiBmsVersion = bmsSnapshot.getVersion();
+        if (readBmsData(data)) {
+            uiManager->updateBmsData(data);
+        }
+    }
+    
     // Screen Timeout überwachen (Option 4)
     if (uiManager) {
         uiManager->checkInactivityTimeout();
     }
     
+    // Bus-Monitor: Raten und Buslast berechnen
+    if (now - lastMonitorUpdate >= AppConfig::MONITOR_INTERVAL) {
+        lastMonitorUpdate = now;
+        busMonitor.update();
+    }
+    
     // Periodische Status-Updates (Option 5)
     if (now - lastStatusUpdate >= AppConfig::STATUS_UPDATE_INTERVAL) {
         lastStatusUpdate = now;
@@ -488,8 +889,16 @@ void loop() {
             uint32_t rx, tx, err;
             canDriver.getStats(rx, tx, err);
             
+            CanDriverStats canStats;
+            canDriver.getStats(canStats);
+            
             auto* active = protocolManager.getActiveProtocol();
-            if (active) {
+            if (canStats.recoveryState != CAN_RECOVERY_IDLE) {
+                snprintf(statusText, sizeof(statusText), 
+                        "Bus-Off: %s | Recoveries: %lu | ERR: %lu",
+                        CanDriver::getRecoveryStateName(canStats.recoveryState),
+                        canStats.recoveryCount, err);
+            } else if (active) {
                 snprintf(statusText, sizeof(statusText), 
                         "Active: %s | RX: %lu | TX: %lu | ERR: %lu",
                         active->getName(), rx, tx, err);
@@ -500,6 +909,10 @@ void loop() {
             }
             
             uiManager->updateCanStatus(statusText);
+            
+            char monitorText[256];
+            busMonitor.formatSummary(monitorText, sizeof(monitorText));
+            uiManager->updateCanMonitor(monitorText);
         }
     }
     
@@ -507,16 +920,14 @@ void loop() {
     if (now - lastDisplay >= AppConfig::DATA_DISPLAY_INTERVAL) {
         lastDisplay = now;
         
-        if (dataValid) {
+        bms_data_t data;
+        if (readBmsData(data) && now - data.last_update <= AppConfig::DATA_TIMEOUT) {
             // Nur auf Serial ausgeben, nicht im Debug-Modus
             #ifndef DEBUG_CAN_MESSAGES
             displayBmsData();
             #endif
             
-            // UI aktualisieren wenn auf BMS Data Screen
-            if (uiManager && uiManager->getCurrentScreen() == SCREEN_BMS_DATA) {
-                uiManager->updateBmsData(currentBmsData);
-            }
+            // Die UI bekommt neue Daten versionsgesteuert (oben), nicht hier
         } else {
             // Keine Verbindung
             if (uiManager && uiManager->getCurrentScreen() == SCREEN_BMS_DATA) {
@@ -0,0 +1,239 @@
+/**
+ * @file bms_host.cpp
+ * @brief BMS-Monitor als Linux-Prozess (SocketCAN)
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Dieselbe Pipeline wie auf dem ESP32 (ProtocolManager mit Pylontech,
+ * JK BMS und DALY, Bus-Monitor), nur mit SocketCanBus statt CanDriver.
+ * Einsatz als BMS-Daemon auf Linux-Gateways oder für Lasttests ohne
+ * Hardware:
+ *
+ *   ./bms_host vcan0 1000000 &
+ *   cangen vcan0 -g 0 -I 359 -L 8        # Volllast mit Pylontech-ID
+ *
+ * Aufruf: bms_host [interface] [bitrate] [intervall_ms] [--all] [--daly-poll N]
+ *   bitrate   Nominelle Bitrate für die Buslast (Default 500000)
+ *   --all     Kernel-Filter aus, alle Frames gehen durch das Routing
+ *   --daly-poll N  DALY-Packs mit BMS-Adresse 1..N abfragen (Request/Response)
+ *
+ * SPEICHERN ALS: host/bms_host.cpp
+ */
+
+#include <Arduino.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <atomic>
+
+#include "socketcan_bus.h"
+#include "../src/managers/protocol_manager.h"
+#include "../src/protocols/pylontech_can.h"
+#include "../src/protocols/jk_bms_can.h"
+#include "../src/protocols/daly_can.h"
+#include "../src/protocols/daly_poll_can.h"
+#include "../src/managers/daly_poller.h"
+#ifdef BMS_ENABLE_DBC_PROTOCOLS
+#include "../src/protocols/generated/dbc_protocols.h"
+#endif
+#include "../src/diagnostics/can_bus_monitor.h"
+#include "../src/core/seqlock_snapshot.h"
+
+// ============================================================================
+// Globale Objekte
+// ============================================================================
+
+static ProtocolManager protocolManager;
+static PylontechCan pylontechProtocol;
+static JkBmsCan jkBmsProtocol;
+static DalyCan dalyProtocol;
+static DalyPollCan dalyPollProtocol;
+static DalyPoller dalyPoller;
+#ifdef BMS_ENABLE_DBC_PROTOCOLS
+static DbcProtocolBundle<DBC_PROTOCOLS> dbcProtocols;
+#endif
+static CanBusMonitor busMonitor;
+static SeqlockSnapshot<bms_data_t> bmsSnapshot;
+
+static std::atomic<bool> running(true);
+static std::atomic<bool> filterUpdatePending(false);
+static bool acceptAll = false;
+static SocketCanBus* txBus = nullptr;
+
+static constexpr uint32_t LOG_RING_DEPTH = 1024;      // Log-Einträge zwischen zwei drain()
+static constexpr uint32_t POLL_SERVICE_MS = 2;        // Hauptschleife bei aktiver DALY-Abfrage
+
+static void onSignal(int) {
+    running = false;
+}
+
+// Läuft im RX-Thread
+static void onCanRxTap(const CanFrame& frame) {
+    busMonitor.recordFrame(frame);
+}
+
+// Läuft im RX-Thread: decodieren, pro Sendezyklus für den Haupt-Thread veröffentlichen
+static void onCanMessage(const CanFrame& frame) {
+    dalyPoller.onFrame(frame);
+    bool updated;
+    if (protocolManager.routeMessage(frame, updated) && updated) {
+        bms_data_t data;
+        protocolManager.getData(data);
+        bmsSnapshot.publish(data);
+    }
+}
+
+// Läuft in der Hauptschleife (dalyPoller.service())
+static void sendDalyPollRequest(const CanFrame& frame) {
+    txBus->transmit(frame);
+}
+
+// Läuft im RX-Thread (Parsen bzw. protocolManager.update() im Tick)
+static void onProtocolChange(CanProtocolBase* protocol) {
+    filterUpdatePending = true;
+}
+
+static void applyCanFilters(SocketCanBus& bus) {
+    if (acceptAll) {
+        bus.setAcceptanceFilters(nullptr, 0);
+        return;
+    }
+    CanIdFilter filters[SocketCanBus::MAX_KERNEL_FILTERS];
+    size_t count = protocolManager.getIdFilters(filters, SocketCanBus::MAX_KERNEL_FILTERS);
+    bus.setAcceptanceFilters(filters, count);
+}
+
+static void printStatus(const SocketCanBus& bus, uint32_t intervalMs) {
+    static uint32_t lastRx = 0;
+
+    SocketCanStats stats = bus.getStats();
+    uint32_t rate = (uint32_t)((uint64_t)(stats.rxFrames - lastRx) * 1000 / intervalMs);
+    lastRx = stats.rxFrames;
+
+    uint32_t routed, unrouted;
+    uint32_t lastUs, avgUs, maxUs;
+    protocolManager.getRoutingStats(routed, unrouted);
+    protocolManager.getLatencyStats(lastUs, avgUs, maxUs);
+
+    Serial.printf("[Host] %s: RX=%lu (%lu/s), TX=%lu, errors=%lu | routed=%lu, unrouted=%lu | latency avg %lu us, max %lu us | load %.1f%%\n",
+                  bus.getName(), stats.rxFrames, rate, stats.txFrames, stats.rxErrors,
+                  routed, unrouted, avgUs, maxUs, busMonitor.getBusLoad());
+
+    bms_data_t data;
+    uint32_t version = bmsSnapshot.read(data);
+    if (data.connected) {
+        Serial.printf("[BMS] %s: %.2f V, %.1f A, SOC %.1f %%, %.1f °C, %s (v%lu)\n",
+                      getBmsTypeName(data.type), data.voltage, data.current,
+                      data.soc, data.temperature, data.status_text, version);
+        BmsPackTable::printCells(data.cells);
+    }
+    if (protocolManager.getPackTable().getOnlineCount() > 1) {
+        protocolManager.getPackTable().printPacks();
+    }
+    Serial.flush();
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+    const char* ifName = "vcan0";
+    uint32_t bitrate = 500000;
+    uint32_t intervalMs = 1000;
+    uint32_t dalyPacks = 0;
+
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--all") == 0) {
+            acceptAll = true;
+        } else if (strcmp(argv[i], "--daly-poll") == 0 && i + 1 < argc) {
+            dalyPacks = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (positional == 0) {
+            ifName = argv[i];
+            positional++;
+        } else if (positional == 1) {
+            bitrate = (uint32_t)strtoul(argv[i], nullptr, 10);
+            positional++;
+        } else if (positional == 2) {
+            intervalMs = (uint32_t)strtoul(argv[i], nullptr, 10);
+            if (intervalMs == 0) {
+                intervalMs = 1000;
+            }
+            positional++;
+        }
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    Serial.println("\n=== BMS Monitor (host) ===");
+
+#ifdef BMS_ENABLE_DBC_PROTOCOLS
+    dbcProtocols.registerAll(protocolManager);      // Vorrang bei überlappenden IDs
+#endif
+    protocolManager.registerProtocol(&pylontechProtocol);
+    protocolManager.registerProtocol(&jkBmsProtocol);
+    protocolManager.registerProtocol(&dalyProtocol);
+    protocolManager.registerProtocol(&dalyPollProtocol);
+    protocolManager.setProtocolChangeCallback(onProtocolChange);
+    if (!protocolManager.initializeAll() || !protocolManager.startAll()) {
+        Serial.println("[Host] ERROR: Protocol init failed");
+        return 1;
+    }
+    protocolManager.setAutoDetect(true);
+
+    // Decode-Ausgaben aus dem RX-Thread gesammelt in der Hauptschleife
+    DeferredLog::instance().init(LOG_RING_DEPTH);
+
+    SocketCanBus bus(ifName, bitrate);
+    if (!bus.open()) {
+        return 1;
+    }
+    applyCanFilters(bus);
+
+    busMonitor.setBitrate(bus.getBaudrate());
+    bus.setRxTapSink(CanMessageSink::function<onCanRxTap>());
+    bus.setMessageSink(CanMessageSink::function<onCanMessage>());
+    bus.setTickSink(CanTickSink::member<ProtocolManager, &ProtocolManager::update>(&protocolManager));
+
+    if (!bus.start()) {
+        return 1;
+    }
+
+    if (dalyPacks > 0) {
+        txBus = &bus;
+        if (!dalyPoller.setPackRange(DalyPollCan::DEFAULT_BMS_ADDRESS, (uint8_t)dalyPacks) ||
+            !dalyPoller.begin(Sink<const CanFrame&>::function<sendDalyPollRequest>())) {
+            Serial.println("[Host] ERROR: DALY polling setup failed");
+            return 1;
+        }
+        dalyPoller.setEnabled(true);
+    }
+
+    uint32_t lastPrint = millis();
+    while (running) {
+        delay(dalyPoller.isEnabled() ? POLL_SERVICE_MS : 50);
+        dalyPoller.service(esp_timer_get_time());
+        DeferredLog::instance().drain();
+        busMonitor.update();
+
+        if (filterUpdatePending.exchange(false)) {
+            applyCanFilters(bus);
+        }
+
+        if (millis() - lastPrint >= intervalMs) {
+            lastPrint = millis();
+            printStatus(bus, intervalMs);
+        }
+    }
+
+    bus.stop();
+    DeferredLog::instance().drain();
+    busMonitor.printStats();
+    protocolManager.printDetectionStats();
+    if (dalyPacks > 0) {
+        dalyPoller.printStats();
+    }
+    DeferredLog::instance().printStats();
+    return 0;
+}
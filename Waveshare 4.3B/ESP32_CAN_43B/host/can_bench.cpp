@@ -0,0 +1,28 @@
+/**
+ * @file can_bench.cpp
+ * @brief Host-Variante der CAN-Benchmarks
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Aufruf: can_bench [iterationen]
+ *
+ * SPEICHERN ALS: host/can_bench.cpp
+ */
+
+#include <Arduino.h>
+#include <stdlib.h>
+#include "../src/bench/protocol_dispatch_bench.h"
+#include "../src/bench/signal_decode_bench.h"
+#include "../src/bench/field_extract_bench.h"
+
+int main(int argc, char** argv) {
+    uint32_t iterations = 10000000;
+    if (argc > 1) {
+        iterations = (uint32_t)strtoul(argv[1], nullptr, 10);
+    }
+
+    ProtocolDispatchBench::run(iterations);
+    SignalDecodeBench::run(iterations);
+    FieldExtractBench::run(iterations);
+    return 0;
+}
@@ -0,0 +1,313 @@
+/**
+ * @file can_log_reader.h
+ * @brief Leser für CAN-Logdateien (candump -l, Vector ASC)
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Liest Zeile für Zeile, das Format wird pro Zeile erkannt:
+ *
+ *   candump -l:  (1436509052.249713) can0 18FF50E5#0011223344556677
+ *                (auch das Export-Format von CanCapture)
+ *   Vector ASC:     1.234567 1  18FF50E5x       Rx   d 8 00 11 22 ...
+ *
+ * Zeitstempel werden ohne Umweg über double in µs zerlegt, damit auch
+ * absolute Unix-Zeiten exakt bleiben. CAN FD, Fehlerframes und
+ * Kommentare werden übersprungen und gezählt.
+ *
+ * SPEICHERN ALS: host/can_log_reader.h
+ */
+
+#ifndef CAN_LOG_READER_H
+#define CAN_LOG_READER_H
+
+#include <Arduino.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include "../src/core/can_types.h"
+
+/**
+ * @brief Ein Frame aus dem Log
+ */
+struct CanLogRecord {
+    int64_t logTimeUs;              ///< Zeitstempel aus dem Log
+    CanFrame frame;                 ///< timestampUs = 0, setzt der Aufrufer
+};
+
+class CanLogReader {
+public:
+    static constexpr size_t LINE_SIZE = 512;
+    static constexpr size_t READ_BUFFER_SIZE = 1 << 20;
+
+private:
+    FILE* m_file;
+    bool m_ownsFile;
+    bool m_ascHex;                  ///< ASC "base hex" (Default) oder "base dec"
+    char m_line[LINE_SIZE];
+
+    uint64_t m_lines;
+    uint64_t m_frames;
+    uint64_t m_skipped;
+
+    // ========================================================================
+    // Zerlegung
+    // ========================================================================
+
+    static const char* skipSpaces(const char* p) {
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        return p;
+    }
+
+    static int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    /**
+     * @brief "sss.ffffff" -> µs (bis zu 6 Nachkommastellen)
+     */
+    static bool parseTimestamp(const char*& p, int64_t& us) {
+        if (!isdigit((unsigned char)*p)) {
+            return false;
+        }
+        int64_t seconds = 0;
+        while (isdigit((unsigned char)*p)) {
+            seconds = seconds * 10 + (*p++ - '0');
+        }
+        int64_t fraction = 0;
+        int digits = 0;
+        if (*p == '.') {
+            p++;
+            while (isdigit((unsigned char)*p)) {
+                if (digits < 6) {
+                    fraction = fraction * 10 + (*p - '0');
+                    digits++;
+                }
+                p++;
+            }
+        }
+        for (; digits < 6; digits++) {
+            fraction *= 10;
+        }
+        us = seconds * 1000000 + fraction;
+        return true;
+    }
+
+    /**
+     * @brief candump -l: "(sec.usec) iface ID#DATA" bzw. "ID#R[len]"
+     */
+    bool parseCandump(const char* p, CanLogRecord& record) {
+        p++;    // '('
+        if (!parseTimestamp(p, record.logTimeUs) || *p != ')') {
+            return false;
+        }
+        p = skipSpaces(p + 1);
+        while (*p && *p != ' ' && *p != '\t') {
+            p++;    // Interface-Name
+        }
+        p = skipSpaces(p);
+
+        CanFrame& frame = record.frame;
+        uint32_t id = 0;
+        int idDigits = 0;
+        int v;
+        while ((v = hexValue(*p)) >= 0) {
+            id = (id << 4) | v;
+            idDigits++;
+            p++;
+        }
+        if (*p != '#' || idDigits == 0 || p[1] == '#') {
+            return false;   // Kein CAN 2.0 Frame (z.B. CAN FD "##")
+        }
+        p++;
+
+        // candump schreibt 29-Bit IDs immer mit 8 Stellen
+        frame.flags = (idDigits == 8) ? CanFrame::FLAG_EXTENDED : 0;
+        frame.id = id & (frame.isExtended() ? CAN_EXT_ID_MASK : CAN_STD_ID_MASK);
+        frame.length = 0;
+
+        if (*p == 'R' || *p == 'r') {
+            frame.flags |= CanFrame::FLAG_RTR;
+            v = hexValue(p[1]);
+            frame.length = (v >= 0 && v <= 8) ? (uint8_t)v : 0;
+            return true;
+        }
+
+        while (frame.length < 8) {
+            if (*p == '.') {
+                p++;
+            }
+            int hi = hexValue(p[0]);
+            int lo = (hi >= 0) ? hexValue(p[1]) : -1;
+            if (lo < 0) {
+                break;
+            }
+            frame.data[frame.length++] = (uint8_t)((hi << 4) | lo);
+            p += 2;
+        }
+        return true;
+    }
+
+    /**
+     * @brief ASC: "<zeit> <kanal> <id>[x] Rx|Tx d|r <dlc> <bytes...>"
+     */
+    bool parseAsc(const char* p, CanLogRecord& record) {
+        if (!parseTimestamp(p, record.logTimeUs)) {
+            return false;
+        }
+
+        char* end;
+        p = skipSpaces(p);
+        strtoul(p, &end, 10);               // Kanal (CANFD-Zeilen scheitern hier)
+        if (end == p) {
+            return false;
+        }
+        p = skipSpaces(end);
+
+        CanFrame& frame = record.frame;
+        uint32_t id = strtoul(p, &end, m_ascHex ? 16 : 10);
+        if (end == p) {
+            return false;                   // ErrorFrame, Statistic, ...
+        }
+        frame.flags = 0;
+        if (*end == 'x' || *end == 'X') {
+            frame.flags = CanFrame::FLAG_EXTENDED;
+            end++;
+        }
+        if (*end != ' ' && *end != '\t') {
+            return false;
+        }
+        frame.id = id & (frame.isExtended() ? CAN_EXT_ID_MASK : CAN_STD_ID_MASK);
+
+        p = skipSpaces(end);
+        if (strncmp(p, "Rx", 2) != 0 && strncmp(p, "Tx", 2) != 0) {
+            return false;
+        }
+        p = skipSpaces(p + 2);
+
+        char type = *p;
+        if (type != 'd' && type != 'r') {
+            return false;
+        }
+        p = skipSpaces(p + 1);
+
+        unsigned long dlc = strtoul(p, &end, 16);
+        if (end == p) {
+            dlc = 0;                        // "r" ohne DLC
+        }
+        frame.length = dlc > 8 ? 8 : (uint8_t)dlc;
+        p = end;
+
+        if (type == 'r') {
+            frame.flags |= CanFrame::FLAG_RTR;
+            return true;
+        }
+
+        for (uint8_t i = 0; i < frame.length; i++) {
+            p = skipSpaces(p);
+            unsigned long value = strtoul(p, &end, m_ascHex ? 16 : 10);
+            if (end == p) {
+                return false;
+            }
+            frame.data[i] = (uint8_t)value;
+            p = end;
+        }
+        return true;
+    }
+
+public:
+    CanLogReader()
+        : m_file(nullptr)
+        , m_ownsFile(false)
+        , m_ascHex(true)
+        , m_lines(0)
+        , m_frames(0)
+        , m_skipped(0)
+    {
+    }
+
+    ~CanLogReader() {
+        close();
+    }
+
+    /**
+     * @brief Öffnet eine Logdatei ("-" = stdin, z.B. hinter zcat)
+     */
+    bool open(const char* path) {
+        close();
+        if (strcmp(path, "-") == 0) {
+            m_file = stdin;
+            m_ownsFile = false;
+        } else {
+            m_file = fopen(path, "r");
+            m_ownsFile = true;
+        }
+        if (!m_file) {
+            Serial.printf("[LogReader] Cannot open %s: %s\n", path, strerror(errno));
+            return false;
+        }
+        setvbuf(m_file, nullptr, _IOFBF, READ_BUFFER_SIZE);
+        m_ascHex = true;
+        m_lines = 0;
+        m_frames = 0;
+        m_skipped = 0;
+        return true;
+    }
+
+    void close() {
+        if (m_file && m_ownsFile) {
+            fclose(m_file);
+        }
+        m_file = nullptr;
+    }
+
+    /**
+     * @brief Liest den nächsten CAN 2.0 Frame
+     * @return false am Dateiende
+     */
+    bool next(CanLogRecord& record) {
+        if (!m_file) {
+            return false;
+        }
+
+        while (fgets(m_line, sizeof(m_line), m_file)) {
+            m_lines++;
+            const char* p = skipSpaces(m_line);
+            if (*p == '\0' || *p == '\n' || *p == '\r') {
+                continue;
+            }
+
+            memset(&record, 0, sizeof(record));
+
+            bool ok;
+            if (*p == '(') {
+                ok = parseCandump(p, record);
+            } else if (isdigit((unsigned char)*p)) {
+                ok = parseAsc(p, record);
+            } else {
+                // ASC-Kopf ("date", "base hex  timestamps absolute", "Begin Triggerblock", "//")
+                if (strncmp(p, "base ", 5) == 0) {
+                    m_ascHex = (strncmp(skipSpaces(p + 5), "hex", 3) == 0);
+                }
+                continue;
+            }
+
+            if (ok) {
+                m_frames++;
+                return true;
+            }
+            m_skipped++;
+        }
+        return false;
+    }
+
+    uint64_t getLineCount() const { return m_lines; }
+    uint64_t getFrameCount() const { return m_frames; }
+    uint64_t getSkippedCount() const { return m_skipped; }
+};
+
+#endif // CAN_LOG_READER_H
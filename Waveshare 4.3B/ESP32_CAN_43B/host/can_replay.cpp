@@ -0,0 +1,375 @@
+/**
+ * @file can_replay.cpp
+ * @brief Replay von CAN-Logs durch ProtocolManager::routeMessage
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Spielt candump- (-l) und Vector-ASC-Logs in dieselbe Pipeline wie auf
+ * dem ESP32 ein (ProtocolManager mit Pylontech, JK BMS und DALY).
+ *
+ * Ausgaben:
+ *   stdout  Decodierte Snapshots pro Protokoll, nur bei Änderung und mit
+ *           Log-Zeitstempel - deterministisch, als Regressions-Referenz
+ *           für diff geeignet
+ *   stderr  Durchsatz (Frames/s) und Latenz pro Frame (routeMessage)
+ *
+ * Zeitbasis der Pipeline ist die Log-Zeit: RX-Zeitstempel, millis() und
+ * die Ticks an ProtocolManager::update() (alle TICK_INTERVAL_MS, auch in
+ * Lücken des Logs) folgen den Zeitstempeln im Log. Pack-Ablauf, Stille,
+ * Revalidierung und Zyklus-Deadlines verhalten sich daher bei --fast
+ * und --speed N gleich. Nur die Latenz wird in Echtzeit gemessen.
+ *
+ * Aufruf:
+ *   can_replay [--speed N | --fast] [--no-snapshots] [--no-cache] <log | ->
+ *     --speed N        Originaltiming mit Faktor N (Default 1 = Echtzeit)
+ *     --fast           So schnell wie möglich (Durchsatz-Benchmark)
+ *     --no-snapshots   Nur Statistik, kein Snapshot-Vergleich pro Frame
+ *     --no-cache       Payload-Cache aus, jeder Frame wird decodiert
+ *                      (Snapshots müssen identisch sein, make check)
+ *
+ * Beispiele:
+ *   can_replay --fast site42.log > site42.snap && diff site42.ref site42.snap
+ *   zcat site42.log.gz | can_replay --fast --no-snapshots -
+ *
+ * SPEICHERN ALS: host/can_replay.cpp
+ */
+
+#include <Arduino.h>
+#include <stdlib.h>
+
+#include "can_log_reader.h"
+#include "../src/hardware/can_bus.h"
+#include "../src/managers/protocol_manager.h"
+#include "../src/protocols/pylontech_can.h"
+#include "../src/protocols/jk_bms_can.h"
+#include "../src/protocols/daly_can.h"
+#include "../src/protocols/daly_poll_can.h"
+
+// ============================================================================
+// Latenz-Histogramm
+// ============================================================================
+
+/**
+ * @brief Histogramm mit 10 ns Auflösung bis 100 µs
+ *
+ * Feste Buckets statt gespeicherter Einzelwerte, damit auch Logs mit
+ * Milliarden Frames in konstantem Speicher ausgewertet werden.
+ */
+class LatencyHistogram {
+public:
+    static constexpr uint32_t BUCKET_NS = 10;
+    static constexpr uint32_t BUCKET_COUNT = 10000;     ///< 0..100 µs
+
+private:
+    uint64_t m_buckets[BUCKET_COUNT + 1];               ///< + Überlauf
+    uint64_t m_count;
+    uint64_t m_sumNs;
+    uint64_t m_minNs;
+    uint64_t m_maxNs;
+
+public:
+    LatencyHistogram() {
+        reset();
+    }
+
+    void reset() {
+        memset(m_buckets, 0, sizeof(m_buckets));
+        m_count = 0;
+        m_sumNs = 0;
+        m_minNs = UINT64_MAX;
+        m_maxNs = 0;
+    }
+
+    void add(uint64_t ns) {
+        uint64_t bucket = ns / BUCKET_NS;
+        m_buckets[bucket < BUCKET_COUNT ? bucket : BUCKET_COUNT]++;
+        m_count++;
+        m_sumNs += ns;
+        if (ns < m_minNs) m_minNs = ns;
+        if (ns > m_maxNs) m_maxNs = ns;
+    }
+
+    /**
+     * @brief Perzentil als Obergrenze des Buckets in ns
+     */
+    uint64_t percentile(double p) const {
+        if (m_count == 0) {
+            return 0;
+        }
+        uint64_t target = (uint64_t)(p / 100.0 * (double)m_count);
+        if (target >= m_count) {
+            target = m_count - 1;
+        }
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+            seen += m_buckets[i];
+            if (seen > target) {
+                return (uint64_t)(i + 1) * BUCKET_NS;
+            }
+        }
+        return m_maxNs;
+    }
+
+    uint64_t getCount() const { return m_count; }
+    uint64_t getMinNs() const { return m_count ? m_minNs : 0; }
+    uint64_t getMaxNs() const { return m_maxNs; }
+    double getMeanNs() const { return m_count ? (double)m_sumNs / m_count : 0.0; }
+};
+
+// ============================================================================
+// Globale Objekte
+// ============================================================================
+
+static ProtocolManager protocolManager;
+static PylontechCan pylontechProtocol;
+static JkBmsCan jkBmsProtocol;
+static DalyCan dalyProtocol;
+static DalyPollCan dalyPollProtocol;
+
+static CanProtocolBase* const protocols[] = {
+    &pylontechProtocol, &jkBmsProtocol, &dalyProtocol, &dalyPollProtocol
+};
+static constexpr size_t PROTOCOL_COUNT = sizeof(protocols) / sizeof(protocols[0]);
+
+/**
+ * @brief Zuletzt ausgegebener Stand eines Protokolls
+ */
+struct SnapshotState {
+    uint32_t messageCount;
+    bool valid;
+    bms_data_t data;
+};
+
+static SnapshotState snapshots[PROTOCOL_COUNT];
+
+/// Gerätezeit beim ersten Frame, > 0 wie nach dem Boot (0 = "nie")
+static constexpr int64_t REPLAY_START_US = 1000000;
+
+static inline int64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void sleepUntilNs(int64_t deadlineNs) {
+    struct timespec ts;
+    ts.tv_sec = deadlineNs / 1000000000;
+    ts.tv_nsec = deadlineNs % 1000000000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
+
+// ============================================================================
+// Snapshots
+// ============================================================================
+
+/**
+ * @brief Vergleicht die decodierten Werte (ohne Zeitstempel)
+ */
+static bool sameSnapshot(const bms_data_t& a, const bms_data_t& b) {
+    return a.voltage == b.voltage
+        && a.current == b.current
+        && a.soc == b.soc
+        && a.temperature == b.temperature
+        && a.cycles == b.cycles
+        && a.charging == b.charging
+        && a.discharging == b.discharging
+        && strcmp(a.status_text, b.status_text) == 0;
+}
+
+/**
+ * @brief Gibt den Stand jedes Protokolls aus, das seit dem letzten
+ *        Aufruf einen Frame verarbeitet und dabei Werte geändert hat
+ */
+static void emitSnapshots(int64_t logTimeUs) {
+    for (size_t i = 0; i < PROTOCOL_COUNT; i++) {
+        uint32_t msgCount, errCount;
+        protocols[i]->getStats(msgCount, errCount);
+        SnapshotState& state = snapshots[i];
+        if (msgCount == state.messageCount) {
+            continue;
+        }
+        state.messageCount = msgCount;
+
+        bms_data_t data;
+        if (!protocols[i]->getData(data)) {
+            continue;
+        }
+        if (state.valid && sameSnapshot(state.data, data)) {
+            continue;
+        }
+        state.data = data;
+        state.valid = true;
+
+        Serial.printf("%lld.%06lld %s: %.3f V, %.2f A, SOC %.1f %%, %.1f C, cycles %u, chg %d, dchg %d, \"%s\"\n",
+                      (long long)(logTimeUs / 1000000), (long long)(logTimeUs % 1000000),
+                      protocols[i]->getName(), data.voltage, data.current, data.soc,
+                      data.temperature, data.cycles, data.charging, data.discharging,
+                      data.status_text);
+    }
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+static void printUsage() {
+    fprintf(stderr, "Usage: can_replay [--speed N | --fast] [--no-snapshots] [--no-cache] <log | ->\n");
+}
+
+int main(int argc, char** argv) {
+    double speed = 1.0;             // 0 = so schnell wie möglich
+    bool withSnapshots = true;
+    bool withCache = true;
+    const char* path = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--fast") == 0) {
+            speed = 0.0;
+        } else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            speed = atof(argv[++i]);
+            if (speed <= 0.0) {
+                printUsage();
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--no-snapshots") == 0) {
+            withSnapshots = false;
+        } else if (strcmp(argv[i], "--no-cache") == 0) {
+            withCache = false;
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+    if (!path) {
+        printUsage();
+        return 2;
+    }
+
+    CanLogReader reader;
+    if (!reader.open(path)) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < PROTOCOL_COUNT; i++) {
+        protocolManager.registerProtocol(protocols[i]);
+    }
+    if (!protocolManager.initializeAll() || !protocolManager.startAll()) {
+        Serial.println("[Replay] ERROR: Protocol init failed");
+        return 1;
+    }
+    protocolManager.setAutoDetect(true);
+    protocolManager.setPayloadCacheEnabled(withCache);
+    Serial.flush();
+
+    LatencyHistogram latency;
+    CanLogRecord record;
+    uint64_t routed = 0;
+    int64_t firstLogUs = 0;
+    int64_t lastDeviceUs = REPLAY_START_US;
+    uint32_t nextTickMs = (uint32_t)(REPLAY_START_US / 1000);
+    int64_t maxLagNs = 0;
+    int64_t routeNs = 0;
+
+    const int64_t startNs = monotonicNs();
+    int64_t lastProgressNs = startNs;
+    uint64_t lastProgressFrames = 0;
+
+    while (reader.next(record)) {
+        if (reader.getFrameCount() == 1) {
+            firstLogUs = record.logTimeUs;
+        }
+
+        if (speed > 0.0) {
+            int64_t offsetNs = (int64_t)((double)(record.logTimeUs - firstLogUs) * 1000.0 / speed);
+            int64_t dueNs = startNs + offsetNs;
+            int64_t nowNs = monotonicNs();
+            if (dueNs > nowNs) {
+                sleepUntilNs(dueNs);
+            } else if (nowNs - dueNs > maxLagNs) {
+                maxLagNs = nowNs - dueNs;
+            }
+        }
+
+        // Gerätezeit aus dem Log (monoton wie der RX-Zeitstempel);
+        // fällige Ticks vor dem Frame nachholen
+        int64_t deviceUs = REPLAY_START_US + (record.logTimeUs - firstLogUs);
+        if (deviceUs < lastDeviceUs) {
+            deviceUs = lastDeviceUs;
+        }
+        lastDeviceUs = deviceUs;
+        uint32_t deviceMs = (uint32_t)(deviceUs / 1000);
+        while ((int32_t)(deviceMs - nextTickMs) >= 0) {
+            hostSetClockUs((int64_t)nextTickMs * 1000);
+            protocolManager.update(nextTickMs);
+            nextTickMs += ICanBus::TICK_INTERVAL_MS;
+        }
+        hostSetClockUs(deviceUs);
+
+        // RX-Zeitstempel wie im RX-Task: Zeitpunkt des Empfangs
+        record.frame.timestampUs = deviceUs;
+        int64_t t0 = monotonicNs();
+        if (protocolManager.routeMessage(record.frame)) {
+            routed++;
+        }
+        int64_t t1 = monotonicNs();
+        latency.add((uint64_t)(t1 - t0));
+        routeNs += t1 - t0;
+
+        if (withSnapshots) {
+            emitSnapshots(record.logTimeUs);
+        }
+
+        if (t1 - lastProgressNs >= 1000000000) {
+            uint64_t frames = reader.getFrameCount();
+            fprintf(stderr, "[Replay] %llu frames, %.0f frames/s\n",
+                    (unsigned long long)frames,
+                    (double)(frames - lastProgressFrames) * 1e9 / (double)(t1 - lastProgressNs));
+            lastProgressNs = t1;
+            lastProgressFrames = frames;
+        }
+    }
+    const int64_t elapsedNs = monotonicNs() - startNs;
+    Serial.flush();
+
+    uint64_t frames = reader.getFrameCount();
+    fprintf(stderr, "\n=== Replay Summary ===\n");
+    fprintf(stderr, "Mode:        %s\n", speed > 0.0 ? "timed" : "as fast as possible");
+    if (speed > 0.0) {
+        fprintf(stderr, "Speed:       %.2fx, max schedule lag %.1f us\n", speed, maxLagNs / 1000.0);
+    }
+    fprintf(stderr, "Lines:       %llu (skipped %llu)\n",
+            (unsigned long long)reader.getLineCount(), (unsigned long long)reader.getSkippedCount());
+    fprintf(stderr, "Frames:      %llu (routed %llu, unrouted %llu)\n",
+            (unsigned long long)frames, (unsigned long long)routed,
+            (unsigned long long)(frames - routed));
+    fprintf(stderr, "Elapsed:     %.3f s\n", elapsedNs / 1e9);
+    if (elapsedNs > 0 && routeNs > 0) {
+        fprintf(stderr, "Throughput:  %.0f frames/s (incl. parsing), %.0f frames/s (routeMessage only)\n",
+                (double)frames * 1e9 / (double)elapsedNs, (double)frames * 1e9 / (double)routeNs);
+    }
+    fprintf(stderr, "Latency:     min %llu ns, mean %.0f ns, p50 %llu ns, p99 %llu ns, p99.9 %llu ns, max %llu ns\n",
+            (unsigned long long)latency.getMinNs(), latency.getMeanNs(),
+            (unsigned long long)latency.percentile(50.0), (unsigned long long)latency.percentile(99.0),
+            (unsigned long long)latency.percentile(99.9), (unsigned long long)latency.getMaxNs());
+
+    CanPayloadCacheStats cache = protocolManager.getPayloadCacheStats();
+    fprintf(stderr, "Cache:       %lu unchanged, %lu decoded, %lu bypassed\n",
+            (unsigned long)cache.hits, (unsigned long)cache.misses, (unsigned long)cache.bypassed);
+    CanCycleStats cycles = protocolManager.getCycleStats();
+    fprintf(stderr, "Cycles:      %lu updates (%lu complete, %lu incomplete, %lu deadline)\n",
+            (unsigned long)cycles.published, (unsigned long)cycles.complete,
+            (unsigned long)cycles.restarted, (unsigned long)cycles.deadline);
+
+    for (size_t i = 0; i < PROTOCOL_COUNT; i++) {
+        uint32_t msgCount, errCount;
+        protocols[i]->getStats(msgCount, errCount);
+        fprintf(stderr, "%-14s %lu decoded, %lu errors\n", protocols[i]->getName(),
+                (unsigned long)msgCount, (unsigned long)errCount);
+    }
+    CanProtocolBase* active = protocolManager.getActiveProtocol();
+    fprintf(stderr, "Detected:    %s\n", active ? active->getName() : "none");
+    return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file Arduino.h
+ * @brief Minimaler Arduino-Ersatz für den Host-Build (Linux)
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Stellt nur das bereit, was die portablen Module (Protokolle,
+ * ProtocolManager, Bus-Monitor) verwenden: Serial.print*, millis(),
+ * micros(), delay() und ESP.getCycleCount(). Zeitbasis ist
+ * CLOCK_MONOTONIC, identisch mit esp_timer_get_time() aus
+ * compat/esp_timer.h. can_replay ersetzt sie über hostSetClockUs()
+ * durch die Log-Zeit.
+ *
+ * SPEICHERN ALS: host/compat/Arduino.h
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+/// Simulierte Zeit in µs (can_replay), < 0 = CLOCK_MONOTONIC
+inline int64_t hostClockUs = -1;
+
+inline void hostSetClockUs(int64_t us) { hostClockUs = us; }
+
+inline int64_t hostMonotonicUs() {
+    if (hostClockUs >= 0) {
+        return hostClockUs;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+inline uint32_t millis() { return (uint32_t)(hostMonotonicUs() / 1000); }
+inline uint32_t micros() { return (uint32_t)hostMonotonicUs(); }
+inline void delay(uint32_t ms) { usleep((useconds_t)ms * 1000); }
+
+/**
+ * @brief Serial-Ersatz, schreibt auf stdout
+ *
+ * Die Firmware gibt uint32_t mit %lu/%lX aus (auf dem ESP32 unsigned
+ * long). Auf x86-64/aarch64 ist uint32_t unsigned int, printf() entfernt
+ * daher das einzelne 'l' aus den Formatangaben ("%ll" bleibt erhalten).
+ */
+class HostSerial {
+public:
+    void begin(unsigned long) {}
+
+    int printf(const char* format, ...) {
+        char adjusted[256];
+        normalizeFormat(format, adjusted, sizeof(adjusted));
+
+        va_list args;
+        va_start(args, format);
+        int written = vprintf(adjusted, args);
+        va_end(args);
+        return written;
+    }
+
+    size_t print(const char* text) { return (size_t)fputs(text, stdout); }
+    size_t println(const char* text) { size_t n = print(text); putchar('\n'); return n + 1; }
+    size_t println() { putchar('\n'); return 1; }
+    void flush() { fflush(stdout); }
+
+private:
+    static void normalizeFormat(const char* in, char* out, size_t size) {
+        size_t n = 0;
+        bool inSpec = false;
+        for (; *in && n + 1 < size; in++) {
+            char c = *in;
+            if (!inSpec) {
+                inSpec = (c == '%');
+            } else if (c == '%') {
+                inSpec = false;
+            } else if (c == 'l' && in[1] != 'l' && in[-1] != 'l') {
+                continue;
+            } else if (strchr("diouxXcsfFeEgGaApn", c)) {
+                inSpec = false;
+            }
+            out[n++] = c;
+        }
+        out[n] = '\0';
+    }
+};
+
+inline HostSerial Serial;
+
+/**
+ * @brief ESP-Ersatz, nur der Zykluszähler für die Benchmarks
+ *
+ * x86: TSC (Nenntakt), sonst Nanosekunden aus CLOCK_MONOTONIC.
+ */
+class HostEsp {
+public:
+    uint32_t getCycleCount() {
+#if defined(__x86_64__) || defined(__i386__)
+        return (uint32_t)__builtin_ia32_rdtsc();
+#else
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec);
+#endif
+    }
+};
+
+inline HostEsp ESP;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,17 @@
+/**
+ * @file esp_timer.h
+ * @brief esp_timer_get_time() für den Host-Build
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * SPEICHERN ALS: host/compat/esp_timer.h
+ */
+
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+#include "Arduino.h"
+
+inline int64_t esp_timer_get_time() { return hostMonotonicUs(); }
+
+#endif // HOST_ESP_TIMER_H
@@ -0,0 +1,489 @@
+/**
+ * @file dbc_gen.cpp
+ * @brief DBC -> constexpr Protokolltabellen (Build-Werkzeug)
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Liest Vector-DBC-Dateien und schreibt je Datei einen Header mit
+ * CanSignal-/CanMessageDef-Tabellen für CanSignalDecoder sowie einen
+ * Index-Header mit allen erzeugten Protokollen:
+ *
+ *   dbc_gen --out ../src/protocols/generated ../dbc/sma_bms_can.dbc ...
+ *
+ *   generated/sma_bms_can_dbc.h   struct SmaBmsCanDbc, using SmaBmsCan
+ *   generated/dbc_protocols.h     #define DBC_PROTOCOLS SmaBmsCan, ...
+ *
+ * Ausgewertet werden BO_ (Nachrichten), SG_ (Signale, Intel und
+ * Motorola) sowie folgende Attribute:
+ *
+ *   BA_ "BmsName" "SMA BMS";                      Protokollname
+ *   BA_ "BmsType" "PYLONTECH";                    bms_type_t (Default DBC)
+ *   BA_ "BmsTarget" SG_ 853 SOC "SOC";            Zielfeld in bms_data_t
+ *
+ * Signale ohne BmsTarget werden decodiert und ausgegeben, aber nicht in
+ * bms_data_t übernommen. Multiplexte Signale und Signale über 32 Bit
+ * werden mit Warnung übersprungen.
+ *
+ * Aufruf über "make dbc" (host/Makefile, Auswahl mit DBC=...).
+ *
+ * SPEICHERN ALS: host/dbc_gen.cpp
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <regex>
+
+// ============================================================================
+// DBC-Modell
+// ============================================================================
+
+struct DbcSignal {
+    std::string name;
+    std::string unit;
+    uint32_t startBit;
+    uint32_t length;
+    bool motorola;
+    bool isSigned;
+    double scale;
+    double offset;
+    double minValue;
+    double maxValue;
+    std::string target;             ///< SIGNAL_..., leer = SIGNAL_NONE
+};
+
+struct DbcMessage {
+    uint32_t id;
+    bool extended;
+    std::string name;
+    uint32_t length;
+    std::vector<DbcSignal> signals;
+};
+
+struct DbcFile {
+    std::string baseName;           ///< Dateiname ohne Endung
+    std::string protocolName;
+    std::string type;               ///< bms_type_t
+    std::vector<DbcMessage> messages;
+};
+
+static constexpr uint32_t DBC_EXTENDED_FLAG = 0x80000000;
+static constexpr size_t MAX_SIGNALS = 16;   ///< CanSignalDecoder::MAX_SIGNALS
+
+static const char* const TARGETS[] = {
+    "VOLTAGE", "CURRENT", "SOC", "TEMPERATURE", "CYCLES", "STATUS", "ALARM"
+};
+
+static bool isKnownTarget(const std::string& target) {
+    for (const char* known : TARGETS) {
+        if (target == known) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::string upper(std::string text) {
+    for (char& c : text) {
+        c = (char)toupper((unsigned char)c);
+    }
+    return text;
+}
+
+/**
+ * @brief Bezeichner in CamelCase: "sma_bms-can" -> "SmaBmsCan"
+ */
+static std::string camelCase(const std::string& text) {
+    std::string result;
+    bool nextUpper = true;
+    for (char c : text) {
+        if (!isalnum((unsigned char)c)) {
+            nextUpper = true;
+            continue;
+        }
+        result += nextUpper ? (char)toupper((unsigned char)c) : c;
+        nextUpper = false;
+    }
+    if (result.empty() || isdigit((unsigned char)result[0])) {
+        result = "Dbc" + result;
+    }
+    return result;
+}
+
+static std::string snakeCase(const std::string& text) {
+    std::string result;
+    for (char c : text) {
+        result += isalnum((unsigned char)c) ? (char)tolower((unsigned char)c) : '_';
+    }
+    return result;
+}
+
+// ============================================================================
+// Parser
+// ============================================================================
+
+/**
+ * @brief DBC-Startbit -> (startByte, bitOffset) wie in CanSignal
+ *
+ * Intel: Startbit = LSB, Byte 0 zuerst.
+ * Motorola: Startbit = MSB in der DBC-Sägezahn-Zählung (Bit 7 = MSB von
+ * Byte 0); startByte ist das Byte mit dem MSB, bitOffset die Lage des
+ * LSB im letzten Byte.
+ */
+static void signalPosition(const DbcSignal& signal, uint32_t& startByte, uint32_t& bitOffset) {
+    if (!signal.motorola) {
+        startByte = signal.startBit / 8;
+        bitOffset = signal.startBit % 8;
+        return;
+    }
+    uint32_t msbLinear = (signal.startBit / 8) * 8 + (7 - signal.startBit % 8);
+    uint32_t lsbLinear = msbLinear + signal.length - 1;
+    startByte = signal.startBit / 8;
+    bitOffset = 7 - lsbLinear % 8;
+}
+
+/**
+ * @brief Byte hinter dem letzten Byte des Signals (wie signalEndByte() im
+ *        Decoder, dessen validMessageTable() die Tabelle später prüft)
+ */
+static uint32_t signalEndByte(const DbcSignal& signal) {
+    uint32_t startByte, bitOffset;
+    signalPosition(signal, startByte, bitOffset);
+    if (!signal.motorola) {
+        return (startByte * 8 + bitOffset + signal.length + 7) / 8;
+    }
+    return startByte + (bitOffset + signal.length + 7) / 8;
+}
+
+static bool parseDbc(const std::string& path, DbcFile& dbc) {
+    std::ifstream in(path);
+    if (!in) {
+        fprintf(stderr, "[dbc_gen] ERROR: Cannot open %s\n", path.c_str());
+        return false;
+    }
+
+    size_t slash = path.find_last_of('/');
+    std::string file = (slash == std::string::npos) ? path : path.substr(slash + 1);
+    dbc.baseName = snakeCase(file.substr(0, file.find_last_of('.')));
+    dbc.protocolName = file.substr(0, file.find_last_of('.')) + " (DBC)";
+    dbc.type = "BMS_DBC";
+
+    static const std::regex boRegex(R"(^BO_\s+(\d+)\s+(\w+)\s*:\s*(\d+)\s+\S+)");
+    static const std::regex sgRegex(
+        R"(^\s+SG_\s+(\w+)\s*(\w*)\s*:\s*(\d+)\|(\d+)@([01])([+-])\s*)"
+        R"(\(\s*([^,]+)\s*,\s*([^)]+)\)\s*\[\s*([^|]+)\|([^\]]+)\]\s*\"([^\"]*)\")");
+    static const std::regex sgStartRegex(R"(^\s+SG_\s)");
+    static const std::regex nameRegex(R"(^BA_\s+\"BmsName\"\s+\"([^\"]*)\"\s*;)");
+    static const std::regex typeRegex(R"(^BA_\s+\"BmsType\"\s+\"(\w+)\"\s*;)");
+    static const std::regex targetRegex(R"(^BA_\s+\"BmsTarget\"\s+SG_\s+(\d+)\s+(\w+)\s+\"(\w+)\"\s*;)");
+
+    std::map<std::pair<uint32_t, std::string>, std::string> targets;
+    std::string line;
+    int lineNumber = 0;
+    DbcMessage* current = nullptr;
+
+    while (std::getline(in, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        std::smatch match;
+
+        if (std::regex_search(line, match, boRegex)) {
+            uint32_t rawId = (uint32_t)strtoul(match[1].str().c_str(), nullptr, 10);
+            DbcMessage message;
+            message.extended = (rawId & DBC_EXTENDED_FLAG) != 0;
+            message.id = rawId & ~DBC_EXTENDED_FLAG;
+            message.name = match[2];
+            message.length = (uint32_t)strtoul(match[3].str().c_str(), nullptr, 10);
+            if (message.length > 8) {
+                fprintf(stderr, "[dbc_gen] %s:%d: %s has %u bytes (max 8, no CAN FD)\n",
+                        path.c_str(), lineNumber, message.name.c_str(), message.length);
+                return false;
+            }
+            dbc.messages.push_back(message);
+            current = &dbc.messages.back();
+            continue;
+        }
+
+        if (std::regex_search(line, match, sgRegex)) {
+            if (!current) {
+                fprintf(stderr, "[dbc_gen] %s:%d: SG_ without BO_\n", path.c_str(), lineNumber);
+                return false;
+            }
+            DbcSignal signal;
+            signal.name = match[1];
+            signal.startBit = (uint32_t)strtoul(match[3].str().c_str(), nullptr, 10);
+            signal.length = (uint32_t)strtoul(match[4].str().c_str(), nullptr, 10);
+            signal.motorola = match[5] == "0";
+            signal.isSigned = match[6] == "-";
+            signal.scale = strtod(match[7].str().c_str(), nullptr);
+            signal.offset = strtod(match[8].str().c_str(), nullptr);
+            signal.minValue = strtod(match[9].str().c_str(), nullptr);
+            signal.maxValue = strtod(match[10].str().c_str(), nullptr);
+            signal.unit = match[11];
+
+            if (!match[2].str().empty()) {
+                fprintf(stderr, "[dbc_gen] WARNING: %s.%s is multiplexed, skipped\n",
+                        current->name.c_str(), signal.name.c_str());
+                continue;
+            }
+            if (signal.length == 0 || signal.length > 32) {
+                fprintf(stderr, "[dbc_gen] WARNING: %s.%s has %u bits (max 32), skipped\n",
+                        current->name.c_str(), signal.name.c_str(), signal.length);
+                continue;
+            }
+            uint32_t endByte = signalEndByte(signal);
+            if (endByte > current->length) {
+                fprintf(stderr, "[dbc_gen] WARNING: %s.%s needs %u bytes, message has %u, skipped\n",
+                        current->name.c_str(), signal.name.c_str(), endByte, current->length);
+                continue;
+            }
+            current->signals.push_back(signal);
+            continue;
+        }
+
+        if (std::regex_search(line, match, nameRegex)) {
+            dbc.protocolName = match[1];
+        } else if (std::regex_search(line, match, typeRegex)) {
+            dbc.type = "BMS_" + upper(match[1]);
+        } else if (std::regex_search(line, match, targetRegex)) {
+            uint32_t rawId = (uint32_t)strtoul(match[1].str().c_str(), nullptr, 10);
+            targets[{rawId & ~DBC_EXTENDED_FLAG, match[2]}] = upper(match[3]);
+        } else if (line.compare(0, 4, "BO_ ") == 0 || std::regex_search(line, sgStartRegex)) {
+            fprintf(stderr, "[dbc_gen] %s:%d: Cannot parse: %s\n", path.c_str(), lineNumber, line.c_str());
+            return false;
+        } else if (!line.empty() && !isspace((unsigned char)line[0])) {
+            current = nullptr;
+        }
+    }
+
+    for (const auto& entry : targets) {
+        bool found = false;
+        for (DbcMessage& message : dbc.messages) {
+            for (DbcSignal& signal : message.signals) {
+                if (message.id == entry.first.first && signal.name == entry.first.second) {
+                    found = true;
+                    if (!isKnownTarget(entry.second)) {
+                        fprintf(stderr, "[dbc_gen] ERROR: Unknown BmsTarget \"%s\" for %s\n",
+                                entry.second.c_str(), signal.name.c_str());
+                        return false;
+                    }
+                    signal.target = "SIGNAL_" + entry.second;
+                }
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "[dbc_gen] WARNING: BmsTarget for unknown signal %s\n",
+                    entry.first.second.c_str());
+        }
+    }
+
+    for (const DbcMessage& message : dbc.messages) {
+        if (message.signals.size() > MAX_SIGNALS) {
+            fprintf(stderr, "[dbc_gen] ERROR: %s has %u signals (max %u)\n", message.name.c_str(),
+                    (unsigned)message.signals.size(), (unsigned)MAX_SIGNALS);
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Ausgabe
+// ============================================================================
+
+static std::string floatLiteral(double value) {
+    char text[48];
+    snprintf(text, sizeof(text), "%.9g", value);
+    std::string result = text;
+    if (result.find_first_of(".eEn") == std::string::npos) {
+        result += ".0";
+    }
+    return result + "f";
+}
+
+static std::string stringLiteral(const std::string& text) {
+    std::string result = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+        }
+        result += c;
+    }
+    return result + "\"";
+}
+
+static bool writeHeader(const DbcFile& dbc, const std::string& dir, const std::string& source) {
+    std::string structName = camelCase(dbc.baseName) + "Dbc";
+    std::string className = camelCase(dbc.baseName);
+    std::string fileName = dbc.baseName + "_dbc.h";
+    std::string guard = upper(dbc.baseName) + "_DBC_H";
+    std::string path = dir + "/" + fileName;
+
+    std::ostringstream out;
+    out << "/**\n"
+        << " * @file " << fileName << "\n"
+        << " * @brief " << dbc.protocolName << " - aus " << source << " generiert\n"
+        << " * @author BMS Monitor Team\n"
+        << " * @date 2025\n"
+        << " *\n"
+        << " * NICHT VON HAND BEARBEITEN - erzeugt von host/dbc_gen (make dbc).\n"
+        << " *\n"
+        << " * SPEICHERN ALS: src/protocols/generated/" << fileName << "\n"
+        << " */\n\n"
+        << "#ifndef " << guard << "\n"
+        << "#define " << guard << "\n\n"
+        << "#include \"../dbc_can_protocol.h\"\n\n"
+        << "struct " << structName << " {\n"
+        << "    static constexpr const char* NAME = " << stringLiteral(dbc.protocolName) << ";\n"
+        << "    static constexpr bms_type_t TYPE = " << dbc.type << ";\n\n";
+
+    for (const DbcMessage& message : dbc.messages) {
+        if (message.signals.empty()) {
+            continue;
+        }
+        out << "    // " << message.name << "\n"
+            << "    static constexpr CanSignal SIG_" << message.name << "[] = {\n";
+        for (size_t i = 0; i < message.signals.size(); i++) {
+            const DbcSignal& signal = message.signals[i];
+            uint32_t startByte, bitOffset;
+            signalPosition(signal, startByte, bitOffset);
+            bool unchecked = signal.minValue == 0.0 && signal.maxValue == 0.0;
+            out << "        {" << stringLiteral(signal.name) << ", " << stringLiteral(signal.unit) << ", "
+                << startByte << ", " << bitOffset << ", " << signal.length << ", "
+                << (signal.motorola ? "SIGNAL_BIG_ENDIAN" : "SIGNAL_LITTLE_ENDIAN") << ", "
+                << (signal.isSigned ? "true" : "false") << ", "
+                << floatLiteral(signal.scale) << ", " << floatLiteral(signal.offset) << ", "
+                << (unchecked ? "SIGNAL_UNCHECKED_MIN" : floatLiteral(signal.minValue)) << ", "
+                << (unchecked ? "SIGNAL_UNCHECKED_MAX" : floatLiteral(signal.maxValue)) << ", "
+                << (signal.target.empty() ? "SIGNAL_NONE" : signal.target) << "}"
+                << (i + 1 < message.signals.size() ? "," : "") << "\n";
+        }
+        out << "    };\n\n";
+    }
+
+    out << "    static constexpr CanMessageDef MESSAGES[] = {\n";
+    for (size_t i = 0; i < dbc.messages.size(); i++) {
+        const DbcMessage& message = dbc.messages[i];
+        char id[16];
+        snprintf(id, sizeof(id), "0x%0*X", message.extended ? 8 : 3, message.id);
+        out << "        canMessage(" << id << ", "
+            << (message.extended ? "CAN_EXT_ID_MASK, true, " : "CAN_STD_ID_MASK, false, ")
+            << message.length;
+        if (!message.signals.empty()) {
+            out << ", SIG_" << message.name;
+        }
+        out << ")" << (i + 1 < dbc.messages.size() ? "," : "") << "\n";
+    }
+    out << "    };\n\n";
+
+    out << "    static constexpr CanIdFilter ROUTES[] = {\n";
+    for (size_t i = 0; i < dbc.messages.size(); i++) {
+        const DbcMessage& message = dbc.messages[i];
+        char id[16];
+        snprintf(id, sizeof(id), "0x%0*X", message.extended ? 8 : 3, message.id);
+        out << "        {" << id << ", "
+            << (message.extended ? "CAN_EXT_ID_MASK, true" : "CAN_STD_ID_MASK, false") << "}"
+            << (i + 1 < dbc.messages.size() ? "," : "") << "\n";
+    }
+    out << "    };\n"
+        << "};\n\n"
+        << "static_assert(validMessageTable(" << structName << "::MESSAGES), \""
+        << className << ": Signal außerhalb der Nutzdaten\");\n\n"
+        << "using " << className << " = DbcCanProtocol<" << structName << ">;\n\n"
+        << "#endif // " << guard << "\n";
+
+    std::ofstream file(path);
+    if (!file || !(file << out.str())) {
+        fprintf(stderr, "[dbc_gen] ERROR: Cannot write %s\n", path.c_str());
+        return false;
+    }
+    fprintf(stderr, "[dbc_gen] %s: %u messages -> %s\n", dbc.protocolName.c_str(),
+            (unsigned)dbc.messages.size(), path.c_str());
+    return true;
+}
+
+static bool writeIndex(const std::vector<DbcFile>& files, const std::string& dir) {
+    std::ostringstream out;
+    out << "/**\n"
+        << " * @file dbc_protocols.h\n"
+        << " * @brief Alle aus DBC-Dateien generierten Protokolle\n"
+        << " * @author BMS Monitor Team\n"
+        << " * @date 2025\n"
+        << " *\n"
+        << " * NICHT VON HAND BEARBEITEN - erzeugt von host/dbc_gen (make dbc).\n"
+        << " * Verwendung: DbcProtocolBundle<DBC_PROTOCOLS> dbcProtocols;\n"
+        << " *\n"
+        << " * SPEICHERN ALS: src/protocols/generated/dbc_protocols.h\n"
+        << " */\n\n"
+        << "#ifndef DBC_PROTOCOLS_H\n"
+        << "#define DBC_PROTOCOLS_H\n\n"
+        << "#include \"../dbc_can_protocol.h\"\n";
+    for (const DbcFile& dbc : files) {
+        out << "#include \"" << dbc.baseName << "_dbc.h\"\n";
+    }
+    out << "\n#define DBC_PROTOCOLS";
+    for (size_t i = 0; i < files.size(); i++) {
+        out << (i ? ", " : " ") << camelCase(files[i].baseName);
+    }
+    out << "\n\n#endif // DBC_PROTOCOLS_H\n";
+
+    std::string path = dir + "/dbc_protocols.h";
+    std::ofstream file(path);
+    if (!file || !(file << out.str())) {
+        fprintf(stderr, "[dbc_gen] ERROR: Cannot write %s\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+static void usage() {
+    fprintf(stderr, "Usage: dbc_gen --out <dir> <file.dbc>...\n");
+}
+
+int main(int argc, char** argv) {
+    std::string outDir;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outDir = argv[++i];
+        } else if (argv[i][0] == '-') {
+            usage();
+            return 1;
+        } else {
+            inputs.push_back(argv[i]);
+        }
+    }
+    if (outDir.empty()) {
+        usage();
+        return 1;
+    }
+
+    std::vector<DbcFile> files;
+    for (const std::string& input : inputs) {
+        DbcFile dbc;
+        if (!parseDbc(input, dbc)) {
+            return 1;
+        }
+        size_t slash = input.find_last_of('/');
+        std::string source = (slash == std::string::npos) ? input : input.substr(slash + 1);
+        if (!writeHeader(dbc, outDir, source)) {
+            return 1;
+        }
+        files.push_back(dbc);
+    }
+    return writeIndex(files, outDir) ? 0 : 1;
+}
@@ -0,0 +1,335 @@
+/**
+ * @file socketcan_bus.h
+ * @brief ICanBus über Linux SocketCAN (can0, vcan0, ...)
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Gegenstück zu CanDriver für den Host-Build. Ein RX-Thread liest per
+ * CAN_RAW-Socket und liefert die Frames wie der TWAI RX-Task an Tap-
+ * und Message-Sink; der Tick-Sink läuft ebenfalls dort (wie im
+ * Decode-Task des CanDriver). Akzeptanzfilter werden als CAN_RAW_FILTER im Kernel
+ * gesetzt, nicht passende Frames erreichen den Prozess also gar nicht.
+ *
+ * Virtueller Bus zum Testen:
+ *   sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0
+ *
+ * SPEICHERN ALS: host/socketcan_bus.h
+ */
+
+#ifndef SOCKETCAN_BUS_H
+#define SOCKETCAN_BUS_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <thread>
+#include <errno.h>
+#include <poll.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include "../src/hardware/can_bus.h"
+
+/**
+ * @brief Statistik des SocketCAN-Backends
+ */
+struct SocketCanStats {
+    uint32_t rxFrames;
+    uint32_t txFrames;
+    uint32_t txQueueFull;
+    uint32_t rxErrors;
+    uint32_t txErrors;
+};
+
+class SocketCanBus : public ICanBus {
+public:
+    static constexpr int POLL_TIMEOUT_MS = 100;         ///< Reaktionszeit auf stop()
+    static constexpr size_t MAX_KERNEL_FILTERS = 64;
+
+private:
+    char m_ifName[IFNAMSIZ];
+    uint32_t m_bitrate;
+    int m_socket;
+    std::thread m_rxThread;
+    std::atomic<bool> m_running;
+
+    CanMessageSink m_messageSink;
+    CanMessageSink m_rxTapSink;
+    CanTickSink m_tickSink;
+
+    std::atomic<uint32_t> m_rxFrames;
+    std::atomic<uint32_t> m_txFrames;
+    std::atomic<uint32_t> m_txQueueFull;
+    std::atomic<uint32_t> m_rxErrors;
+    std::atomic<uint32_t> m_txErrors;
+
+    // ========================================================================
+    // RX-Thread
+    // ========================================================================
+
+    void rxLoop() {
+        struct pollfd pfd;
+        pfd.fd = m_socket;
+        pfd.events = POLLIN;
+        uint32_t lastTick = millis();
+
+        while (m_running.load(std::memory_order_relaxed)) {
+            int ready = poll(&pfd, 1, POLL_TIMEOUT_MS);
+
+            uint32_t now = millis();
+            if (m_tickSink && now - lastTick >= TICK_INTERVAL_MS) {
+                lastTick = now;
+                m_tickSink(now);
+            }
+
+            if (ready <= 0) {
+                if (ready < 0 && errno != EINTR) {
+                    m_rxErrors++;
+                }
+                continue;
+            }
+
+            struct can_frame raw;
+            ssize_t n = read(m_socket, &raw, sizeof(raw));
+            if (n != (ssize_t)sizeof(raw)) {
+                if (n < 0 && errno != EAGAIN && errno != EINTR) {
+                    m_rxErrors++;
+                }
+                continue;
+            }
+            if (raw.can_id & CAN_ERR_FLAG) {
+                m_rxErrors++;
+                continue;
+            }
+
+            CanFrame frame;
+            frame.timestampUs = hostMonotonicUs();
+            frame.flags = 0;
+            if (raw.can_id & CAN_EFF_FLAG) {
+                frame.id = raw.can_id & CAN_EFF_MASK;
+                frame.flags |= CanFrame::FLAG_EXTENDED;
+            } else {
+                frame.id = raw.can_id & CAN_SFF_MASK;
+            }
+            if (raw.can_id & CAN_RTR_FLAG) {
+                frame.flags |= CanFrame::FLAG_RTR;
+            }
+            frame.length = raw.can_dlc > 8 ? 8 : raw.can_dlc;
+            memcpy(frame.data, raw.data, 8);
+
+            m_rxFrames.fetch_add(1, std::memory_order_relaxed);
+
+            if (m_rxTapSink) {
+                m_rxTapSink(frame);
+            }
+            if (m_messageSink) {
+                m_messageSink(frame);
+            }
+        }
+    }
+
+public:
+    /**
+     * @param ifName Netzwerk-Interface (z.B. "vcan0", "can0")
+     * @param bitrate Nominelle Bitrate für die Buslast (0 = unbekannt)
+     */
+    explicit SocketCanBus(const char* ifName = "vcan0", uint32_t bitrate = 0)
+        : m_bitrate(bitrate)
+        , m_socket(-1)
+        , m_running(false)
+        , m_rxFrames(0)
+        , m_txFrames(0)
+        , m_txQueueFull(0)
+        , m_rxErrors(0)
+        , m_txErrors(0)
+    {
+        strncpy(m_ifName, ifName, sizeof(m_ifName) - 1);
+        m_ifName[sizeof(m_ifName) - 1] = '\0';
+    }
+
+    ~SocketCanBus() override {
+        stop();
+        if (m_socket >= 0) {
+            close(m_socket);
+        }
+    }
+
+    // ========================================================================
+    // ICanBus
+    // ========================================================================
+
+    const char* getName() const override { return m_ifName; }
+
+    /**
+     * @brief Öffnet den Socket (ohne RX-Thread)
+     *
+     * Vor setAcceptanceFilters() aufrufen, damit die Filter im Kernel
+     * schon vor dem ersten Frame aktiv sind.
+     */
+    bool open() {
+        if (m_socket >= 0) {
+            return true;
+        }
+
+        int fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+        if (fd < 0) {
+            Serial.printf("[SocketCAN] socket() failed: %s\n", strerror(errno));
+            return false;
+        }
+
+        struct ifreq ifr;
+        memset(&ifr, 0, sizeof(ifr));
+        memcpy(ifr.ifr_name, m_ifName, IFNAMSIZ);
+        if (ioctl(fd, SIOCGIFINDEX, &ifr) < 0) {
+            Serial.printf("[SocketCAN] Interface %s not found: %s\n", m_ifName, strerror(errno));
+            close(fd);
+            return false;
+        }
+
+        struct sockaddr_can addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.can_family = AF_CAN;
+        addr.can_ifindex = ifr.ifr_ifindex;
+        if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+            Serial.printf("[SocketCAN] bind(%s) failed: %s\n", m_ifName, strerror(errno));
+            close(fd);
+            return false;
+        }
+
+        // Großer Empfangspuffer, damit cangen-Bursts bei 1 Mbit/s nicht verloren gehen
+        int rcvbuf = 4 * 1024 * 1024;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+        m_socket = fd;
+        Serial.printf("[SocketCAN] Opened %s\n", m_ifName);
+        return true;
+    }
+
+    bool start() override {
+        if (m_running) {
+            return true;
+        }
+        if (!open()) {
+            return false;
+        }
+
+        m_running = true;
+        m_rxThread = std::thread(&SocketCanBus::rxLoop, this);
+        Serial.printf("[SocketCAN] Started on %s\n", m_ifName);
+        return true;
+    }
+
+    bool stop() override {
+        if (!m_running) {
+            return true;
+        }
+        m_running = false;
+        if (m_rxThread.joinable()) {
+            m_rxThread.join();
+        }
+        Serial.printf("[SocketCAN] Stopped %s\n", m_ifName);
+        return true;
+    }
+
+    bool isRunning() const override { return m_running; }
+
+    CanTxResult transmit(const CanFrame& frame) override {
+        if (m_socket < 0) {
+            return CAN_TX_BUSY;
+        }
+        if (frame.length > 8) {
+            return CAN_TX_REJECTED;
+        }
+
+        struct can_frame raw;
+        memset(&raw, 0, sizeof(raw));
+        raw.can_id = frame.isExtended() ? ((frame.id & CAN_EFF_MASK) | CAN_EFF_FLAG)
+                                        : (frame.id & CAN_SFF_MASK);
+        if (frame.isRtr()) {
+            raw.can_id |= CAN_RTR_FLAG;
+        }
+        raw.can_dlc = frame.length;
+        memcpy(raw.data, frame.data, frame.length);
+
+        ssize_t n = send(m_socket, &raw, sizeof(raw), MSG_DONTWAIT);
+        if (n == (ssize_t)sizeof(raw)) {
+            m_txFrames.fetch_add(1, std::memory_order_relaxed);
+            return CAN_TX_OK;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)) {
+            m_txQueueFull.fetch_add(1, std::memory_order_relaxed);
+            return CAN_TX_QUEUE_FULL;
+        }
+        m_txErrors.fetch_add(1, std::memory_order_relaxed);
+        return CAN_TX_ERROR;
+    }
+
+    void setMessageSink(CanMessageSink sink) override { m_messageSink = sink; }
+    void setRxTapSink(CanMessageSink sink) override { m_rxTapSink = sink; }
+    void setTickSink(CanTickSink sink) override { m_tickSink = sink; }
+
+    /**
+     * @brief Setzt die Filter als CAN_RAW_FILTER
+     *
+     * Der Kernel vergleicht (can_id & mask) == (id & mask) auf der rohen
+     * can_id. CAN_EFF_FLAG in der Maske unterscheidet 11- und 29-Bit
+     * Frames, wie der IDE-Vergleich in CanIdFilter::matches().
+     */
+    bool setAcceptanceFilters(const CanIdFilter* filters, size_t count) override {
+        if (m_socket < 0) {
+            return false;
+        }
+
+        struct can_filter raw[MAX_KERNEL_FILTERS];
+        size_t n = 0;
+
+        if (filters == nullptr || count == 0) {
+            raw[0].can_id = 0;
+            raw[0].can_mask = 0;
+            n = 1;
+        } else {
+            if (count > MAX_KERNEL_FILTERS) {
+                Serial.printf("[SocketCAN] %u filters, using first %u\n",
+                              (unsigned)count, (unsigned)MAX_KERNEL_FILTERS);
+                count = MAX_KERNEL_FILTERS;
+            }
+            for (size_t i = 0; i < count; i++) {
+                const CanIdFilter& f = filters[i];
+                if (f.extended) {
+                    raw[n].can_id = (f.id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+                    raw[n].can_mask = (f.mask & CAN_EFF_MASK) | CAN_EFF_FLAG;
+                } else {
+                    raw[n].can_id = f.id & CAN_SFF_MASK;
+                    raw[n].can_mask = (f.mask & CAN_SFF_MASK) | CAN_EFF_FLAG;
+                }
+                n++;
+            }
+        }
+
+        if (setsockopt(m_socket, SOL_CAN_RAW, CAN_RAW_FILTER, raw, n * sizeof(raw[0])) < 0) {
+            Serial.printf("[SocketCAN] CAN_RAW_FILTER failed: %s\n", strerror(errno));
+            return false;
+        }
+        Serial.printf("[SocketCAN] %u kernel filter(s) active\n", (unsigned)n);
+        return true;
+    }
+
+    uint32_t getBaudrate() const override { return m_bitrate; }
+
+    // ========================================================================
+    // Statistik
+    // ========================================================================
+
+    SocketCanStats getStats() const {
+        SocketCanStats stats;
+        stats.rxFrames = m_rxFrames.load(std::memory_order_relaxed);
+        stats.txFrames = m_txFrames.load(std::memory_order_relaxed);
+        stats.txQueueFull = m_txQueueFull.load(std::memory_order_relaxed);
+        stats.rxErrors = m_rxErrors.load(std::memory_order_relaxed);
+        stats.txErrors = m_txErrors.load(std::memory_order_relaxed);
+        return stats;
+    }
+};
+
+#endif // SOCKETCAN_BUS_H
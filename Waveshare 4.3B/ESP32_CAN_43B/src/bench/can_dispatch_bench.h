@@ -0,0 +1,119 @@
+/**
+ * @file can_dispatch_bench.h
+ * @brief Microbenchmark: Dispatch-Kosten pro CAN-Frame
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Vergleicht den Aufruf des Message-Handlers über std::function (alte
+ * CanDriver-API) mit dem allokationsfreien Sink (Funktionszeiger +
+ * Kontext). Gemessen werden CPU-Zyklen pro Frame mit ESP.getCycleCount().
+ * Aufruf über das Serial-Kommando "bench".
+ *
+ * SPEICHERN ALS: src/bench/can_dispatch_bench.h
+ */
+
+#ifndef CAN_DISPATCH_BENCH_H
+#define CAN_DISPATCH_BENCH_H
+
+#include <Arduino.h>
+#include <functional>
+#include "../core/can_types.h"
+#include "../core/sink.h"
+
+/**
+ * @brief Dispatch-Microbenchmark
+ */
+class CanDispatchBench {
+private:
+    static volatile uint32_t& accumulator() {
+        static volatile uint32_t value = 0;
+        return value;
+    }
+
+    /**
+     * @brief Ziel-Handler (nicht inlinebar, wie ein echter Handler)
+     */
+    static void __attribute__((noinline)) target(const CanFrame& frame) {
+        accumulator() = accumulator() + frame.data[0];
+    }
+
+    struct Receiver {
+        uint32_t count = 0;
+        void __attribute__((noinline)) onFrame(const CanFrame& frame) {
+            count += frame.data[0];
+        }
+    };
+
+    template <typename Fn>
+    static float measure(uint32_t iterations, const CanFrame& frame, Fn&& call) {
+        uint32_t start = ESP.getCycleCount();
+        for (uint32_t i = 0; i < iterations; i++) {
+            call(frame);
+        }
+        uint32_t cycles = ESP.getCycleCount() - start;
+        return (float)cycles / iterations;
+    }
+
+public:
+    /**
+     * @brief Führt den Benchmark aus und gibt das Ergebnis auf Serial aus
+     * @param iterations Anzahl Aufrufe pro Variante
+     */
+    static void run(uint32_t iterations = 100000) {
+        CanFrame frame = {};
+        frame.id = 0x359;
+        frame.length = 8;
+        frame.data[0] = 1;
+
+        Receiver receiver;
+
+        // Über volatile Zeiger aufrufen, damit der Compiler den Aufruf
+        // nicht auflöst - wie im Decode-Task, wo der Handler zur Laufzeit
+        // gesetzt wird.
+        static Sink<const CanFrame&> fnSink;
+        static Sink<const CanFrame&> memberSink;
+        static std::function<void(const CanFrame&)> stdFn;
+        static std::function<void(const CanFrame&)> stdLambda;
+
+        fnSink = Sink<const CanFrame&>::function<&CanDispatchBench::target>();
+        memberSink = Sink<const CanFrame&>::member<Receiver, &Receiver::onFrame>(&receiver);
+        stdFn = &CanDispatchBench::target;
+
+        // Capture größer als der Small-Buffer von std::function -> Heap
+        uint32_t heapBefore = ESP.getFreeHeap();
+        uint32_t a = 1, b = 2, c = 3, d = 4;
+        Receiver* r = &receiver;
+        stdLambda = [r, a, b, c, d](const CanFrame& f) {
+            r->onFrame(f);
+            (void)a; (void)b; (void)c; (void)d;
+        };
+        int32_t heapUsed = (int32_t)(heapBefore - ESP.getFreeHeap());
+
+        Sink<const CanFrame&>* volatile fnSinkPtr = &fnSink;
+        Sink<const CanFrame&>* volatile memberSinkPtr = &memberSink;
+        std::function<void(const CanFrame&)>* volatile stdFnPtr = &stdFn;
+        std::function<void(const CanFrame&)>* volatile stdLambdaPtr = &stdLambda;
+
+        float direct = measure(iterations, frame, [](const CanFrame& f) { target(f); });
+        float sinkFn = measure(iterations, frame, [&](const CanFrame& f) { (*fnSinkPtr)(f); });
+        float sinkMember = measure(iterations, frame, [&](const CanFrame& f) { (*memberSinkPtr)(f); });
+        float stdFunction = measure(iterations, frame, [&](const CanFrame& f) { (*stdFnPtr)(f); });
+        float stdCapture = measure(iterations, frame, [&](const CanFrame& f) { (*stdLambdaPtr)(f); });
+
+        Serial.println("\n=== CAN Dispatch Benchmark ===");
+        Serial.printf("Iterations:               %lu\n", iterations);
+        Serial.printf("Direct call:              %6.1f cycles/frame\n", direct);
+        Serial.printf("Sink (function):          %6.1f cycles/frame\n", sinkFn);
+        Serial.printf("Sink (member):            %6.1f cycles/frame\n", sinkMember);
+        Serial.printf("std::function (fn ptr):   %6.1f cycles/frame\n", stdFunction);
+        Serial.printf("std::function (capture):  %6.1f cycles/frame, %ld bytes heap\n",
+                     stdCapture, heapUsed);
+        Serial.printf("Sizeof Sink: %u, std::function: %u bytes\n",
+                     (unsigned)sizeof(fnSink), (unsigned)sizeof(stdFn));
+        Serial.println("==============================\n");
+
+        stdLambda = nullptr;
+    }
+};
+
+#endif // CAN_DISPATCH_BENCH_H
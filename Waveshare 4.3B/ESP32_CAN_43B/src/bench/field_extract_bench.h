@@ -0,0 +1,228 @@
+/**
+ * @file field_extract_bench.h
+ * @brief Benchmark: Feld-Extraktion (CanField) gegen die Byte-Helper
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Decodiert pro Nutzdaten-Block dieselben 9 Felder (16/32 Bit beider
+ * Byte-Reihenfolgen, mit/ohne Vorzeichen, zwei Bitfelder) auf vier Arten:
+ *   - frühere extractUint16/32: Byte für Byte, bigEndian zur Laufzeit
+ *   - CanSignalDecoder::extractRaw: Signaltabelle, Position zur Laufzeit
+ *   - CanField über CanPayload: ein 64-Bit Load, Shift/Maske fest
+ *   - CanField::get(data): ein Load in Feldbreite pro Feld
+ * Gemessen werden CPU-Zyklen pro Signal (ESP.getCycleCount(), im Host-
+ * Build TSC) und ns pro Signal; die Werte aller Varianten müssen gleich
+ * sein.
+ *
+ * Läuft auch im Host-Build (host/can_bench).
+ * Aufruf über das Serial-Kommando "bench".
+ *
+ * SPEICHERN ALS: src/bench/field_extract_bench.h
+ */
+
+#ifndef FIELD_EXTRACT_BENCH_H
+#define FIELD_EXTRACT_BENCH_H
+
+#include <Arduino.h>
+#include "esp_timer.h"
+#include "../protocols/can_field.h"
+#include "../protocols/can_signal_decoder.h"
+
+class FieldExtractBench {
+private:
+    static constexpr size_t PAYLOAD_COUNT = 16;
+    static constexpr size_t SIGNAL_COUNT = 9;
+
+    // Feldliste für extractRaw, gleiche Reihenfolge wie in den anderen Varianten
+    static constexpr CanSignal SIGNALS[SIGNAL_COUNT] = {
+        {"be_u16", "", 0, 0, 16, SIGNAL_BIG_ENDIAN, false, 1.0f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE},
+        {"be_i16", "", 2, 0, 16, SIGNAL_BIG_ENDIAN, true, 1.0f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE},
+        {"le_u16", "", 4, 0, 16, SIGNAL_LITTLE_ENDIAN, false, 1.0f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE},
+        {"le_i16", "", 6, 0, 16, SIGNAL_LITTLE_ENDIAN, true, 1.0f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE},
+        {"be_u32", "", 0, 0, 32, SIGNAL_BIG_ENDIAN, false, 1.0f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE},
+        {"be_i32", "", 4, 0, 32, SIGNAL_BIG_ENDIAN, true, 1.0f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE},
+        {"le_u32", "", 4, 0, 32, SIGNAL_LITTLE_ENDIAN, false, 1.0f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE},
+        {"be_u12", "", 1, 4, 12, SIGNAL_BIG_ENDIAN, false, 1.0f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE},
+        {"le_i5", "", 3, 2, 5, SIGNAL_LITTLE_ENDIAN, true, 1.0f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE}
+    };
+
+    using FieldExtract = int64_t (*)(const uint8_t* data, int32_t* values);
+
+    // ========================================================================
+    // Referenz: frühere CanProtocolBase-Helper
+    // ========================================================================
+
+    static uint16_t legacyUint16(const uint8_t* data, size_t offset, bool bigEndian) {
+        if (bigEndian) {
+            return (uint16_t)(data[offset] << 8) | data[offset + 1];
+        } else {
+            return (uint16_t)(data[offset + 1] << 8) | data[offset];
+        }
+    }
+
+    static uint32_t legacyUint32(const uint8_t* data, size_t offset, bool bigEndian) {
+        if (bigEndian) {
+            return ((uint32_t)data[offset] << 24) |
+                   ((uint32_t)data[offset + 1] << 16) |
+                   ((uint32_t)data[offset + 2] << 8) |
+                   ((uint32_t)data[offset + 3]);
+        } else {
+            return ((uint32_t)data[offset + 3] << 24) |
+                   ((uint32_t)data[offset + 2] << 16) |
+                   ((uint32_t)data[offset + 1] << 8) |
+                   ((uint32_t)data[offset]);
+        }
+    }
+
+    static int64_t __attribute__((noinline)) legacyFields(const uint8_t* data, int32_t* values) {
+        values[0] = legacyUint16(data, 0, true);
+        values[1] = (int16_t)legacyUint16(data, 2, true);
+        values[2] = legacyUint16(data, 4, false);
+        values[3] = (int16_t)legacyUint16(data, 6, false);
+        values[4] = (int32_t)legacyUint32(data, 0, true);
+        values[5] = (int32_t)legacyUint32(data, 4, true);
+        values[6] = (int32_t)legacyUint32(data, 4, false);
+        values[7] = legacyUint16(data, 1, true) >> 4;
+        values[8] = (int8_t)(data[3] << 1) >> 3;
+        return sum(values);
+    }
+
+    // ========================================================================
+    // Signaltabelle (Position zur Laufzeit)
+    // ========================================================================
+
+    static int64_t __attribute__((noinline)) tableFields(const uint8_t* data, int32_t* values) {
+        CanPayload payload = CanPayload::load(data);
+        uint64_t big = payload.big();
+        for (size_t i = 0; i < SIGNAL_COUNT; i++) {
+            values[i] = (int32_t)CanSignalDecoder::extractRaw(SIGNALS[i], payload.little, big);
+        }
+        return sum(values);
+    }
+
+    // ========================================================================
+    // CanField (Position zur Compile-Zeit)
+    // ========================================================================
+
+    static int64_t __attribute__((noinline)) payloadFields(const uint8_t* data, int32_t* values) {
+        CanPayload payload = CanPayload::load(data);
+        values[0] = BeU16<0>::get(payload);
+        values[1] = BeI16<2>::get(payload);
+        values[2] = LeU16<4>::get(payload);
+        values[3] = LeI16<6>::get(payload);
+        values[4] = (int32_t)BeU32<0>::get(payload);
+        values[5] = BeI32<4>::get(payload);
+        values[6] = (int32_t)LeU32<4>::get(payload);
+        values[7] = CanField<SIGNAL_BIG_ENDIAN, 1, 12, false, 4>::get(payload);
+        values[8] = CanField<SIGNAL_LITTLE_ENDIAN, 3, 5, true, 2>::get(payload);
+        return sum(values);
+    }
+
+    static int64_t __attribute__((noinline)) directFields(const uint8_t* data, int32_t* values) {
+        values[0] = BeU16<0>::get(data);
+        values[1] = BeI16<2>::get(data);
+        values[2] = LeU16<4>::get(data);
+        values[3] = LeI16<6>::get(data);
+        values[4] = (int32_t)BeU32<0>::get(data);
+        values[5] = BeI32<4>::get(data);
+        values[6] = (int32_t)LeU32<4>::get(data);
+        values[7] = CanField<SIGNAL_BIG_ENDIAN, 1, 12, false, 4>::get(data);
+        values[8] = CanField<SIGNAL_LITTLE_ENDIAN, 3, 5, true, 2>::get(data);
+        return sum(values);
+    }
+
+    // ========================================================================
+    // Messung
+    // ========================================================================
+
+    static int64_t sum(const int32_t* values) {
+        int64_t total = 0;
+        for (size_t i = 0; i < SIGNAL_COUNT; i++) {
+            total += values[i];
+        }
+        return total;
+    }
+
+    static void buildPayloads(uint8_t (*payloads)[8]) {
+        uint32_t seed = 0x12345678;
+        for (size_t i = 0; i < PAYLOAD_COUNT; i++) {
+            for (size_t b = 0; b < 8; b++) {
+                seed = seed * 1664525u + 1013904223u;
+                payloads[i][b] = (uint8_t)(seed >> 24);
+            }
+        }
+    }
+
+    struct Timing {
+        float cyclesPerSignal;
+        float nsPerSignal;
+    };
+
+    static Timing measure(uint32_t iterations, const uint8_t (*payloads)[8], FieldExtract extract) {
+        int32_t values[SIGNAL_COUNT];
+        int64_t total = 0;
+        int64_t startUs = esp_timer_get_time();
+        uint32_t startCycles = ESP.getCycleCount();
+        for (uint32_t i = 0; i < iterations; i++) {
+            total += extract(payloads[i & (PAYLOAD_COUNT - 1)], values);
+        }
+        uint32_t cycles = ESP.getCycleCount() - startCycles;
+        int64_t elapsedUs = esp_timer_get_time() - startUs;
+        volatile int64_t keep = total;
+        (void)keep;
+
+        float signals = (float)iterations * SIGNAL_COUNT;
+        return {(float)cycles / signals, (float)elapsedUs * 1000.0f / signals};
+    }
+
+    static void printRow(const char* label, const Timing& timing, const Timing& reference) {
+        Serial.printf("%-26s %6.2f cycles/signal  %6.2f ns/signal (%.2fx)\n", label,
+                     timing.cyclesPerSignal, timing.nsPerSignal,
+                     reference.nsPerSignal > 0.0f ? timing.nsPerSignal / reference.nsPerSignal : 0.0f);
+    }
+
+public:
+    /**
+     * @brief Führt den Benchmark aus und gibt das Ergebnis auf Serial aus
+     * @param iterations Nutzdaten-Blöcke pro Variante (je 9 Signale)
+     */
+    static void run(uint32_t iterations = 100000) {
+        uint8_t payloads[PAYLOAD_COUNT][8];
+        buildPayloads(payloads);
+
+        // Gleiche Werte?
+        static constexpr FieldExtract VARIANTS[] = {tableFields, payloadFields, directFields};
+        uint32_t mismatches = 0;
+        for (size_t i = 0; i < PAYLOAD_COUNT; i++) {
+            int32_t expected[SIGNAL_COUNT];
+            legacyFields(payloads[i], expected);
+            for (FieldExtract variant : VARIANTS) {
+                int32_t values[SIGNAL_COUNT];
+                variant(payloads[i], values);
+                for (size_t s = 0; s < SIGNAL_COUNT; s++) {
+                    if (values[s] != expected[s]) {
+                        mismatches++;
+                        Serial.printf("[Bench] Mismatch %s: %ld vs. %ld\n", SIGNALS[s].name,
+                                     (long)expected[s], (long)values[s]);
+                    }
+                }
+            }
+        }
+
+        Timing legacy = measure(iterations, payloads, legacyFields);
+        Timing table = measure(iterations, payloads, tableFields);
+        Timing payload = measure(iterations, payloads, payloadFields);
+        Timing direct = measure(iterations, payloads, directFields);
+
+        Serial.println("\n=== Field Extract Benchmark ===");
+        Serial.printf("Payloads:                  %lu x %u signals\n", iterations, (unsigned)SIGNAL_COUNT);
+        printRow("extractUint16/32 (legacy):", legacy, legacy);
+        printRow("Signal table (extractRaw):", table, legacy);
+        printRow("CanField (CanPayload):", payload, legacy);
+        printRow("CanField (get(data)):", direct, legacy);
+        Serial.printf("Value mismatches:          %lu\n", mismatches);
+        Serial.println("===============================\n");
+    }
+};
+
+#endif // FIELD_EXTRACT_BENCH_H
@@ -0,0 +1,152 @@
+/**
+ * @file protocol_dispatch_bench.h
+ * @brief Benchmark: Zuordnung Frame -> Protokoll-Decoder
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Vergleicht drei Wege vom Frame zum Decoder:
+ *   - Virtuelle Schleife: canAcceptMessage() je Protokoll, dann
+ *     parseMessage() (ursprüngliche ProtocolManager-Logik)
+ *   - ProtocolManager::routeMessage(): Routing-Tabelle zur Laufzeit,
+ *     Payload-Cache, ein virtueller Aufruf
+ *   - ProtocolSet: perfekter Hash zur Compile-Zeit, statischer Aufruf
+ *
+ * Die Frames haben DLC 7, alle Decoder steigen nach der Längenprüfung
+ * aus. Gemessen wird damit nur Zuordnung und Aufruf, ohne Serial-
+ * Ausgaben der Decoder. Zeitbasis esp_timer, läuft auch im Host-Build
+ * (host/can_bench). Aufruf über das Serial-Kommando "bench".
+ *
+ * SPEICHERN ALS: src/bench/protocol_dispatch_bench.h
+ */
+
+#ifndef PROTOCOL_DISPATCH_BENCH_H
+#define PROTOCOL_DISPATCH_BENCH_H
+
+#include <Arduino.h>
+#include "esp_timer.h"
+#include "../managers/protocol_manager.h"
+#include "../managers/protocol_set.h"
+#include "../protocols/pylontech_can.h"
+#include "../protocols/jk_bms_can.h"
+#include "../protocols/daly_can.h"
+
+class ProtocolDispatchBench {
+private:
+    using BmsProtocols = ProtocolSet<PylontechCan, JkBmsCan, DalyCan>;
+
+    static constexpr size_t FRAME_COUNT = 16;
+
+    struct FrameSpec {
+        uint32_t id;
+        bool extended;
+    };
+
+    /**
+     * @brief Frame-Mix: IDs aller Protokolle plus fremde IDs (Filter offen)
+     */
+    static void buildFrames(CanFrame* frames) {
+        static constexpr FrameSpec specs[FRAME_COUNT] = {
+            {0x359, false}, {0x35C, false}, {0x355, false}, {0x356, false},
+            {0x35E, false}, {0x35A, false},
+            {0x18FF50E5, true}, {0x18FF51E5, true}, {0x18FF52E5, true},
+            {0x18FF53E5, true}, {0x18FF54E5, true}, {0x18FF55E5, true},
+            {0x02F4DA01, true}, {0x02F4DA04, true},
+            {0x123, false}, {0x0CF00400, true}
+        };
+        for (size_t i = 0; i < FRAME_COUNT; i++) {
+            memset(&frames[i], 0, sizeof(CanFrame));
+            frames[i].id = specs[i].id;
+            frames[i].flags = specs[i].extended ? CanFrame::FLAG_EXTENDED : 0;
+            frames[i].length = 7;
+        }
+    }
+
+    template <typename Fn>
+    static float measure(uint32_t iterations, const CanFrame* frames, Fn&& call) {
+        uint32_t sink = 0;
+        int64_t start = esp_timer_get_time();
+        for (uint32_t i = 0; i < iterations; i++) {
+            sink += call(frames[i & (FRAME_COUNT - 1)]) ? 1 : 0;
+        }
+        int64_t elapsedUs = esp_timer_get_time() - start;
+        volatile uint32_t keep = sink;
+        (void)keep;
+        return (float)elapsedUs * 1000.0f / iterations;
+    }
+
+public:
+    /**
+     * @brief Führt den Benchmark aus und gibt das Ergebnis auf Serial aus
+     * @param iterations Frames pro Variante
+     */
+    static void run(uint32_t iterations = 100000) {
+        static PylontechCan pylontech;
+        static JkBmsCan jkBms;
+        static DalyCan daly;
+        static ProtocolManager manager;
+        static BmsProtocols protocolSet(pylontech, jkBms, daly);
+        static bool registered = false;
+
+        if (!registered) {
+            manager.registerProtocol(&pylontech);
+            manager.registerProtocol(&jkBms);
+            manager.registerProtocol(&daly);
+            registered = true;
+        }
+
+        CanFrame frames[FRAME_COUNT];
+        buildFrames(frames);
+
+        // Über volatile Zeiger, damit der Compiler die virtuellen Aufrufe
+        // nicht anhand der bekannten Objekttypen auflöst
+        static CanProtocolBase* protocols[] = { &pylontech, &jkBms, &daly };
+        CanProtocolBase** volatile protocolList = protocols;
+        ProtocolManager* volatile managerPtr = &manager;
+
+        // Gleiche Zuordnung in beiden Varianten?
+        uint32_t mismatches = 0;
+        for (size_t i = 0; i < FRAME_COUNT; i++) {
+            int expected = BmsProtocols::NO_ROUTE;
+            for (int p = 0; p < 3; p++) {
+                if (protocols[p]->canAcceptMessage(frames[i].id, frames[i].isExtended())) {
+                    expected = p;
+                    break;
+                }
+            }
+            if (BmsProtocols::route(frames[i]) != expected) {
+                mismatches++;
+            }
+        }
+
+        float virtualLoop = measure(iterations, frames, [&](const CanFrame& f) {
+            CanProtocolBase** list = protocolList;
+            for (int p = 0; p < 3; p++) {
+                if (list[p]->canAcceptMessage(f.id, f.isExtended())) {
+                    return list[p]->parseMessage(f);
+                }
+            }
+            return false;
+        });
+        float routeTable = measure(iterations, frames, [&](const CanFrame& f) {
+            return managerPtr->routeMessage(f);
+        });
+        float staticSet = measure(iterations, frames, [&](const CanFrame& f) {
+            return protocolSet.dispatch(f);
+        });
+
+        Serial.println("\n=== Protocol Dispatch Benchmark ===");
+        Serial.printf("Frames:                    %lu (%u IDs, %u exact routes, %u masked)\n",
+                     iterations, (unsigned)FRAME_COUNT,
+                     (unsigned)BmsProtocols::getExactCount(), (unsigned)BmsProtocols::getMaskCount());
+        Serial.printf("Virtual loop:              %6.1f ns/frame\n", virtualLoop);
+        Serial.printf("ProtocolManager (table):   %6.1f ns/frame\n", routeTable);
+        Serial.printf("ProtocolSet (static):      %6.1f ns/frame (%.1fx vs. loop)\n",
+                     staticSet, staticSet > 0.0f ? virtualLoop / staticSet : 0.0f);
+        Serial.printf("Perfect hash: %u slots, multiplier 0x%08lX, routing mismatches: %lu\n",
+                     (unsigned)BmsProtocols::getTableSize(),
+                     BmsProtocols::getHashMultiplier(), mismatches);
+        Serial.println("===================================\n");
+    }
+};
+
+#endif // PROTOCOL_DISPATCH_BENCH_H
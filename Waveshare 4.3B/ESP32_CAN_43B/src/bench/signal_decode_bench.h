@@ -0,0 +1,299 @@
+/**
+ * @file signal_decode_bench.h
+ * @brief Benchmark: Signaltabellen (CanSignalDecoder) gegen switch-Parser
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Die früheren handgeschriebenen parseMessage()-Varianten von Pylontech,
+ * JK BMS und DALY sind hier ohne Serial-Ausgaben als Referenz erhalten.
+ * Beide Varianten decodieren denselben Frame-Mix (gültige Nutzdaten aller
+ * drei Protokolle) in ein lokales bms_data_t; verglichen werden Laufzeit
+ * und Ergebnis (Werte mit Toleranz, status_text exakt).
+ *
+ * Zeitbasis esp_timer, läuft auch im Host-Build (host/can_bench).
+ * Aufruf über das Serial-Kommando "bench".
+ *
+ * SPEICHERN ALS: src/bench/signal_decode_bench.h
+ */
+
+#ifndef SIGNAL_DECODE_BENCH_H
+#define SIGNAL_DECODE_BENCH_H
+
+#include <Arduino.h>
+#include <math.h>
+#include "esp_timer.h"
+#include "../protocols/can_signal_decoder.h"
+#include "../protocols/pylontech_can.h"
+#include "../protocols/jk_bms_can.h"
+#include "../protocols/daly_can.h"
+
+class SignalDecodeBench {
+private:
+    static constexpr size_t FRAME_COUNT = 16;
+
+    enum Family : uint8_t {
+        FAMILY_PYLONTECH,
+        FAMILY_JK,
+        FAMILY_DALY
+    };
+
+    struct FrameSpec {
+        Family family;
+        uint32_t id;
+        uint8_t data[8];
+    };
+
+    static constexpr FrameSpec SPECS[FRAME_COUNT] = {
+        {FAMILY_PYLONTECH, 0x359, {0x14, 0x50, 0, 0, 0, 0, 0, 0}},              // 52.00 V
+        {FAMILY_PYLONTECH, 0x35C, {0xFF, 0x9C, 0, 0, 0, 0, 0, 0}},              // -10.0 A
+        {FAMILY_PYLONTECH, 0x355, {0x02, 0xEE, 0, 0, 0, 0, 0, 0}},              // 75.0 %
+        {FAMILY_PYLONTECH, 0x356, {0x00, 0xFA, 0, 0, 0, 0, 0, 0}},              // 25.0 °C
+        {FAMILY_PYLONTECH, 0x35E, {0x01, 0x2C, 0, 0, 0, 0, 0, 0}},              // 300 Zyklen
+        {FAMILY_PYLONTECH, 0x35A, {0x04, 0, 0, 0, 0, 0, 0, 0}},                 // Alarm 0x04
+        {FAMILY_JK, 0x02F4DA01, {0x00, 0x00, 0xCB, 0x20, 0, 0, 0, 0}},          // 52.000 V
+        {FAMILY_JK, 0x02F4DA02, {0xFF, 0xFF, 0xD8, 0xF0, 0, 0, 0, 0}},          // -10.000 A
+        {FAMILY_JK, 0x02F4DA03, {0x1D, 0x4C, 0, 0, 0, 0, 0, 0}},                // 75.00 %
+        {FAMILY_JK, 0x02F4DA05, {0x03, 0x00, 0x01, 0x2C, 0, 0, 0, 0}},          // Status 3, 300 Zyklen
+        {FAMILY_DALY, 0x18FF50E5, {0x08, 0x02, 0, 0, 0, 0, 0, 0}},              // 52.0 V
+        {FAMILY_DALY, 0x18FF51E5, {0x9C, 0xFF, 0, 0, 0, 0, 0, 0}},              // -10.0 A
+        {FAMILY_DALY, 0x18FF52E5, {0xEE, 0x02, 0, 0, 0, 0, 0, 0}},              // 75.0 %
+        {FAMILY_DALY, 0x18FF53E5, {0xFA, 0x00, 0, 0, 0, 0, 0, 0}},              // 25.0 °C
+        {FAMILY_DALY, 0x18FF54E5, {0x01, 0x00, 0, 0, 0x2C, 0x01, 0, 0}},        // 300 Zyklen
+        {FAMILY_DALY, 0x18FF54E6, {0x01, 0x02, 0, 0, 0x2D, 0x01, 0, 0}}         // Alarm, 301 Zyklen
+    };
+
+    // ========================================================================
+    // Referenz: frühere switch-Parser (ohne Serial-Ausgaben)
+    // ========================================================================
+
+    static uint16_t be16(const uint8_t* data, size_t offset) {
+        return (uint16_t)(data[offset] << 8) | data[offset + 1];
+    }
+
+    static uint16_t le16(const uint8_t* data, size_t offset) {
+        return (uint16_t)(data[offset + 1] << 8) | data[offset];
+    }
+
+    static uint32_t be32(const uint8_t* data, size_t offset) {
+        return ((uint32_t)data[offset] << 24) | ((uint32_t)data[offset + 1] << 16) |
+               ((uint32_t)data[offset + 2] << 8) | (uint32_t)data[offset + 3];
+    }
+
+    static bool inRange(float value, float minValue, float maxValue) {
+        return value >= minValue && value <= maxValue;
+    }
+
+    static void setCurrent(bms_data_t& data, float current) {
+        data.current = current;
+        data.charging = (current > 0.5f);
+        data.discharging = (current < -0.5f);
+    }
+
+    static bool __attribute__((noinline)) legacyPylontech(const CanFrame& frame, bms_data_t& data) {
+        if (frame.length < 8) {
+            return false;
+        }
+        switch (frame.id) {
+            case 0x359:
+                data.voltage = be16(frame.data, 0) * 0.01f;
+                return inRange(data.voltage, 40.0f, 60.0f);
+            case 0x35C:
+                setCurrent(data, (int16_t)be16(frame.data, 0) * 0.1f);
+                return true;
+            case 0x355:
+                data.soc = be16(frame.data, 0) * 0.1f;
+                return inRange(data.soc, 0.0f, 100.0f);
+            case 0x356:
+                data.temperature = (int16_t)be16(frame.data, 0) * 0.1f;
+                return inRange(data.temperature, -20.0f, 60.0f);
+            case 0x35E:
+                data.cycles = be16(frame.data, 0);
+                snprintf(data.status_text, sizeof(data.status_text), "Online - %u Zyklen", data.cycles);
+                return true;
+            case 0x35A:
+                if (frame.data[0] != 0) {
+                    snprintf(data.status_text, sizeof(data.status_text), "ALARM 0x%02X", frame.data[0]);
+                } else {
+                    snprintf(data.status_text, sizeof(data.status_text), "Online");
+                }
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static bool __attribute__((noinline)) legacyJk(const CanFrame& frame, bms_data_t& data) {
+        if (frame.length < 8) {
+            return false;
+        }
+        switch (frame.id & 0xFF) {
+            case 0x01:
+                data.voltage = be32(frame.data, 0) / 1000.0f;
+                return inRange(data.voltage, 40.0f, 60.0f);
+            case 0x02:
+                setCurrent(data, (int32_t)be32(frame.data, 0) / 1000.0f);
+                return true;
+            case 0x03:
+                data.soc = be16(frame.data, 0) * 0.01f;
+                return inRange(data.soc, 0.0f, 100.0f);
+            case 0x04:
+                data.temperature = (int16_t)be16(frame.data, 0) * 0.1f;
+                return inRange(data.temperature, -20.0f, 60.0f);
+            case 0x05:
+                data.cycles = be16(frame.data, 2);
+                snprintf(data.status_text, sizeof(data.status_text),
+                         "Online - Status: 0x%02X - %u Zyklen", frame.data[0], data.cycles);
+                return true;
+            case 0x10:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static bool __attribute__((noinline)) legacyDaly(const CanFrame& frame, bms_data_t& data) {
+        if (frame.length < 8) {
+            return false;
+        }
+        switch (frame.id & 0x1FFFFF00) {
+            case 0x18FF5000:
+                data.voltage = le16(frame.data, 0) * 0.1f;
+                return inRange(data.voltage, 40.0f, 60.0f);
+            case 0x18FF5100:
+                setCurrent(data, (int16_t)le16(frame.data, 0) * 0.1f);
+                return true;
+            case 0x18FF5200:
+                data.soc = le16(frame.data, 0) * 0.1f;
+                return inRange(data.soc, 0.0f, 100.0f);
+            case 0x18FF5300:
+                data.temperature = (int16_t)le16(frame.data, 0) * 0.1f;
+                return inRange(data.temperature, -20.0f, 60.0f);
+            case 0x18FF5400:
+                data.cycles = le16(frame.data, 4);
+                if (frame.data[1] != 0) {
+                    snprintf(data.status_text, sizeof(data.status_text),
+                             "ALARM 0x%02X - %u Zyklen", frame.data[1], data.cycles);
+                } else {
+                    snprintf(data.status_text, sizeof(data.status_text),
+                             "Online - %u Zyklen", data.cycles);
+                }
+                return true;
+            case 0x18FF5500:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static bool legacyDecode(Family family, const CanFrame& frame, bms_data_t& data) {
+        switch (family) {
+            case FAMILY_PYLONTECH:  return legacyPylontech(frame, data);
+            case FAMILY_JK:         return legacyJk(frame, data);
+            default:                return legacyDaly(frame, data);
+        }
+    }
+
+    // ========================================================================
+    // Tabellengesteuert
+    // ========================================================================
+
+    template <size_t N>
+    static bool tableDecode(const CanMessageDef (&messages)[N], const CanFrame& frame, bms_data_t& data) {
+        const CanMessageDef* message = CanSignalDecoder::find(messages, frame);
+        return message && CanSignalDecoder::decode(*message, frame, data) == CanSignalDecoder::DECODE_OK;
+    }
+
+    static bool __attribute__((noinline)) signalDecode(Family family, const CanFrame& frame, bms_data_t& data) {
+        switch (family) {
+            case FAMILY_PYLONTECH:  return tableDecode(PylontechCan::MESSAGES, frame, data);
+            case FAMILY_JK:         return tableDecode(JkBmsCan::MESSAGES, frame, data);
+            default:                return tableDecode(DalyCan::MESSAGES, frame, data);
+        }
+    }
+
+    // ========================================================================
+    // Messung
+    // ========================================================================
+
+    static void buildFrames(CanFrame* frames) {
+        for (size_t i = 0; i < FRAME_COUNT; i++) {
+            memset(&frames[i], 0, sizeof(CanFrame));
+            frames[i].id = SPECS[i].id;
+            frames[i].flags = SPECS[i].family == FAMILY_PYLONTECH ? 0 : CanFrame::FLAG_EXTENDED;
+            frames[i].length = 8;
+            memcpy(frames[i].data, SPECS[i].data, 8);
+        }
+    }
+
+    static bool sameResult(const bms_data_t& a, const bms_data_t& b) {
+        return fabsf(a.voltage - b.voltage) < 0.001f &&
+               fabsf(a.current - b.current) < 0.001f &&
+               fabsf(a.soc - b.soc) < 0.001f &&
+               fabsf(a.temperature - b.temperature) < 0.001f &&
+               a.cycles == b.cycles &&
+               a.charging == b.charging && a.discharging == b.discharging &&
+               strcmp(a.status_text, b.status_text) == 0;
+    }
+
+    template <typename Fn>
+    static float measure(uint32_t iterations, const CanFrame* frames, Fn&& decode) {
+        bms_data_t data;
+        uint32_t sink = 0;
+        int64_t start = esp_timer_get_time();
+        for (uint32_t i = 0; i < iterations; i++) {
+            size_t index = i & (FRAME_COUNT - 1);
+            sink += decode(SPECS[index].family, frames[index], data) ? 1 : 0;
+        }
+        int64_t elapsedUs = esp_timer_get_time() - start;
+        volatile uint32_t keep = sink + data.cycles;
+        (void)keep;
+        return (float)elapsedUs * 1000.0f / iterations;
+    }
+
+public:
+    /**
+     * @brief Führt den Benchmark aus und gibt das Ergebnis auf Serial aus
+     * @param iterations Frames pro Variante
+     */
+    static void run(uint32_t iterations = 100000) {
+        CanFrame frames[FRAME_COUNT];
+        buildFrames(frames);
+
+        // Gleiche Ergebnisse?
+        uint32_t mismatches = 0;
+        uint32_t signals = 0;
+        for (size_t i = 0; i < FRAME_COUNT; i++) {
+            bms_data_t legacy;
+            bms_data_t table;
+            bool legacyOk = legacyDecode(SPECS[i].family, frames[i], legacy);
+            bool tableOk = signalDecode(SPECS[i].family, frames[i], table);
+            if (legacyOk != tableOk || !sameResult(legacy, table)) {
+                mismatches++;
+                Serial.printf("[Bench] Mismatch 0x%lX: '%s' vs. '%s'\n",
+                             frames[i].id, legacy.status_text, table.status_text);
+            }
+
+            const CanMessageDef* message = SPECS[i].family == FAMILY_PYLONTECH
+                ? CanSignalDecoder::find(PylontechCan::MESSAGES, frames[i])
+                : (SPECS[i].family == FAMILY_JK ? CanSignalDecoder::find(JkBmsCan::MESSAGES, frames[i])
+                                                : CanSignalDecoder::find(DalyCan::MESSAGES, frames[i]));
+            signals += message ? message->signalCount : 0;
+        }
+
+        float legacy = measure(iterations, frames, legacyDecode);
+        float table = measure(iterations, frames, signalDecode);
+        float signalsPerFrame = (float)signals / FRAME_COUNT;
+
+        Serial.println("\n=== Signal Decode Benchmark ===");
+        Serial.printf("Frames:                    %lu (%u messages, %.2f signals/frame)\n",
+                     iterations, (unsigned)FRAME_COUNT, signalsPerFrame);
+        Serial.printf("switch parsers (legacy):   %6.1f ns/frame\n", legacy);
+        Serial.printf("Signal tables:             %6.1f ns/frame (%.2fx), %.1f ns/signal\n",
+                     table, legacy > 0.0f ? table / legacy : 0.0f,
+                     signalsPerFrame > 0.0f ? table / signalsPerFrame : 0.0f);
+        Serial.printf("Result mismatches:         %lu\n", mismatches);
+        Serial.println("===============================\n");
+    }
+};
+
+#endif // SIGNAL_DECODE_BENCH_H
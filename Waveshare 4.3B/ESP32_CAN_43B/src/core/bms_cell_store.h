@@ -0,0 +1,162 @@
+/**
+ * @file bms_cell_store.h
+ * @brief Zellspannungen und Sensor-Temperaturen eines Packs
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Spannungen und Temperaturen liegen als getrennte, dicht gepackte
+ * Arrays (uint16_t mV bzw. int16_t 0.1 °C) im bms_data_t, ein Pack mit
+ * 32 Zellen und 16 Sensoren belegt so 104 Bytes. Welche Einträge
+ * gültig sind, sagen die Bitmasken.
+ *
+ * Schwächste und stärkste Zelle (und damit Minimum, Maximum und
+ * Differenz) werden bei jeder Zellspannung nachgeführt. Einen Durchlauf
+ * über die Zellen gibt es nur, wenn sich die bisherige Extremwert-Zelle
+ * in Richtung Mitte bewegt.
+ *
+ * Trivial kopierbar, mit 0 gefüllt = leer (memset auf bms_data_t).
+ *
+ * SPEICHERN ALS: src/core/bms_cell_store.h
+ */
+
+#ifndef BMS_CELL_STORE_H
+#define BMS_CELL_STORE_H
+
+#include <stdint.h>
+#include <string.h>
+
+struct BmsCellStore {
+    static constexpr uint8_t MAX_CELLS = 32;
+    static constexpr uint8_t MAX_TEMPS = 16;
+    static constexpr uint8_t NO_CELL = 0xFF;
+
+    uint16_t voltageMv[MAX_CELLS];      ///< Zellspannungen in mV
+    int16_t temperature[MAX_TEMPS];     ///< Sensor-Temperaturen in 0.1 °C
+    uint32_t cellMask;                  ///< Bit i = voltageMv[i] gültig
+    uint16_t tempMask;                  ///< Bit i = temperature[i] gültig
+    uint8_t minCell;                    ///< Schwächste Zelle (nur wenn cellMask != 0)
+    uint8_t maxCell;                    ///< Stärkste Zelle (nur wenn cellMask != 0)
+
+    void clear() {
+        memset(this, 0, sizeof(*this));
+    }
+
+    /**
+     * @brief Setzt eine Zellspannung und führt Minimum/Maximum nach
+     * @param index Zelle 0..MAX_CELLS-1 (größere Indizes werden ignoriert)
+     * @param mv Spannung in mV
+     */
+    void setVoltage(uint8_t index, uint16_t mv) {
+        if (index >= MAX_CELLS) {
+            return;
+        }
+        uint32_t bit = 1u << index;
+        uint16_t old = voltageMv[index];
+        bool known = (cellMask & bit) != 0;
+        voltageMv[index] = mv;
+
+        if (cellMask == 0) {
+            cellMask = bit;
+            minCell = index;
+            maxCell = index;
+            return;
+        }
+        cellMask |= bit;
+        if (known && mv == old) {
+            return;
+        }
+
+        if (mv < voltageMv[minCell]) {
+            minCell = index;
+        } else if (index == minCell && mv > old) {
+            minCell = findExtreme(false);
+        }
+        if (mv > voltageMv[maxCell]) {
+            maxCell = index;
+        } else if (index == maxCell && mv < old) {
+            maxCell = findExtreme(true);
+        }
+    }
+
+    /**
+     * @brief Setzt eine Sensor-Temperatur
+     * @param index Sensor 0..MAX_TEMPS-1 (größere Indizes werden ignoriert)
+     * @param deciCelsius Temperatur in 0.1 °C
+     */
+    void setTemperature(uint8_t index, int16_t deciCelsius) {
+        if (index >= MAX_TEMPS) {
+            return;
+        }
+        temperature[index] = deciCelsius;
+        tempMask |= (uint16_t)(1u << index);
+    }
+
+    uint8_t getCellCount() const {
+        return (uint8_t)__builtin_popcount(cellMask);
+    }
+
+    uint8_t getTemperatureCount() const {
+        return (uint8_t)__builtin_popcount(tempMask);
+    }
+
+    /**
+     * @brief Index der Zelle mit der niedrigsten Spannung, NO_CELL = keine
+     */
+    uint8_t getWeakestCell() const {
+        return cellMask ? minCell : NO_CELL;
+    }
+
+    /**
+     * @brief Index der Zelle mit der höchsten Spannung, NO_CELL = keine
+     */
+    uint8_t getStrongestCell() const {
+        return cellMask ? maxCell : NO_CELL;
+    }
+
+    uint16_t getMinMv() const {
+        return cellMask ? voltageMv[minCell] : 0;
+    }
+
+    uint16_t getMaxMv() const {
+        return cellMask ? voltageMv[maxCell] : 0;
+    }
+
+    /**
+     * @brief Zelldrift: höchste minus niedrigste Zellspannung in mV
+     */
+    uint16_t getDeltaMv() const {
+        return (uint16_t)(getMaxMv() - getMinMv());
+    }
+
+    /**
+     * @brief Temperaturbereich der Sensoren (Durchlauf, nur für Ausgaben)
+     * @return false wenn kein Sensor gemeldet wurde
+     */
+    bool getTemperatureRange(int16_t& minDeci, int16_t& maxDeci) const {
+        if (tempMask == 0) {
+            return false;
+        }
+        minDeci = INT16_MAX;
+        maxDeci = INT16_MIN;
+        for (uint32_t mask = tempMask; mask; mask &= mask - 1) {
+            int16_t value = temperature[__builtin_ctz(mask)];
+            if (value < minDeci) minDeci = value;
+            if (value > maxDeci) maxDeci = value;
+        }
+        return true;
+    }
+
+private:
+    uint8_t findExtreme(bool highest) const {
+        uint8_t best = (uint8_t)__builtin_ctz(cellMask);
+        for (uint32_t mask = cellMask & (cellMask - 1); mask; mask &= mask - 1) {
+            uint8_t index = (uint8_t)__builtin_ctz(mask);
+            if (highest ? voltageMv[index] > voltageMv[best] : voltageMv[index] < voltageMv[best]) {
+                best = index;
+            }
+        }
+        return best;
+    }
+};
+
+#endif // BMS_CELL_STORE_H
@@ -13,6 +13,7 @@
 
 #include <stdint.h>
 #include <string.h>
+#include "bms_cell_store.h"
 
 //=============================================================================
 // BMS Typen
@@ -28,7 +29,8 @@ enum bms_type_t {
     BMS_DALY,               ///< DALY BMS
     BMS_SEPLOS,             ///< Seplos BMS
     BMS_EVE,                ///< EVE LiFePO4 BMS
-    BMS_LIFEPO4_POWER       ///< LiFePO4 Power BMS
+    BMS_LIFEPO4_POWER,      ///< LiFePO4 Power BMS
+    BMS_DBC                 ///< Aus einer DBC-Datei generiertes Protokoll
 };
 
 //=============================================================================
@@ -57,6 +59,9 @@ struct bms_data_t {
     bool charging;                  ///< true = wird geladen
     bool discharging;               ///< true = wird entladen
     
+    // Zellen
+    BmsCellStore cells;             ///< Zellspannungen, Sensor-Temperaturen
+    
     // Status
     char status_text[64];           ///< Status-Text für UI
     uint32_t last_update;           ///< Zeitstempel des letzten Updates (millis())
@@ -72,6 +77,7 @@ struct bms_data_t {
         cycles = 0;
         charging = false;
         discharging = false;
+        cells.clear();
         memset(status_text, 0, sizeof(status_text));
         last_update = 0;
     }
@@ -166,6 +172,7 @@ inline const char* getBmsTypeName(bms_type_t type) {
         case BMS_SEPLOS:        return "Seplos";
         case BMS_EVE:           return "EVE LiFePO4";
         case BMS_LIFEPO4_POWER: return "LiFePO4 Power";
+        case BMS_DBC:           return "DBC";
         case BMS_NONE:          
         default:                return "Unknown";
     }
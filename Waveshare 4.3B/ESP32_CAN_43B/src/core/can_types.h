@@ -0,0 +1,90 @@
+/**
+ * @file can_types.h
+ * @brief Gemeinsame CAN-Datentypen
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Hardware-unabhängige Typen, die sowohl vom CAN-Treiber als auch von
+ * den Protokollen verwendet werden.
+ *
+ * SPEICHERN ALS: src/core/can_types.h
+ */
+
+#ifndef CAN_TYPES_H
+#define CAN_TYPES_H
+
+#include <stdint.h>
+
+//=============================================================================
+// Konstanten
+//=============================================================================
+
+static constexpr uint32_t CAN_STD_ID_MASK = 0x000007FF;   ///< 11-Bit Identifier
+static constexpr uint32_t CAN_EXT_ID_MASK = 0x1FFFFFFF;   ///< 29-Bit Identifier
+static constexpr uint32_t CAN_KEY_EXTENDED = 0x80000000;  ///< IDE-Bit im Routing-Schlüssel
+
+/**
+ * @brief Eindeutiger Schlüssel aus Identifier und IDE-Flag
+ *
+ * 11-Bit 0x359 und 29-Bit 0x00000359 ergeben verschiedene Schlüssel.
+ */
+static constexpr uint32_t canKey(uint32_t id, bool extended) {
+    return extended ? ((id & CAN_EXT_ID_MASK) | CAN_KEY_EXTENDED)
+                    : (id & CAN_STD_ID_MASK);
+}
+
+//=============================================================================
+// CAN Frame
+//=============================================================================
+
+/**
+ * @brief Empfangener CAN-Frame mit Zeitstempel
+ *
+ * Wird im RX-Task einmal aus der TWAI-Nachricht erzeugt und danach nur
+ * noch per const-Referenz durch Ring, ProtocolManager und Protokolle
+ * gereicht. 24 Byte, ein Frame pro Ring-Slot.
+ */
+struct CanFrame {
+    int64_t timestampUs;            ///< RX-Zeitstempel (esp_timer_get_time)
+    uint32_t id;                    ///< CAN-Identifier (11 oder 29 Bit)
+    uint8_t length;                 ///< Datenlänge (DLC)
+    uint8_t flags;                  ///< FLAG_EXTENDED / FLAG_RTR
+    uint8_t data[8];                ///< Nutzdaten
+
+    static constexpr uint8_t FLAG_EXTENDED = 0x01;  ///< 29-Bit Identifier
+    static constexpr uint8_t FLAG_RTR      = 0x02;  ///< Remote Transmission Request
+
+    bool isExtended() const { return (flags & FLAG_EXTENDED) != 0; }
+    bool isRtr() const { return (flags & FLAG_RTR) != 0; }
+    uint32_t key() const { return canKey(id, isExtended()); }
+};
+
+//=============================================================================
+// Akzeptanzfilter
+//=============================================================================
+
+/**
+ * @brief ID-Filter, den ein Protokoll für seine Nachrichten deklariert
+ *
+ * Dient als Grundlage für die TWAI-Hardwarefilter. Ein Frame passt, wenn
+ * (canId & mask) == (id & mask) und der Frame-Typ (11/29 Bit) stimmt.
+ */
+struct CanIdFilter {
+    uint32_t id;                    ///< Identifier
+    uint32_t mask;                  ///< Relevante Bits (1 = muss übereinstimmen)
+    bool extended;                  ///< true = 29-Bit Identifier
+
+    constexpr bool matches(uint32_t canId, bool isExtended) const {
+        return isExtended == extended && ((canId ^ id) & mask) == 0;
+    }
+
+    /**
+     * @brief true wenn der Filter genau einen Identifier beschreibt
+     */
+    constexpr bool isExact() const {
+        uint32_t full = extended ? CAN_EXT_ID_MASK : CAN_STD_ID_MASK;
+        return (mask & full) == full;
+    }
+};
+
+#endif // CAN_TYPES_H
@@ -0,0 +1,445 @@
+/**
+ * @file deferred_log.h
+ * @brief Verzögertes Logging: Format-ID und Rohargumente statt printf
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Serial.printf() im Decode-Task kostet pro Zeichen ~87 us (115200 Baud)
+ * und blockiert, sobald der UART-TX-FIFO voll ist. BMS_LOG_*() legt
+ * stattdessen nur die Adresse des Format-Strings (die "Format-ID") und
+ * bis zu MAX_ARGS Argumente als 32-Bit Rohwerte in einen lock-freien
+ * Ring. Formatiert und ausgegeben wird später in drain() - auf dem ESP32
+ * in einem eigenen Task niedriger Priorität, im Host-Build aus der
+ * Hauptschleife. Ist der Ring voll, wird der Eintrag verworfen und
+ * gezählt, der Aufrufer wartet nie.
+ *
+ * Regeln für Aufrufer:
+ *   - Format-String und %s-Argumente müssen statisch sein (Literale,
+ *     Protokollnamen, Signaltabellen) - sie werden erst später gelesen
+ *   - Argumente: Ganzzahlen bis 32 Bit, float/double, const char*
+ *
+ * Log-Level zur Compile-Zeit: BMS_LOG_LEVEL (Default LOG_LEVEL_INFO).
+ * Aufrufe oberhalb des Levels entfallen samt Argument-Auswertung.
+ *
+ * Mehrere Producer (Decode-Task, loop()) sind erlaubt, es gibt genau
+ * einen Consumer (drain()). Vor init() wird sofort ausgegeben
+ * (Host-Werkzeuge, Benchmarks, früher Boot).
+ *
+ * SPEICHERN ALS: src/core/deferred_log.h
+ */
+
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <new>
+
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+// ============================================================================
+// Log-Level (Compile-Zeit)
+// ============================================================================
+
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef BMS_LOG_LEVEL
+#define BMS_LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define BMS_LOG(level, format, ...) \
+    do { \
+        if ((level) <= BMS_LOG_LEVEL) { \
+            DeferredLog::instance().write(format, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define BMS_LOG_ERROR(format, ...) BMS_LOG(LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#define BMS_LOG_WARN(format, ...)  BMS_LOG(LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#define BMS_LOG_INFO(format, ...)  BMS_LOG(LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#define BMS_LOG_DEBUG(format, ...) BMS_LOG(LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+
+// ============================================================================
+// Einträge
+// ============================================================================
+
+/**
+ * @brief Ein Argument als Rohwert, der Typ ergibt sich aus dem Format
+ */
+union LogArg {
+    int32_t i;
+    uint32_t u;
+    float f;
+    const char* s;
+};
+
+/**
+ * @brief Ein Log-Eintrag (32 Byte auf dem ESP32)
+ */
+struct LogRecord {
+    const char* format;             ///< Format-ID: Adresse des Literals
+    uint8_t argCount;
+    LogArg args[6];                 ///< DeferredLog::MAX_ARGS
+};
+
+/**
+ * @brief Lock-freier Log-Ring (mehrere Producer, ein Consumer)
+ */
+class DeferredLog {
+public:
+    static constexpr size_t MAX_ARGS = sizeof(LogRecord::args) / sizeof(LogArg);
+    static constexpr size_t LINE_LENGTH = 160;      ///< Längere Zeilen werden gekürzt
+
+private:
+    /**
+     * @brief Ring-Slot mit Sequenznummer (bounded MPMC nach Vyukov)
+     *
+     * sequence == Position: frei für den Producer dieser Position,
+     * sequence == Position + 1: gefüllt, bereit für den Consumer.
+     */
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        LogRecord record;
+    };
+
+    Slot* m_slots;
+    uint32_t m_capacity;            ///< Zweierpotenz
+    uint32_t m_mask;
+
+    std::atomic<uint32_t> m_head;   ///< Nächste Schreibposition (Producer)
+    std::atomic<uint32_t> m_tail;   ///< Nächste Leseposition (nur Consumer)
+
+    std::atomic<uint32_t> m_direct;     ///< Vor init() direkt ausgegeben
+    std::atomic<uint32_t> m_dropped;
+    uint32_t m_reportedDrops;       ///< Bereits gemeldete Verluste (Consumer)
+
+    DeferredLog()
+        : m_slots(nullptr)
+        , m_capacity(0)
+        , m_mask(0)
+        , m_head(0)
+        , m_tail(0)
+        , m_direct(0)
+        , m_dropped(0)
+        , m_reportedDrops(0)
+    {}
+
+    // ========================================================================
+    // Argumente verpacken
+    // ========================================================================
+
+    static LogArg pack(int value) { LogArg arg; arg.i = value; return arg; }
+    static LogArg pack(unsigned int value) { LogArg arg; arg.u = value; return arg; }
+    static LogArg pack(long value) { LogArg arg; arg.i = (int32_t)value; return arg; }
+    static LogArg pack(unsigned long value) { LogArg arg; arg.u = (uint32_t)value; return arg; }
+    static LogArg pack(double value) { LogArg arg; arg.f = (float)value; return arg; }
+    static LogArg pack(const char* value) { LogArg arg; arg.s = value; return arg; }
+
+    static void fill(LogArg*) {}
+
+    template <typename First, typename... Rest>
+    static void fill(LogArg* args, First first, Rest... rest) {
+        *args = pack(first);
+        fill(args + 1, rest...);
+    }
+
+    static uint32_t roundUpPow2(uint32_t value) {
+        uint32_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    static void emit(const LogRecord& record) {
+        char line[LINE_LENGTH];
+        format(record, line, sizeof(line));
+        Serial.print(line);
+    }
+
+public:
+    DeferredLog(const DeferredLog&) = delete;
+    DeferredLog& operator=(const DeferredLog&) = delete;
+
+    static DeferredLog& instance() {
+        static DeferredLog log;
+        return log;
+    }
+
+    /**
+     * @brief Reserviert den Ring, danach wird nur noch verzögert ausgegeben
+     * @param depth Einträge (wird auf Zweierpotenz aufgerundet)
+     * @note Einmal beim Start aufrufen, bevor geloggt wird
+     */
+    bool init(uint32_t depth) {
+        if (m_slots) {
+            return true;
+        }
+
+        uint32_t capacity = roundUpPow2(depth < 2 ? 2 : depth);
+        Slot* slots = new (std::nothrow) Slot[capacity];
+        if (!slots) {
+            return false;
+        }
+        for (uint32_t i = 0; i < capacity; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        m_capacity = capacity;
+        m_mask = capacity - 1;
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+        m_slots = slots;
+        return true;
+    }
+
+    // ========================================================================
+    // Producer-Seite (beliebiger Task)
+    // ========================================================================
+
+    /**
+     * @brief Legt einen Eintrag ab (BMS_LOG_*() verwenden)
+     * @return false wenn der Ring voll war (Eintrag verworfen)
+     */
+    template <typename... Args>
+    bool write(const char* format, Args... args) {
+        static_assert(sizeof...(Args) <= MAX_ARGS, "DeferredLog: zu viele Argumente");
+
+        if (!m_slots) {
+            LogRecord record;
+            record.format = format;
+            record.argCount = sizeof...(Args);
+            fill(record.args, args...);
+            m_direct.fetch_add(1, std::memory_order_relaxed);
+            emit(record);
+            return true;
+        }
+
+        uint32_t position = m_head.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &m_slots[position & m_mask];
+            uint32_t sequence = slot->sequence.load(std::memory_order_acquire);
+            int32_t diff = (int32_t)(sequence - position);
+            if (diff == 0) {
+                if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                position = m_head.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->record.format = format;
+        slot->record.argCount = sizeof...(Args);
+        fill(slot->record.args, args...);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // ========================================================================
+    // Consumer-Seite (ein Task)
+    // ========================================================================
+
+    /**
+     * @brief Formatiert und gibt bis zu maxRecords Einträge aus
+     * @return Anzahl ausgegebener Einträge
+     */
+    size_t drain(size_t maxRecords = SIZE_MAX) {
+        if (!m_slots) {
+            return 0;
+        }
+
+        uint32_t dropped = m_dropped.load(std::memory_order_relaxed);
+        if (dropped != m_reportedDrops) {
+            Serial.printf("[Log] %lu records dropped\n", dropped - m_reportedDrops);
+            m_reportedDrops = dropped;
+        }
+
+        size_t count = 0;
+        uint32_t position = m_tail.load(std::memory_order_relaxed);
+        while (count < maxRecords) {
+            Slot& slot = m_slots[position & m_mask];
+            if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+                break;
+            }
+            LogRecord record = slot.record;
+            slot.sequence.store(position + m_capacity, std::memory_order_release);
+            m_tail.store(++position, std::memory_order_relaxed);
+
+            emit(record);
+            count++;
+        }
+        return count;
+    }
+
+#ifdef ESP_PLATFORM
+    /**
+     * @brief Startet den Ausgabe-Task (niedrige Priorität)
+     * @param intervalMs Pause, wenn der Ring leer ist
+     */
+    bool startTask(UBaseType_t priority = 1, uint32_t intervalMs = 20) {
+        BaseType_t result = xTaskCreate(
+            [](void* parameter) {
+                TickType_t interval = pdMS_TO_TICKS((uint32_t)(uintptr_t)parameter);
+                for (;;) {
+                    DeferredLog::instance().drain();
+                    vTaskDelay(interval);
+                }
+            },
+            "log_task",
+            3072,           // Stack size (snprintf mit float)
+            (void*)(uintptr_t)intervalMs,
+            priority,
+            nullptr
+        );
+        if (result != pdPASS) {
+            Serial.println("[Log] ERROR: Failed to create log task");
+            return false;
+        }
+        return true;
+    }
+#endif
+
+    // ========================================================================
+    // Formatierung
+    // ========================================================================
+
+    /**
+     * @brief Setzt einen Eintrag in Text um (ein snprintf pro Platzhalter)
+     *
+     * Unterstützt Flags, Breite und Genauigkeit (auch '*'), die Längen
+     * 'h'/'l' sowie d i u o x X c s f F e E g G. Nicht unterstützt: %ll, %p, %n.
+     */
+    static size_t format(const LogRecord& record, char* out, size_t size) {
+        const char* text = record.format;
+        size_t length = 0;
+        size_t argIndex = 0;
+        out[0] = '\0';
+
+        auto nextArg = [&]() -> LogArg {
+            LogArg none;
+            none.u = 0;
+            return argIndex < record.argCount ? record.args[argIndex++] : none;
+        };
+
+        while (*text && length + 1 < size) {
+            if (*text != '%') {
+                out[length++] = *text++;
+                continue;
+            }
+            if (text[1] == '%') {
+                out[length++] = '%';
+                text += 2;
+                continue;
+            }
+
+            // Platzhalter einzeln kopieren: %[flags][breite][.genauigkeit][länge]typ
+            char spec[16];
+            size_t specLength = 0;
+            bool isLong = false;
+            int stars[2];
+            size_t starCount = 0;
+            while (*text && specLength + 1 < sizeof(spec)) {
+                char c = *text++;
+                spec[specLength++] = c;
+                if (c == '*' && starCount < 2) {
+                    stars[starCount++] = nextArg().i;
+                } else if (c == 'l') {
+                    isLong = true;
+                } else if (specLength > 1 && strchr("diouxXcsfFeEgG", c)) {
+                    break;
+                }
+            }
+            spec[specLength] = '\0';
+
+            char conversion = spec[specLength - 1];
+            LogArg arg = nextArg();
+            char* target = out + length;
+            size_t space = size - length;
+            int written;
+
+            auto put = [&](auto value) {
+                if (starCount == 2) return snprintf(target, space, spec, stars[0], stars[1], value);
+                if (starCount == 1) return snprintf(target, space, spec, stars[0], value);
+                return snprintf(target, space, spec, value);
+            };
+
+            switch (conversion) {
+                case 'd':
+                case 'i':
+                    written = isLong ? put((long)arg.i) : put((int)arg.i);
+                    break;
+                case 'u':
+                case 'o':
+                case 'x':
+                case 'X':
+                    written = isLong ? put((unsigned long)arg.u) : put((unsigned int)arg.u);
+                    break;
+                case 'c':
+                    written = put((int)arg.i);
+                    break;
+                case 's':
+                    written = put(arg.s ? arg.s : "(null)");
+                    break;
+                case 'f':
+                case 'F':
+                case 'e':
+                case 'E':
+                case 'g':
+                case 'G':
+                    written = put((double)arg.f);
+                    break;
+                default:
+                    written = snprintf(target, space, "%s", spec);
+                    break;
+            }
+
+            if (written < 0) {
+                break;
+            }
+            length += (size_t)written < space ? (size_t)written : space - 1;
+        }
+
+        out[length] = '\0';
+        return length;
+    }
+
+    // ========================================================================
+    // Statistik
+    // ========================================================================
+
+    bool isDeferred() const { return m_slots != nullptr; }
+    uint32_t getCapacity() const { return m_capacity; }
+    uint32_t getWritten() const {
+        return m_direct.load(std::memory_order_relaxed) + m_head.load(std::memory_order_relaxed);
+    }
+    uint32_t getDropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Einträge im Ring (Näherung, beliebiger Task)
+     */
+    uint32_t getPending() const {
+        if (!m_slots) {
+            return 0;
+        }
+        return m_head.load(std::memory_order_relaxed) - m_tail.load(std::memory_order_relaxed);
+    }
+
+    void printStats() const {
+        Serial.printf("Log: %lu written, %lu dropped, %lu pending (ring %lu, level %d)\n",
+                     getWritten(), getDropped(), getPending(), m_capacity, BMS_LOG_LEVEL);
+    }
+};
+
+#endif // DEFERRED_LOG_H
@@ -0,0 +1,97 @@
+/**
+ * @file seqlock_snapshot.h
+ * @brief Versionierter Schnappschuss zwischen Tasks (Seqlock)
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Ein Task schreibt (publish), beliebig viele Tasks lesen (read).
+ * Der Schreiber wird nie blockiert: er setzt die Sequenznummer auf
+ * ungerade, kopiert die Daten und setzt sie wieder auf gerade. Leser
+ * kopieren ohne Sperre und wiederholen die Kopie, wenn sich die
+ * Sequenznummer währenddessen geändert hat - ein halb geschriebener
+ * Zustand (z.B. neue Spannung, alter status_text) kommt so nie an.
+ *
+ * Version = Anzahl Veröffentlichungen. changedSince() prüft nur die
+ * Sequenznummer, ohne die Daten zu kopieren.
+ *
+ * SPEICHERN ALS: src/core/seqlock_snapshot.h
+ */
+
+#ifndef SEQLOCK_SNAPSHOT_H
+#define SEQLOCK_SNAPSHOT_H
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+/**
+ * @brief Seqlock-geschützter Schnappschuss
+ * @tparam T Datentyp (trivial kopierbar, z.B. bms_data_t)
+ */
+template <typename T>
+class SeqlockSnapshot {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqlockSnapshot kopiert per memcpy");
+
+private:
+    std::atomic<uint32_t> m_sequence;   ///< Ungerade = Schreiben läuft
+    mutable std::atomic<uint32_t> m_retries;    ///< Wiederholte Lesevorgänge (Diagnose)
+    T m_data;
+
+public:
+    SeqlockSnapshot()
+        : m_sequence(0)
+        , m_retries(0)
+        , m_data()
+    {}
+
+    /**
+     * @brief Veröffentlicht einen neuen Stand (nur ein Schreiber-Task)
+     */
+    void publish(const T& data) {
+        uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy((void*)&m_data, (const void*)&data, sizeof(T));
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Liest einen konsistenten Stand
+     * @param data Ziel der Kopie
+     * @return Version des gelesenen Stands, 0 = noch nie veröffentlicht
+     */
+    uint32_t read(T& data) const {
+        for (;;) {
+            uint32_t before = m_sequence.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                memcpy((void*)&data, (const void*)&m_data, sizeof(T));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (m_sequence.load(std::memory_order_relaxed) == before) {
+                    return before / 2;
+                }
+            }
+            m_retries.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Aktuelle Version (ein laufendes Schreiben zählt noch nicht)
+     */
+    uint32_t getVersion() const {
+        return m_sequence.load(std::memory_order_acquire) / 2;
+    }
+
+    /**
+     * @brief Wurde seit der Version etwas veröffentlicht?
+     */
+    bool changedSince(uint32_t version) const {
+        return getVersion() != version;
+    }
+
+    uint32_t getReadRetries() const {
+        return m_retries.load(std::memory_order_relaxed);
+    }
+};
+
+#endif // SEQLOCK_SNAPSHOT_H
@@ -0,0 +1,71 @@
+/**
+ * @file sink.h
+ * @brief Allokationsfreier Callback (Funktionszeiger + Kontext)
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Ersatz für std::function auf Hot-Paths: kein Heap, keine Type-Erasure,
+ * ein einziger indirekter Aufruf. Gebunden wird zur Compile-Zeit an eine
+ * freie Funktion oder eine Member-Funktion:
+ *
+ *   Sink<const CanFrame&>::function<onFrame>()
+ *   Sink<const CanFrame&>::member<ProtocolManager, &ProtocolManager::handleFrame>(&mgr)
+ *
+ * SPEICHERN ALS: src/core/sink.h
+ */
+
+#ifndef SINK_H
+#define SINK_H
+
+/**
+ * @brief Funktionszeiger-plus-Kontext Callback
+ * @tparam Args Parametertypen des Callbacks
+ */
+template <typename... Args>
+class Sink {
+public:
+    using Handler = void (*)(void* context, Args... args);
+
+    constexpr Sink() : m_handler(nullptr), m_context(nullptr) {}
+    constexpr Sink(Handler handler, void* context) : m_handler(handler), m_context(context) {}
+
+    /**
+     * @brief Bindet eine freie Funktion
+     */
+    template <void (*Function)(Args...)>
+    static constexpr Sink function() {
+        return Sink(&callFunction<Function>, nullptr);
+    }
+
+    /**
+     * @brief Bindet eine Member-Funktion an ein Objekt
+     */
+    template <typename T, void (T::*Method)(Args...)>
+    static constexpr Sink member(T* object) {
+        return Sink(&callMember<T, Method>, object);
+    }
+
+    void operator()(Args... args) const {
+        m_handler(m_context, args...);
+    }
+
+    explicit operator bool() const {
+        return m_handler != nullptr;
+    }
+
+private:
+    Handler m_handler;
+    void* m_context;
+
+    template <void (*Function)(Args...)>
+    static void callFunction(void*, Args... args) {
+        Function(args...);
+    }
+
+    template <typename T, void (T::*Method)(Args...)>
+    static void callMember(void* context, Args... args) {
+        (static_cast<T*>(context)->*Method)(args...);
+    }
+};
+
+#endif // SINK_H
@@ -0,0 +1,203 @@
+/**
+ * @file spsc_ring.h
+ * @brief Lock-freier Single-Producer/Single-Consumer Ringpuffer
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Genau ein Task schreibt (push), genau ein Task liest (pop/front).
+ * Es werden keine Mutexe oder Critical Sections benötigt - Head und
+ * Tail werden über std::atomic mit Acquire/Release synchronisiert.
+ * Die Tiefe wird auf die nächste Zweierpotenz aufgerundet, damit der
+ * Index per Maske statt per Modulo berechnet werden kann.
+ *
+ * SPEICHERN ALS: src/core/spsc_ring.h
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <new>
+
+/**
+ * @brief Lock-freier SPSC-Ringpuffer mit Füllstands-Statistik
+ * @tparam T Elementtyp (trivial kopierbar)
+ */
+template <typename T>
+class SpscRing {
+private:
+    T* m_buffer;                        ///< Speicher für die Elemente
+    uint32_t m_capacity;                ///< Kapazität (Zweierpotenz)
+    uint32_t m_mask;                    ///< m_capacity - 1
+
+    std::atomic<uint32_t> m_head;       ///< Schreibindex (nur Producer)
+    std::atomic<uint32_t> m_tail;       ///< Leseindex (nur Consumer)
+
+    std::atomic<uint32_t> m_highWater;  ///< Maximaler Füllstand
+    std::atomic<uint32_t> m_overflows;  ///< Verworfene Elemente (Ring voll)
+
+    static uint32_t roundUpPow2(uint32_t value) {
+        uint32_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+public:
+    SpscRing()
+        : m_buffer(nullptr)
+        , m_capacity(0)
+        , m_mask(0)
+        , m_head(0)
+        , m_tail(0)
+        , m_highWater(0)
+        , m_overflows(0)
+    {}
+
+    ~SpscRing() {
+        release();
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief Reserviert den Puffer
+     * @param depth Gewünschte Tiefe (wird auf Zweierpotenz aufgerundet)
+     * @return true bei Erfolg
+     * @note Nur aufrufen wenn weder Producer noch Consumer aktiv sind
+     */
+    bool init(uint32_t depth) {
+        release();
+
+        if (depth < 2) {
+            depth = 2;
+        }
+
+        uint32_t capacity = roundUpPow2(depth);
+        m_buffer = new (std::nothrow) T[capacity];
+        if (!m_buffer) {
+            return false;
+        }
+
+        m_capacity = capacity;
+        m_mask = capacity - 1;
+        reset();
+        return true;
+    }
+
+    /**
+     * @brief Gibt den Puffer frei
+     */
+    void release() {
+        delete[] m_buffer;
+        m_buffer = nullptr;
+        m_capacity = 0;
+        m_mask = 0;
+    }
+
+    /**
+     * @brief Leert den Ring und setzt die Statistik zurück
+     * @note Nur aufrufen wenn weder Producer noch Consumer aktiv sind
+     */
+    void reset() {
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+        resetStats();
+    }
+
+    /**
+     * @brief Setzt High-Water-Mark und Overflow-Zähler zurück
+     */
+    void resetStats() {
+        m_highWater.store(0, std::memory_order_relaxed);
+        m_overflows.store(0, std::memory_order_relaxed);
+    }
+
+    // ========================================================================
+    // Producer-Seite
+    // ========================================================================
+
+    /**
+     * @brief Legt ein Element ab (nur vom Producer-Task aufrufen)
+     * @return false wenn der Ring voll ist (Element wird verworfen)
+     */
+    bool push(const T& item) {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        uint32_t tail = m_tail.load(std::memory_order_acquire);
+
+        if (!m_buffer || (head - tail) >= m_capacity) {
+            m_overflows.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        m_buffer[head & m_mask] = item;
+        m_head.store(head + 1, std::memory_order_release);
+
+        uint32_t fill = head + 1 - tail;
+        if (fill > m_highWater.load(std::memory_order_relaxed)) {
+            m_highWater.store(fill, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // ========================================================================
+    // Consumer-Seite
+    // ========================================================================
+
+    /**
+     * @brief Zeiger auf das älteste Element ohne es zu entnehmen
+     * @return nullptr wenn leer
+     * @note Der Zeiger bleibt bis zum nächsten popFront() gültig
+     */
+    const T* front() const {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        uint32_t head = m_head.load(std::memory_order_acquire);
+
+        if (head == tail) {
+            return nullptr;
+        }
+        return &m_buffer[tail & m_mask];
+    }
+
+    /**
+     * @brief Gibt das mit front() gelesene Element frei
+     */
+    void popFront() {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        m_tail.store(tail + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Entnimmt ein Element (nur vom Consumer-Task aufrufen)
+     * @return false wenn leer
+     */
+    bool pop(T& out) {
+        const T* item = front();
+        if (!item) {
+            return false;
+        }
+        out = *item;
+        popFront();
+        return true;
+    }
+
+    // ========================================================================
+    // Status
+    // ========================================================================
+
+    uint32_t size() const {
+        return m_head.load(std::memory_order_acquire) -
+               m_tail.load(std::memory_order_acquire);
+    }
+
+    bool isEmpty() const { return size() == 0; }
+    uint32_t capacity() const { return m_capacity; }
+    uint32_t highWater() const { return m_highWater.load(std::memory_order_relaxed); }
+    uint32_t overflows() const { return m_overflows.load(std::memory_order_relaxed); }
+};
+
+#endif // SPSC_RING_H
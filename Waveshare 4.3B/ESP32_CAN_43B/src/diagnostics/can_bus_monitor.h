@@ -0,0 +1,462 @@
+/**
+ * @file can_bus_monitor.h
+ * @brief Bus-Monitor: Raten pro ID, Buslast und Inter-Arrival-Jitter
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * recordFrame() wird im CAN RX-Task für jeden empfangenen Frame
+ * aufgerufen (einziger Schreiber). update() und die Abfragefunktionen
+ * laufen in loop(). Alle zwischen den Tasks geteilten Zähler sind
+ * std::atomic, es gibt keine Locks.
+ *
+ * Buslast: Für jeden Frame wird die exakte Bitlänge inklusive
+ * Stuff-Bits berechnet (SOF bis CRC, danach 13 ungestuffte Bits für
+ * CRC-Delimiter, ACK, EOF und Interframe Space). Bezogen auf die
+ * eingestellte Bitrate ergibt das die Buslast in Prozent.
+ *
+ * Jitter: Pro ID wird die mittlere Periode als gleitender Mittelwert
+ * geführt; die Abweichung jedes Abstands davon landet in einem
+ * logarithmischen Histogramm (<128 µs ... >=32 ms).
+ *
+ * SPEICHERN ALS: src/diagnostics/can_bus_monitor.h
+ */
+
+#ifndef CAN_BUS_MONITOR_H
+#define CAN_BUS_MONITOR_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "../core/can_types.h"
+
+/**
+ * @brief Statistik-Engine für den CAN-Bus
+ */
+class CanBusMonitor {
+public:
+    static constexpr size_t MAX_IDS = 64;           ///< Max. verfolgte IDs
+    static constexpr size_t JITTER_BUCKETS = 10;    ///< Histogramm-Buckets
+    static constexpr uint32_t JITTER_BASE_US = 128; ///< Obergrenze Bucket 0
+
+    /**
+     * @brief Momentaufnahme der Statistik einer ID
+     */
+    struct IdStats {
+        uint32_t id;                        ///< CAN-Identifier
+        bool extended;                      ///< 29-Bit Identifier
+        uint32_t frames;                    ///< Frames seit Reset
+        uint32_t rate;                      ///< Frames/s im letzten Fenster
+        uint32_t meanPeriodUs;              ///< Mittlere Periode
+        uint32_t minPeriodUs;               ///< Kleinster Abstand
+        uint32_t maxPeriodUs;               ///< Größter Abstand
+        uint32_t jitter[JITTER_BUCKETS];    ///< Histogramm |Abstand - Mittel|
+    };
+
+private:
+    static constexpr uint32_t KEY_EMPTY = 0xFFFFFFFF;
+
+    /**
+     * @brief Eintrag der ID-Tabelle
+     *
+     * Schreiber (RX-Task) nutzt die atomaren Felder; die Felder ohne
+     * Atomic gehören exklusiv dem Schreiber bzw. dem Leser (prevFrames).
+     */
+    struct Entry {
+        std::atomic<uint32_t> key;          ///< canKey(), KEY_EMPTY = frei
+        std::atomic<uint32_t> frames;
+        std::atomic<uint32_t> rate;
+        std::atomic<uint32_t> meanPeriodUs;
+        std::atomic<uint32_t> minPeriodUs;
+        std::atomic<uint32_t> maxPeriodUs;
+        std::atomic<uint32_t> jitter[JITTER_BUCKETS];
+        int64_t lastTimestampUs;            ///< Nur Schreiber
+        uint32_t prevFrames;                ///< Nur Leser (update)
+    };
+
+    Entry m_entries[MAX_IDS];
+    std::atomic<uint32_t> m_idCount;
+    std::atomic<uint32_t> m_totalFrames;
+    std::atomic<uint32_t> m_totalBits;
+    std::atomic<uint32_t> m_untrackedFrames;    ///< Tabelle voll
+    std::atomic<bool> m_resetRequested;
+
+    // Nur Leser (update)
+    uint32_t m_bitrate;
+    uint32_t m_lastUpdateMs;
+    uint32_t m_prevTotalFrames;
+    uint32_t m_prevTotalBits;
+    uint32_t m_frameRate;
+    float m_busLoad;
+    float m_peakBusLoad;
+    mutable IdStats m_report[MAX_IDS];  ///< Ausgabepuffer printStats(), ~4.6 KB nicht auf dem Stack
+
+    static uint32_t hashKey(uint32_t key) {
+        // Multiplikativer Hash (Knuth), MAX_IDS ist Zweierpotenz
+        return (key * 2654435761u) >> 26;
+    }
+
+    static_assert(MAX_IDS == 64, "hashKey() liefert 6 Bit");
+
+    /**
+     * @brief Sucht bzw. belegt den Tabelleneintrag (nur Schreiber)
+     */
+    Entry* lookup(uint32_t key) {
+        uint32_t index = hashKey(key);
+        for (size_t probe = 0; probe < MAX_IDS; probe++) {
+            Entry& entry = m_entries[(index + probe) & (MAX_IDS - 1)];
+            uint32_t current = entry.key.load(std::memory_order_relaxed);
+            if (current == key) {
+                return &entry;
+            }
+            if (current == KEY_EMPTY) {
+                entry.lastTimestampUs = 0;
+                entry.key.store(key, std::memory_order_release);
+                m_idCount.fetch_add(1, std::memory_order_relaxed);
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    void clearEntries() {
+        for (auto& entry : m_entries) {
+            entry.key.store(KEY_EMPTY, std::memory_order_relaxed);
+            entry.frames.store(0, std::memory_order_relaxed);
+            entry.rate.store(0, std::memory_order_relaxed);
+            entry.meanPeriodUs.store(0, std::memory_order_relaxed);
+            entry.minPeriodUs.store(UINT32_MAX, std::memory_order_relaxed);
+            entry.maxPeriodUs.store(0, std::memory_order_relaxed);
+            for (auto& bucket : entry.jitter) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+            entry.lastTimestampUs = 0;
+            entry.prevFrames = 0;
+        }
+        m_idCount.store(0, std::memory_order_relaxed);
+        m_totalFrames.store(0, std::memory_order_relaxed);
+        m_totalBits.store(0, std::memory_order_relaxed);
+        m_untrackedFrames.store(0, std::memory_order_relaxed);
+    }
+
+    static size_t jitterBucket(uint32_t deviationUs) {
+        size_t bucket = 0;
+        uint32_t limit = JITTER_BASE_US;
+        while (bucket < JITTER_BUCKETS - 1 && deviationUs >= limit) {
+            limit <<= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+    static uint32_t load(const std::atomic<uint32_t>& value) {
+        return value.load(std::memory_order_relaxed);
+    }
+
+public:
+    CanBusMonitor()
+        : m_idCount(0)
+        , m_totalFrames(0)
+        , m_totalBits(0)
+        , m_untrackedFrames(0)
+        , m_resetRequested(false)
+        , m_bitrate(500000)
+        , m_lastUpdateMs(0)
+        , m_prevTotalFrames(0)
+        , m_prevTotalBits(0)
+        , m_frameRate(0)
+        , m_busLoad(0.0f)
+        , m_peakBusLoad(0.0f)
+    {
+        clearEntries();
+    }
+
+    // ========================================================================
+    // Bit-Längen-Berechnung
+    // ========================================================================
+
+    /**
+     * @brief Berechnet die Bitlänge eines Frames auf dem Bus
+     *
+     * Baut den Bitstrom SOF..Daten auf, berechnet dabei die CRC-15 und
+     * zählt die Stuff-Bits (nach 5 gleichen Bits wird ein inverses
+     * eingefügt) bis einschließlich CRC.
+     *
+     * @return Anzahl Bits inkl. Stuff-Bits und Interframe Space
+     */
+    static uint32_t frameBits(const CanFrame& frame) {
+        uint32_t bits = 0;
+        uint32_t stuffBits = 0;
+        uint16_t crc = 0;
+        int lastBit = -1;
+        int runLength = 0;
+
+        auto emit = [&](int bit, bool crcBit) {
+            if (crcBit) {
+                int crcNext = bit ^ ((crc >> 14) & 1);
+                crc = (uint16_t)((crc << 1) & 0x7FFF);
+                if (crcNext) {
+                    crc ^= 0x4599;
+                }
+            }
+            bits++;
+            if (bit == lastBit) {
+                runLength++;
+            } else {
+                lastBit = bit;
+                runLength = 1;
+            }
+            if (runLength == 5) {
+                // Stuff-Bit mit inversem Pegel, zählt als neuer Lauf
+                stuffBits++;
+                lastBit = !bit;
+                runLength = 1;
+            }
+        };
+
+        auto emitField = [&](uint32_t value, int width) {
+            for (int i = width - 1; i >= 0; i--) {
+                emit((value >> i) & 1, true);
+            }
+        };
+
+        uint8_t dlc = frame.length > 8 ? 8 : frame.length;
+        int rtr = frame.isRtr() ? 1 : 0;
+
+        emit(0, true);                                  // SOF
+        if (frame.isExtended()) {
+            emitField((frame.id >> 18) & 0x7FF, 11);    // ID A
+            emit(1, true);                              // SRR
+            emit(1, true);                              // IDE
+            emitField(frame.id & 0x3FFFF, 18);          // ID B
+            emit(rtr, true);                            // RTR
+            emit(0, true);                              // r1
+            emit(0, true);                              // r0
+        } else {
+            emitField(frame.id & 0x7FF, 11);            // ID
+            emit(rtr, true);                            // RTR
+            emit(0, true);                              // IDE
+            emit(0, true);                              // r0
+        }
+        emitField(frame.length & 0x0F, 4);              // DLC
+        if (!rtr) {
+            for (uint8_t i = 0; i < dlc; i++) {
+                emitField(frame.data[i], 8);
+            }
+        }
+        uint16_t finalCrc = crc;
+        for (int i = 14; i >= 0; i--) {
+            emit((finalCrc >> i) & 1, false);           // CRC
+        }
+
+        // CRC-Delimiter, ACK-Slot, ACK-Delimiter, EOF (7), IFS (3)
+        return bits + stuffBits + 13;
+    }
+
+    // ========================================================================
+    // Schreiber (CAN RX-Task)
+    // ========================================================================
+
+    /**
+     * @brief Erfasst einen Frame (nur aus dem RX-Task aufrufen)
+     */
+    void recordFrame(const CanFrame& frame) {
+        if (m_resetRequested.exchange(false, std::memory_order_acquire)) {
+            clearEntries();
+        }
+
+        m_totalFrames.fetch_add(1, std::memory_order_relaxed);
+        m_totalBits.fetch_add(frameBits(frame), std::memory_order_relaxed);
+
+        uint32_t key = frame.key();
+
+        Entry* entry = lookup(key);
+        if (!entry) {
+            m_untrackedFrames.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        entry->frames.fetch_add(1, std::memory_order_relaxed);
+
+        if (entry->lastTimestampUs > 0) {
+            uint32_t period = (uint32_t)(frame.timestampUs - entry->lastTimestampUs);
+            uint32_t mean = load(entry->meanPeriodUs);
+
+            // Gleitender Mittelwert (1/8), erster Wert direkt übernommen
+            mean = (mean == 0) ? period : (uint32_t)(((uint64_t)mean * 7 + period) >> 3);
+            entry->meanPeriodUs.store(mean, std::memory_order_relaxed);
+
+            if (period < load(entry->minPeriodUs)) {
+                entry->minPeriodUs.store(period, std::memory_order_relaxed);
+            }
+            if (period > load(entry->maxPeriodUs)) {
+                entry->maxPeriodUs.store(period, std::memory_order_relaxed);
+            }
+
+            uint32_t deviation = (period > mean) ? (period - mean) : (mean - period);
+            entry->jitter[jitterBucket(deviation)].fetch_add(1, std::memory_order_relaxed);
+        }
+        entry->lastTimestampUs = frame.timestampUs;
+    }
+
+    // ========================================================================
+    // Leser (loop)
+    // ========================================================================
+
+    /**
+     * @brief Setzt die Bitrate für die Buslast-Berechnung
+     */
+    void setBitrate(uint32_t bitrate) {
+        m_bitrate = bitrate;
+    }
+
+    uint32_t getBitrate() const {
+        return m_bitrate;
+    }
+
+    /**
+     * @brief Berechnet Raten und Buslast (periodisch aus loop() aufrufen)
+     */
+    void update() {
+        uint32_t now = millis();
+        uint32_t elapsed = now - m_lastUpdateMs;
+        if (elapsed == 0) {
+            return;
+        }
+
+        uint32_t frames = load(m_totalFrames);
+        uint32_t bits = load(m_totalBits);
+
+        // Nach einem Reset sind die Zähler kleiner als die Vorwerte
+        uint32_t deltaFrames = (frames >= m_prevTotalFrames) ? frames - m_prevTotalFrames : frames;
+        uint32_t deltaBits = (bits >= m_prevTotalBits) ? bits - m_prevTotalBits : bits;
+
+        m_frameRate = (uint32_t)((uint64_t)deltaFrames * 1000 / elapsed);
+        m_busLoad = m_bitrate
+            ? (float)((double)deltaBits * 1000.0 / elapsed / m_bitrate * 100.0)
+            : 0.0f;
+        if (m_busLoad > m_peakBusLoad) {
+            m_peakBusLoad = m_busLoad;
+        }
+
+        for (auto& entry : m_entries) {
+            if (load(entry.key) == KEY_EMPTY) {
+                entry.prevFrames = 0;
+                continue;
+            }
+            uint32_t count = load(entry.frames);
+            uint32_t delta = (count >= entry.prevFrames) ? count - entry.prevFrames : count;
+            entry.rate.store((uint32_t)((uint64_t)delta * 1000 / elapsed), std::memory_order_relaxed);
+            entry.prevFrames = count;
+        }
+
+        m_prevTotalFrames = frames;
+        m_prevTotalBits = bits;
+        m_lastUpdateMs = now;
+    }
+
+    /**
+     * @brief Fordert einen Reset an (wird beim nächsten Frame ausgeführt)
+     */
+    void reset() {
+        m_resetRequested.store(true, std::memory_order_release);
+        m_peakBusLoad = 0.0f;
+    }
+
+    float getBusLoad() const { return m_busLoad; }
+    float getPeakBusLoad() const { return m_peakBusLoad; }
+    uint32_t getFrameRate() const { return m_frameRate; }
+    uint32_t getIdCount() const { return load(m_idCount); }
+    uint32_t getTotalFrames() const { return load(m_totalFrames); }
+    uint32_t getUntrackedFrames() const { return load(m_untrackedFrames); }
+
+    /**
+     * @brief Liefert die Statistik aller bekannten IDs
+     * @param out Ziel-Array
+     * @param maxCount Größe des Ziel-Arrays
+     * @return Anzahl gelieferter Einträge (nach Rate absteigend sortiert)
+     */
+    size_t getIdStats(IdStats* out, size_t maxCount) const {
+        size_t count = 0;
+        for (const auto& entry : m_entries) {
+            uint32_t key = entry.key.load(std::memory_order_acquire);
+            if (key == KEY_EMPTY) {
+                continue;
+            }
+
+            IdStats stats;
+            stats.id = key & ~CAN_KEY_EXTENDED;
+            stats.extended = (key & CAN_KEY_EXTENDED) != 0;
+            stats.frames = load(entry.frames);
+            stats.rate = load(entry.rate);
+            stats.meanPeriodUs = load(entry.meanPeriodUs);
+            stats.minPeriodUs = load(entry.minPeriodUs);
+            stats.maxPeriodUs = load(entry.maxPeriodUs);
+            if (stats.minPeriodUs == UINT32_MAX) {
+                stats.minPeriodUs = 0;
+            }
+            for (size_t b = 0; b < JITTER_BUCKETS; b++) {
+                stats.jitter[b] = load(entry.jitter[b]);
+            }
+
+            // Einfügen sortiert nach Rate (absteigend)
+            size_t pos = (count < maxCount) ? count : maxCount;
+            while (pos > 0 && out[pos - 1].rate < stats.rate) {
+                if (pos < maxCount) {
+                    out[pos] = out[pos - 1];
+                }
+                pos--;
+            }
+            if (pos < maxCount) {
+                out[pos] = stats;
+                if (count < maxCount) {
+                    count++;
+                }
+            }
+        }
+        return count;
+    }
+
+    /**
+     * @brief Kurzfassung für das CAN-Display
+     */
+    void formatSummary(char* buffer, size_t size) const {
+        IdStats top[3];
+        size_t n = getIdStats(top, 3);
+
+        int len = snprintf(buffer, size, "Bus load: %.1f%% (peak %.1f%%) | %lu frames/s | %lu IDs",
+                           m_busLoad, m_peakBusLoad, m_frameRate, getIdCount());
+        for (size_t i = 0; i < n && len > 0 && (size_t)len < size; i++) {
+            len += snprintf(buffer + len, size - len, "\n0x%0*lX: %lu/s, period %lu us (%lu..%lu)",
+                            top[i].extended ? 8 : 3, top[i].id, top[i].rate,
+                            top[i].meanPeriodUs, top[i].minPeriodUs, top[i].maxPeriodUs);
+        }
+    }
+
+    /**
+     * @brief Gibt Buslast und ID-Tabelle auf Serial aus
+     */
+    void printStats() const {
+        Serial.println("\n=== CAN Bus Monitor ===");
+        Serial.printf("Bitrate:    %lu bps\n", m_bitrate);
+        Serial.printf("Bus load:   %.1f %% (peak %.1f %%)\n", m_busLoad, m_peakBusLoad);
+        Serial.printf("Frames/s:   %lu (total %lu, untracked %lu)\n",
+                     m_frameRate, getTotalFrames(), getUntrackedFrames());
+        Serial.printf("IDs:        %lu\n", getIdCount());
+
+        size_t n = getIdStats(m_report, MAX_IDS);
+        if (n > 0) {
+            Serial.print("ID          Rate   Frames  Mean[us]   Min[us]   Max[us]  Jitter <128us..>=32ms\n");
+        }
+        for (size_t i = 0; i < n; i++) {
+            const IdStats& s = m_report[i];
+            Serial.printf("%s0x%0*lX %5lu %8lu %9lu %9lu %9lu  ",
+                         s.extended ? "" : "     ", s.extended ? 8 : 3, s.id,
+                         s.rate, s.frames, s.meanPeriodUs, s.minPeriodUs, s.maxPeriodUs);
+            for (size_t b = 0; b < JITTER_BUCKETS; b++) {
+                Serial.printf("%lu%s", s.jitter[b], (b + 1 < JITTER_BUCKETS) ? "/" : "\n");
+            }
+        }
+        Serial.println("=======================\n");
+    }
+};
+
+#endif // CAN_BUS_MONITOR_H
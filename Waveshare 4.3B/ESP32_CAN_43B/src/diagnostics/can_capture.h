@@ -0,0 +1,443 @@
+/**
+ * @file can_capture.h
+ * @brief Frame-Mitschnitt im PSRAM mit Trigger und candump-Export
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Zeichnet alle empfangenen Frames mit Zeitstempel in einem großen
+ * Ringpuffer im PSRAM auf (Standard: 160000 Frames, ca. 3,8 MB).
+ *
+ * Ablauf:
+ *   arm()     - Aufzeichnung starten, ältester Frame wird überschrieben
+ *   Trigger   - optional auf ID und/oder Nutzdaten-Muster; nach dem
+ *               Treffer werden noch postFrames aufgezeichnet, danach
+ *               stoppt der Mitschnitt selbst (DONE)
+ *   stop()    - Aufzeichnung manuell beenden
+ *   startExport() + serviceExport() - Ausgabe im candump-Logformat:
+ *               (1.234567) can0 123#DEADBEEF
+ *
+ * recordFrame() läuft im CAN RX-Task (einziger Schreiber, keine Locks).
+ * Alle anderen Funktionen laufen in loop(). Export nur wenn der
+ * Mitschnitt nicht aktiv ist.
+ *
+ * SPEICHERN ALS: src/diagnostics/can_capture.h
+ */
+
+#ifndef CAN_CAPTURE_H
+#define CAN_CAPTURE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "esp_heap_caps.h"
+#include "../core/can_types.h"
+
+/**
+ * @brief Trigger-Bedingung für den Mitschnitt
+ *
+ * Ein Frame löst aus, wenn (frame.id & idMask) == (id & idMask), der
+ * Frame-Typ passt und alle Datenbytes (data & dataMask) übereinstimmen.
+ * idMask = 0 und dataMask = 0 lösen auf jeden Frame aus.
+ */
+struct CanCaptureTrigger {
+    uint32_t id;                    ///< Identifier
+    uint32_t idMask;                ///< Relevante ID-Bits (1 = muss übereinstimmen)
+    bool matchExtended;             ///< Frame-Typ prüfen
+    bool extended;                  ///< Erwarteter Frame-Typ (wenn matchExtended)
+    uint8_t data[8];                ///< Nutzdaten-Muster
+    uint8_t dataMask[8];            ///< Relevante Datenbits
+
+    bool matches(const CanFrame& frame) const {
+        if ((frame.id & idMask) != (id & idMask)) {
+            return false;
+        }
+        if (matchExtended && frame.isExtended() != extended) {
+            return false;
+        }
+        for (uint8_t i = 0; i < 8; i++) {
+            if ((frame.data[i] & dataMask[i]) != (data[i] & dataMask[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief PSRAM-Ringpuffer für CAN-Mitschnitte
+ */
+class CanCapture {
+public:
+    static constexpr uint32_t DEFAULT_CAPACITY = 160000;    ///< Frames (ca. 3,8 MB)
+    static constexpr uint32_t MIN_CAPACITY = 4096;          ///< Untergrenze bei wenig PSRAM
+    static constexpr uint32_t EXPORT_LINES_PER_CALL = 64;   ///< Zeilen pro serviceExport()
+
+    /**
+     * @brief Zustand des Mitschnitts
+     */
+    enum State : uint8_t {
+        IDLE = 0,                   ///< Keine Aufzeichnung
+        ARMED,                      ///< Aufzeichnung läuft, Trigger noch nicht ausgelöst
+        TRIGGERED,                  ///< Trigger ausgelöst, Nachlauf wird aufgezeichnet
+        DONE                        ///< Nachlauf vollständig, Aufzeichnung beendet
+    };
+
+private:
+    CanFrame* m_buffer;                     ///< Puffer im PSRAM
+    uint32_t m_capacity;                    ///< Kapazität in Frames
+
+    std::atomic<uint8_t> m_state;           ///< State
+    std::atomic<uint32_t> m_written;        ///< Aufgezeichnete Frames seit arm()
+
+    // Konfiguration (nur in IDLE/DONE geändert)
+    CanCaptureTrigger m_trigger;
+    bool m_triggerEnabled;
+    uint32_t m_preFrames;                   ///< Frames vor dem Trigger
+    uint32_t m_postFrames;                  ///< Frames nach dem Trigger
+
+    // Nur Schreiber (RX-Task)
+    uint32_t m_triggerIndex;                ///< Index des auslösenden Frames
+    uint32_t m_postRemaining;               ///< Noch aufzuzeichnender Nachlauf
+
+    // Export (nur loop)
+    uint32_t m_exportPos;
+    uint32_t m_exportEnd;
+    bool m_exporting;
+
+    /**
+     * @brief Schreibt einen Frame im candump-Logformat
+     */
+    static void printFrame(const CanFrame& frame) {
+        // Worst case "(4294967295.999999) can0 1FFFFFFF#0011223344556677"
+        // = 50 Zeichen, jeder Schritt bleibt in sizeof(line) - pos
+        char line[64];
+        size_t pos = 0;
+        auto advance = [&](int written) {
+            if (written > 0) {
+                size_t room = sizeof(line) - 1 - pos;
+                pos += ((size_t)written < room) ? (size_t)written : room;
+            }
+        };
+        advance(snprintf(line, sizeof(line), "(%lu.%06lu) can0 ",
+                         (unsigned long)(frame.timestampUs / 1000000),
+                         (unsigned long)(frame.timestampUs % 1000000)));
+        advance(snprintf(line + pos, sizeof(line) - pos,
+                         frame.isExtended() ? "%08lX#" : "%03lX#",
+                         (unsigned long)frame.id));
+
+        if (frame.isRtr()) {
+            if (sizeof(line) - pos > 1) {
+                line[pos++] = 'R';
+            }
+        } else {
+            static const char hex[] = "0123456789ABCDEF";
+            uint8_t length = frame.length > 8 ? 8 : frame.length;
+            for (uint8_t i = 0; i < length && sizeof(line) - pos > 2; i++) {
+                line[pos++] = hex[frame.data[i] >> 4];
+                line[pos++] = hex[frame.data[i] & 0x0F];
+            }
+        }
+        line[pos] = '\0';
+        Serial.println(line);
+    }
+
+public:
+    CanCapture()
+        : m_buffer(nullptr)
+        , m_capacity(0)
+        , m_state(IDLE)
+        , m_written(0)
+        , m_trigger()
+        , m_triggerEnabled(false)
+        , m_preFrames(0)
+        , m_postFrames(0)
+        , m_triggerIndex(0)
+        , m_postRemaining(0)
+        , m_exportPos(0)
+        , m_exportEnd(0)
+        , m_exporting(false)
+    {}
+
+    ~CanCapture() {
+        heap_caps_free(m_buffer);
+    }
+
+    CanCapture(const CanCapture&) = delete;
+    CanCapture& operator=(const CanCapture&) = delete;
+
+    /**
+     * @brief Reserviert den Puffer im PSRAM
+     *
+     * Reicht der freie PSRAM nicht, wird die Kapazität halbiert bis
+     * MIN_CAPACITY erreicht ist.
+     *
+     * @param capacity Gewünschte Kapazität in Frames
+     * @return true bei Erfolg
+     */
+    bool begin(uint32_t capacity = DEFAULT_CAPACITY) {
+        if (m_buffer) {
+            return true;
+        }
+
+        while (capacity >= MIN_CAPACITY) {
+            m_buffer = static_cast<CanFrame*>(
+                heap_caps_malloc((size_t)capacity * sizeof(CanFrame),
+                                 MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+            if (m_buffer) {
+                m_capacity = capacity;
+                Serial.printf("[Capture] Buffer: %lu frames (%lu KB PSRAM)\n",
+                             m_capacity, (m_capacity * sizeof(CanFrame)) / 1024);
+                return true;
+            }
+            capacity /= 2;
+        }
+
+        Serial.println("[Capture] ERROR: PSRAM allocation failed");
+        return false;
+    }
+
+    // ========================================================================
+    // Konfiguration (loop)
+    // ========================================================================
+
+    /**
+     * @brief Setzt die Trigger-Bedingung
+     *
+     * Nur im Zustand IDLE oder DONE: recordFrame() liest Trigger und
+     * Nachlauf im RX-Task ohne Sperre.
+     *
+     * @param trigger Bedingung
+     * @param preFrames Frames vor dem Trigger, die erhalten bleiben
+     * @param postFrames Frames nach dem Trigger
+     * @return false wenn die Aufzeichnung noch läuft
+     */
+    bool setTrigger(const CanCaptureTrigger& trigger, uint32_t preFrames, uint32_t postFrames) {
+        if (isRecording()) {
+            Serial.println("[Capture] ERROR: Stop capture before changing the trigger");
+            return false;
+        }
+        m_trigger = trigger;
+        m_triggerEnabled = true;
+        m_preFrames = preFrames;
+        m_postFrames = postFrames;
+        return true;
+    }
+
+    /**
+     * @brief Entfernt den Trigger (Dauer-Mitschnitt bis stop())
+     * @return false wenn die Aufzeichnung noch läuft
+     */
+    bool clearTrigger() {
+        if (isRecording()) {
+            Serial.println("[Capture] ERROR: Stop capture before changing the trigger");
+            return false;
+        }
+        m_triggerEnabled = false;
+        return true;
+    }
+
+    /**
+     * @brief Startet die Aufzeichnung
+     * @return false wenn kein Puffer verfügbar ist
+     */
+    bool arm() {
+        if (!begin()) {
+            return false;
+        }
+
+        m_state.store(IDLE, std::memory_order_release);
+        m_exporting = false;
+
+        // Vor- und Nachlauf müssen zusammen in den Ring passen
+        if (m_postFrames >= m_capacity) {
+            m_postFrames = m_capacity - 1;
+        }
+        if (m_preFrames > m_capacity - 1 - m_postFrames) {
+            m_preFrames = m_capacity - 1 - m_postFrames;
+        }
+
+        m_triggerIndex = 0;
+        m_postRemaining = m_postFrames;
+        m_written.store(0, std::memory_order_relaxed);
+        m_state.store(ARMED, std::memory_order_release);
+
+        if (m_triggerEnabled) {
+            Serial.printf("[Capture] Armed: trigger id=0x%lX/0x%lX, pre=%lu, post=%lu\n",
+                         m_trigger.id, m_trigger.idMask, m_preFrames, m_postFrames);
+        } else {
+            Serial.println("[Capture] Armed: continuous");
+        }
+        return true;
+    }
+
+    /**
+     * @brief Beendet die Aufzeichnung, die Daten bleiben erhalten
+     */
+    void stop() {
+        uint8_t state = m_state.load(std::memory_order_acquire);
+        if (state == ARMED || state == TRIGGERED) {
+            m_state.store(IDLE, std::memory_order_release);
+            Serial.printf("[Capture] Stopped: %lu frames\n", getFrameCount());
+        }
+    }
+
+    // ========================================================================
+    // Aufzeichnung (RX-Task)
+    // ========================================================================
+
+    /**
+     * @brief Zeichnet einen Frame auf
+     * @note Nur vom CAN RX-Task aufrufen (z.B. über den RX-Tap)
+     */
+    void recordFrame(const CanFrame& frame) {
+        uint8_t state = m_state.load(std::memory_order_acquire);
+        if (state != ARMED && state != TRIGGERED) {
+            return;
+        }
+
+        uint32_t index = m_written.load(std::memory_order_relaxed);
+        m_buffer[index % m_capacity] = frame;
+        m_written.store(index + 1, std::memory_order_release);
+
+        if (state == ARMED) {
+            if (m_triggerEnabled && m_trigger.matches(frame)) {
+                m_triggerIndex = index;
+                if (m_postRemaining == 0) {
+                    m_state.store(DONE, std::memory_order_release);
+                } else {
+                    m_state.store(TRIGGERED, std::memory_order_release);
+                }
+            }
+        } else if (--m_postRemaining == 0) {
+            m_state.store(DONE, std::memory_order_release);
+        }
+    }
+
+    // ========================================================================
+    // Export (loop)
+    // ========================================================================
+
+    /**
+     * @brief Startet den candump-Export des aktuellen Mitschnitts
+     *
+     * Mit ausgelöstem Trigger: preFrames vor dem Trigger bis Ende des
+     * Nachlaufs. Sonst: die letzten min(Anzahl, Kapazität) Frames.
+     *
+     * @return false wenn die Aufzeichnung noch läuft oder leer ist
+     */
+    bool startExport() {
+        uint8_t state = m_state.load(std::memory_order_acquire);
+        if (state == ARMED || state == TRIGGERED) {
+            Serial.println("[Capture] ERROR: Stop capture before export");
+            return false;
+        }
+
+        uint32_t written = m_written.load(std::memory_order_acquire);
+        if (!m_buffer || written == 0) {
+            Serial.println("[Capture] Nothing captured");
+            return false;
+        }
+
+        uint32_t oldest = written > m_capacity ? written - m_capacity : 0;
+        m_exportEnd = written;
+
+        if (state == DONE) {
+            uint32_t pre = m_triggerIndex - oldest;
+            m_exportPos = m_triggerIndex - (pre < m_preFrames ? pre : m_preFrames);
+        } else {
+            m_exportPos = oldest;
+        }
+
+        m_exporting = true;
+        Serial.printf("[Capture] Exporting %lu frames (candump format)\n", m_exportEnd - m_exportPos);
+        return true;
+    }
+
+    /**
+     * @brief Gibt den nächsten Block des Exports aus
+     *
+     * Wird aus loop() aufgerufen, damit UI und Serial-Kommandos während
+     * eines langen Exports weiterlaufen.
+     *
+     * @return true solange der Export noch läuft
+     */
+    bool serviceExport() {
+        if (!m_exporting) {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < EXPORT_LINES_PER_CALL && m_exportPos != m_exportEnd; i++) {
+            printFrame(m_buffer[m_exportPos % m_capacity]);
+            m_exportPos++;
+        }
+
+        if (m_exportPos == m_exportEnd) {
+            m_exporting = false;
+            Serial.println("[Capture] Export done");
+        }
+        return m_exporting;
+    }
+
+    /**
+     * @brief Bricht einen laufenden Export ab
+     */
+    void cancelExport() {
+        m_exporting = false;
+    }
+
+    // ========================================================================
+    // Status
+    // ========================================================================
+
+    State getState() const {
+        return (State)m_state.load(std::memory_order_acquire);
+    }
+
+    static const char* getStateName(State state) {
+        switch (state) {
+            case IDLE:      return "IDLE";
+            case ARMED:     return "ARMED";
+            case TRIGGERED: return "TRIGGERED";
+            case DONE:      return "DONE";
+            default:        return "UNKNOWN";
+        }
+    }
+
+    /**
+     * @brief Anzahl der im Puffer vorhandenen Frames
+     */
+    uint32_t getFrameCount() const {
+        uint32_t written = m_written.load(std::memory_order_acquire);
+        return written < m_capacity ? written : m_capacity;
+    }
+
+    uint32_t getCapacity() const { return m_capacity; }
+    bool isExporting() const { return m_exporting; }
+
+    /**
+     * @brief true in ARMED und TRIGGERED (RX-Task schreibt in den Puffer)
+     */
+    bool isRecording() const {
+        uint8_t state = m_state.load(std::memory_order_acquire);
+        return state == ARMED || state == TRIGGERED;
+    }
+
+    /**
+     * @brief Gibt den Status auf Serial aus
+     */
+    void printStatus() const {
+        uint32_t written = m_written.load(std::memory_order_acquire);
+        Serial.println("\n=== CAN Capture ===");
+        Serial.printf("State:        %s\n", getStateName(getState()));
+        Serial.printf("Buffer:       %lu/%lu frames (%lu recorded)\n",
+                     getFrameCount(), m_capacity, written);
+        if (m_triggerEnabled) {
+            Serial.printf("Trigger:      id=0x%lX/0x%lX, pre=%lu, post=%lu\n",
+                         m_trigger.id, m_trigger.idMask, m_preFrames, m_postFrames);
+        } else {
+            Serial.println("Trigger:      none (continuous)");
+        }
+        Serial.println("===================\n");
+    }
+};
+
+#endif // CAN_CAPTURE_H
@@ -0,0 +1,117 @@
+/**
+ * @file can_bus.h
+ * @brief Plattformunabhängige CAN-Bus Schnittstelle
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * ICanBus trennt die CAN-Pipeline (ProtocolManager, Protokolle,
+ * Bus-Monitor, TX-Scheduler) von der Hardware. Auf dem ESP32 ist
+ * CanDriver (TWAI) die Implementierung, auf Linux SocketCanBus
+ * (host/socketcan_bus.h, z.B. vcan0).
+ *
+ * Empfangene Frames werden wie bisher über Sinks zugestellt, der
+ * Empfangspfad enthält damit keinen virtuellen Aufruf pro Frame.
+ *
+ * SPEICHERN ALS: src/hardware/can_bus.h
+ */
+
+#ifndef CAN_BUS_H
+#define CAN_BUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../core/can_types.h"
+#include "../core/sink.h"
+
+// ============================================================================
+// Callback-Typen
+// ============================================================================
+
+/**
+ * @brief Sink für empfangene CAN-Nachrichten
+ *
+ * Parameter: Frame inkl. RX-Zeitstempel und Flags (gültig bis Rückkehr).
+ * Funktionszeiger + Kontext statt std::function: keine Heap-Allokation,
+ * ein indirekter Aufruf pro Frame.
+ */
+using CanMessageSink = Sink<const CanFrame&>;
+
+/**
+ * @brief Periodischer Aufruf im Kontext des Message-Sinks
+ *
+ * Parameter: aktuelle Zeit in ms. Läuft im selben Task bzw. Thread wie
+ * der Message-Sink, auch wenn keine Frames kommen. Zeitgesteuerte
+ * Auswertung (Stille, Pack-Timeout) braucht so keine Sperren gegen das
+ * Parsing.
+ */
+using CanTickSink = Sink<uint32_t>;
+
+// ============================================================================
+// Datentypen
+// ============================================================================
+
+/**
+ * @brief Ergebnis von ICanBus::transmit()
+ */
+enum CanTxResult {
+    CAN_TX_OK = 0,                      ///< In die Sendequeue gestellt
+    CAN_TX_QUEUE_FULL,                  ///< Sendequeue voll, später erneut versuchen
+    CAN_TX_BUSY,                        ///< Vorübergehend nicht sendebereit (Recovery, Neustart)
+    CAN_TX_REJECTED,                    ///< Senden nicht möglich (Listen-Only, ungültiger Frame)
+    CAN_TX_ERROR                        ///< Treiberfehler (z.B. Bus-Off), Frame verworfen
+};
+
+// ============================================================================
+// Schnittstelle
+// ============================================================================
+
+/**
+ * @brief Abstrakter CAN-Bus
+ */
+class ICanBus {
+public:
+    static constexpr uint32_t TICK_INTERVAL_MS = 100;   ///< Abstand der Tick-Aufrufe
+
+    virtual ~ICanBus() = default;
+
+    /**
+     * @brief Name des Backends für Log-Ausgaben (z.B. "TWAI", "vcan0")
+     */
+    virtual const char* getName() const = 0;
+
+    virtual bool start() = 0;
+    virtual bool stop() = 0;
+    virtual bool isRunning() const = 0;
+
+    /**
+     * @brief Stellt einen Frame zum Senden ein (blockiert nie)
+     */
+    virtual CanTxResult transmit(const CanFrame& frame) = 0;
+
+    /**
+     * @brief Sink für empfangene Frames (Auswertung)
+     */
+    virtual void setMessageSink(CanMessageSink sink) = 0;
+
+    /**
+     * @brief Abgriff für jeden Frame direkt beim Empfang (schnell, nicht blockierend)
+     */
+    virtual void setRxTapSink(CanMessageSink sink) = 0;
+
+    /**
+     * @brief Tick im Auswerte-Kontext, etwa alle TICK_INTERVAL_MS
+     */
+    virtual void setTickSink(CanTickSink sink) = 0;
+
+    /**
+     * @brief Setzt Akzeptanzfilter (nullptr/0 = alles akzeptieren)
+     */
+    virtual bool setAcceptanceFilters(const CanIdFilter* filters, size_t count) = 0;
+
+    /**
+     * @brief Bitrate in bps (0 = unbekannt, z.B. virtueller Bus)
+     */
+    virtual uint32_t getBaudrate() const = 0;
+};
+
+#endif // CAN_BUS_H
@@ -6,6 +6,16 @@
  * 
  * Kapselt die ESP32 TWAI-Hardware und bietet eine einfache
  * Callback-basierte Schnittstelle für CAN-Kommunikation.
+ *
+ * Empfang und Auswertung laufen in getrennten Tasks: der RX-Task leert
+ * nur die TWAI-Hardware-Queue in einen lock-freien SPSC-Ring, der
+ * Decode-Task ruft daraus den Message-Sink auf. Ein blockierender
+ * Sink (z.B. UI-Update mit lvgl_port_lock) bremst so nicht mehr
+ * den Hardware-Empfang aus.
+ *
+ * Ein dritter Task wertet die TWAI-Alerts aus und führt nach Bus-Off
+ * die Recovery ohne Blockieren durch (twai_initiate_recovery, danach
+ * twai_start). RX- und Decode-Task laufen dabei einfach weiter.
  * 
  * SPEICHERN ALS: src/hardware/can_driver.h
  */
@@ -15,25 +25,80 @@
 
 #include <Arduino.h>
 #include "driver/twai.h"
-#include <functional>
+#include "esp_timer.h"
+#include <atomic>
+#include "../core/can_types.h"
+#include "../core/sink.h"
+#include "../core/spsc_ring.h"
+#include "can_bus.h"
+#include "can_filter.h"
 
 // ============================================================================
 // Callback-Typen
 // ============================================================================
 
 /**
- * @brief Callback für empfangene CAN-Nachrichten
- * @param canId CAN-Identifier
- * @param data Zeiger auf Daten-Array
- * @param length Länge der Daten
+ * @brief Sink für CAN-Fehler
+ * 
+ * Parameter: TWAI State (BUS_OFF, RECOVERING, RUNNING nach Recovery).
+ * Läuft im Alert-Task - darf nicht blockieren und den Treiber nicht
+ * umkonfigurieren.
  */
-using CanMessageCallback = std::function<void(uint32_t canId, const uint8_t* data, uint8_t length)>;
+using CanErrorSink = Sink<twai_state_t>;
+
+// ============================================================================
+// Datentypen
+// ============================================================================
 
 /**
- * @brief Callback für CAN-Fehler
- * @param state TWAI State
+ * @brief Zustand der Bus-Off Recovery
  */
-using CanErrorCallback = std::function<void(twai_state_t state)>;
+enum CanRecoveryState {
+    CAN_RECOVERY_IDLE = 0,              ///< Controller läuft (error-active/passive)
+    CAN_RECOVERY_BUS_OFF,               ///< Bus-Off erkannt, Recovery noch nicht gestartet
+    CAN_RECOVERY_RECOVERING,            ///< Warte auf 128 x 11 rezessive Bits
+    CAN_RECOVERY_RESTART                ///< Recovered, twai_start() ausstehend
+};
+
+/**
+ * @brief Erweiterte Treiber-Statistik
+ */
+struct CanDriverStats {
+    uint32_t rxCount;                   ///< Empfangene Nachrichten
+    uint32_t txCount;                   ///< In die Hardware-Queue gestellte Nachrichten
+    uint32_t txDone;                    ///< Erfolgreich gesendete Nachrichten
+    uint32_t txFailed;                  ///< Fehlgeschlagene Übertragungen
+    uint32_t txPending;                 ///< Noch in der Hardware-Queue
+    uint32_t errorCount;                ///< Anzahl Fehler
+    uint32_t ringDepth;                 ///< Tiefe des RX-Rings
+    uint32_t ringFill;                  ///< Aktueller Füllstand
+    uint32_t ringHighWater;             ///< Maximaler Füllstand
+    uint32_t ringOverflows;             ///< Verworfene Frames (Ring voll)
+    uint32_t framesPerSecond;           ///< Gemessene Empfangsrate
+    uint32_t burstCount;                ///< Anzahl RX-Bursts (Wakeups mit Frames)
+    uint32_t lastBurst;                 ///< Frames im letzten Burst
+    uint32_t maxBurst;                  ///< Größter Burst seit Reset
+    uint32_t busErrorCount;             ///< Bus-Fehler (Alert BUS_ERROR)
+    uint32_t errorPassiveCount;         ///< Wechsel nach Error-Passive
+    uint32_t busOffCount;               ///< Bus-Off Ereignisse
+    uint32_t recoveryCount;             ///< Erfolgreiche Recoveries
+    uint32_t lastRecoveryMs;            ///< Dauer der letzten Recovery (Bus-Off bis Start)
+    uint32_t maxRecoveryMs;             ///< Längste Recovery seit Reset
+    CanRecoveryState recoveryState;     ///< Aktueller Recovery-Zustand
+    bool filterActive;                  ///< Hardware-Filter aktiv (nicht Accept-All)
+    float filterAcceptance;             ///< Geschätzter akzeptierter ID-Raum (0..2)
+    uint32_t reconfigCount;             ///< Anzahl Neuinstallationen des Treibers
+    uint32_t lastReconfigMs;            ///< Downtime der letzten Neuinstallation
+};
+
+/**
+ * @brief Ergebnis eines Baudraten-Versuchs beim Auto-Baud
+ */
+struct CanBaudProbe {
+    uint32_t baudrate;                  ///< Getestete Baudrate
+    uint32_t frames;                    ///< Gültige Frames im Messfenster
+    uint32_t errors;                    ///< Bus-Fehler im Messfenster
+};
 
 // ============================================================================
 // CAN Driver Klasse
@@ -44,8 +109,9 @@ using CanErrorCallback = std::function<void(twai_state_t state)>;
  * 
  * Diese Klasse kapselt die ESP32 TWAI-Hardware und bietet eine
  * einfache, Callback-basierte Schnittstelle für CAN-Kommunikation.
+ * Portable Module verwenden sie über ICanBus.
  */
-class CanDriver {
+class CanDriver : public ICanBus {
 private:
     // ========================================================================
     // Member-Variablen
@@ -56,25 +122,372 @@ private:
     uint8_t m_txPin;                    ///< TX GPIO Pin
     uint8_t m_rxPin;                    ///< RX GPIO Pin
     uint32_t m_baudrate;                ///< Baudrate in bps
+    twai_mode_t m_mode;                 ///< Betriebsart (Normal/Listen-Only)
+    uint32_t m_rxRingDepth;             ///< Konfigurierte Tiefe des RX-Rings
+    CanFilterResult m_filter;           ///< Aktueller Hardware-Akzeptanzfilter
     
     // Callbacks
-    CanMessageCallback m_messageCallback;   ///< Callback für Nachrichten
-    CanErrorCallback m_errorCallback;       ///< Callback für Fehler
+    CanMessageSink m_messageSink;       ///< Sink für Nachrichten
+    CanErrorSink m_errorSink;           ///< Sink für Fehler
+    CanMessageSink m_rxTapSink;         ///< Abgriff im RX-Task (muss schnell sein)
+    CanTickSink m_tickSink;             ///< Periodisch im Decode-Task
     
-    // Task für Message-Reception
+    // Tasks für Empfang und Auswertung
     TaskHandle_t m_rxTask;              ///< Handle für RX-Task
+    TaskHandle_t m_decodeTask;          ///< Handle für Decode-Task
+    TaskHandle_t m_alertTask;           ///< Handle für Alert-Task (Recovery)
+    
+    // Entkopplung RX-Task -> Decode-Task
+    SpscRing<CanFrame> m_rxRing;         ///< Lock-freier Frame-Ring
+    
+    // Statistik (RX-Task, Sender und loop() greifen parallel zu)
+    std::atomic<uint32_t> m_rxCount;    ///< Empfangene Nachrichten
+    std::atomic<uint32_t> m_txCount;    ///< In die Hardware-Queue gestellte Nachrichten
+    uint32_t m_txFailedBase;            ///< TX-Fehler früherer Treiber-Installationen
+    std::atomic<uint32_t> m_errorCount; ///< Anzahl Fehler
+    
+    // Burst- und Raten-Statistik (nur vom RX-Task geschrieben)
+    uint32_t m_burstCount;              ///< Anzahl Bursts
+    uint32_t m_lastBurst;               ///< Größe des letzten Bursts
+    uint32_t m_maxBurst;                ///< Größter Burst
+    uint32_t m_framesPerSecond;         ///< Empfangsrate im letzten Messfenster
+    uint32_t m_rateWindowStart;         ///< Start des Messfensters (millis)
+    uint32_t m_rateWindowCount;         ///< m_rxCount zu Fensterbeginn
+    std::atomic<bool> m_rxStatsReset;   ///< resetStats() -> RX-Task
+    
+    // Bus-Off Recovery (nur vom Alert-Task geschrieben)
+    std::atomic<uint8_t> m_recoveryState;   ///< CanRecoveryState
+    uint32_t m_busErrorCount;           ///< Bus-Fehler
+    uint32_t m_errorPassiveCount;       ///< Wechsel nach Error-Passive
+    uint32_t m_busOffCount;             ///< Bus-Off Ereignisse
+    uint32_t m_recoveryCount;           ///< Erfolgreiche Recoveries
+    uint32_t m_lastRecoveryMs;          ///< Dauer letzte Recovery
+    uint32_t m_maxRecoveryMs;           ///< Längste Recovery
+    int64_t m_busOffSinceUs;            ///< Zeitpunkt des Bus-Off
+    std::atomic<bool> m_alertStatsReset;    ///< resetStats() -> Alert-Task
+    
+    // Laufende Tasks (für stop() ohne feste Wartezeit)
+    std::atomic<uint8_t> m_activeTasks; ///< Anzahl noch laufender Tasks
+    
+    // Neuinstallation
+    uint32_t m_reconfigCount;           ///< Anzahl Neuinstallationen
+    uint32_t m_lastReconfigMs;          ///< Downtime der letzten Neuinstallation
+    
+    static constexpr uint32_t RX_BURST_LIMIT = 64;          ///< Max. Frames pro Burst
+    static constexpr uint32_t RATE_WINDOW_MS = 1000;        ///< Messfenster für Frames/s
+    static constexpr uint32_t TASK_STOP_TIMEOUT_MS = 300;   ///< Max. Wartezeit in stop()
+    static constexpr uint32_t AUTOBAUD_MIN_FRAMES = 20;     ///< Frames für vorzeitigen Treffer
+    static constexpr uint32_t ALERT_MASK =
+        TWAI_ALERT_BUS_OFF | TWAI_ALERT_BUS_RECOVERED |
+        TWAI_ALERT_ERR_PASS | TWAI_ALERT_BUS_ERROR;          ///< Ausgewertete Alerts
+    
+    /**
+     * @brief Installiert den TWAI-Treiber mit der aktuellen Konfiguration
+     * @return true bei Erfolg
+     */
+    bool installDriver() {
+        return installDriver(m_filter.config);
+    }
+    
+    /**
+     * @brief Installiert den TWAI-Treiber mit abweichendem Filter
+     * @param filter Hardware-Filter für diese Installation
+     * @return true bei Erfolg
+     */
+    bool installDriver(const twai_filter_config_t& filter) {
+        // TWAI General Configuration
+        twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT(
+            (gpio_num_t)m_txPin, 
+            (gpio_num_t)m_rxPin, 
+            m_mode
+        );
+        g_config.rx_queue_len = 20;  // Größere Queue für mehr Nachrichten
+        g_config.tx_queue_len = 10;
+        g_config.alerts_enabled = ALERT_MASK;
+        
+        // TWAI Timing Configuration
+        twai_timing_config_t t_config;
+        if (!timingFor(m_baudrate, t_config)) {
+            Serial.printf("[CAN] ERROR: Invalid baudrate: %lu\n", m_baudrate);
+            return false;
+        }
+        
+        // Install TWAI driver
+        esp_err_t err = twai_driver_install(&g_config, &t_config, &filter);
+        if (err != ESP_OK) {
+            Serial.printf("[CAN] ERROR: Driver install failed: %d\n", err);
+            return false;
+        }
+        
+        return true;
+    }
     
-    // Statistik
-    uint32_t m_rxCount;                 ///< Empfangene Nachrichten
-    uint32_t m_txCount;                 ///< Gesendete Nachrichten
-    uint32_t m_errorCount;              ///< Anzahl Fehler
+    /**
+     * @brief Deinstalliert den Treiber und übernimmt dessen TX-Fehlerzähler
+     */
+    void uninstallDriver() {
+        twai_status_info_t status;
+        if (twai_get_status_info(&status) == ESP_OK) {
+            m_txFailedBase += status.tx_failed_count;
+        }
+        twai_driver_uninstall();
+    }
+    
+    /**
+     * @brief Liefert die TWAI-Timing-Konfiguration zu einer Baudrate
+     * @return false bei nicht unterstützter Baudrate
+     */
+    static bool timingFor(uint32_t baudrate, twai_timing_config_t& config) {
+        switch (baudrate) {
+            case 125000:  config = TWAI_TIMING_CONFIG_125KBITS(); return true;
+            case 250000:  config = TWAI_TIMING_CONFIG_250KBITS(); return true;
+            case 500000:  config = TWAI_TIMING_CONFIG_500KBITS(); return true;
+            case 1000000: config = TWAI_TIMING_CONFIG_1MBITS(); return true;
+            default:      return false;
+        }
+    }
+    
+    /**
+     * @brief Zählt gültige Frames und Bus-Fehler während eines Auto-Baud-Versuchs
+     * @note Nur bei gestoppten Tasks aufrufen (liest die Queue direkt)
+     */
+    void listen(CanBaudProbe& probe, uint32_t listenMs) {
+        twai_message_t message;
+        uint32_t begin = millis();
+        
+        while (millis() - begin < listenMs) {
+            if (twai_receive(&message, pdMS_TO_TICKS(10)) == ESP_OK) {
+                probe.frames++;
+                if (probe.frames >= AUTOBAUD_MIN_FRAMES) {
+                    break;
+                }
+            }
+        }
+        
+        twai_status_info_t status;
+        if (twai_get_status_info(&status) == ESP_OK) {
+            probe.errors = status.bus_error_count;
+        }
+    }
+    
+    static bool sameFilter(const CanFilterResult& a, const CanFilterResult& b) {
+        return a.config.acceptance_code == b.config.acceptance_code &&
+               a.config.acceptance_mask == b.config.acceptance_mask &&
+               a.config.single_filter == b.config.single_filter;
+    }
+    
+    void printFilter(size_t count) const {
+        if (m_filter.acceptAll) {
+            Serial.println("[CAN] Filter: accept all");
+        } else {
+            Serial.printf("[CAN] Filter: %s, code=0x%08lX, mask=0x%08lX (%lu IDs)\n",
+                         m_filter.config.single_filter ? "single" : "dual",
+                         (unsigned long)m_filter.config.acceptance_code,
+                         (unsigned long)m_filter.config.acceptance_mask,
+                         (unsigned long)count);
+        }
+    }
+    
+    /**
+     * @brief Übernimmt Baudrate, Betriebsart und optional den Filter mit
+     *        einer einzigen Neuinstallation
+     * @param filter Neuer Filter, nullptr = Filter unverändert
+     * @param filterCount Anzahl der Protokoll-Filter (nur Ausgabe)
+     */
+    bool applyConfig(uint32_t baudrate, twai_mode_t mode,
+                     const CanFilterResult* filter, size_t filterCount) {
+        twai_timing_config_t timing;
+        if (!timingFor(baudrate, timing)) {
+            Serial.printf("[CAN] ERROR: Invalid baudrate: %lu\n", baudrate);
+            return false;
+        }
+        
+        bool filterChanged = filter && !sameFilter(*filter, m_filter);
+        if (baudrate == m_baudrate && mode == m_mode && !filterChanged) {
+            return true;
+        }
+        
+        uint32_t oldBaudrate = m_baudrate;
+        twai_mode_t oldMode = m_mode;
+        CanFilterResult oldFilter = m_filter;
+        m_baudrate = baudrate;
+        m_mode = mode;
+        if (filterChanged) {
+            m_filter = *filter;
+            printFilter(filterCount);
+        }
+        
+        if (!m_initialized) {
+            return true;  // Wird bei init() übernommen
+        }
+        
+        Serial.printf("[CAN] Reconfiguring: %lu bps, %s\n", m_baudrate,
+                     m_mode == TWAI_MODE_LISTEN_ONLY ? "listen-only" : "normal");
+        
+        bool wasRunning = m_running;
+        if (reinstall()) {
+            return true;
+        }
+        
+        // Alte Konfiguration wiederherstellen
+        m_baudrate = oldBaudrate;
+        m_mode = oldMode;
+        m_filter = oldFilter;
+        if (!tasksStopped()) {
+            return false;  // Treiber unverändert installiert, nicht anfassen
+        }
+        uninstallDriver();
+        m_initialized = installDriver();
+        if (m_initialized && wasRunning && !m_running) {
+            start();
+        }
+        return false;
+    }
+    
+    /**
+     * @brief Installiert den Treiber neu und startet ihn bei Bedarf wieder
+     * 
+     * Gemeinsamer Pfad für Filter-, Baudraten- und Moduswechsel. Die
+     * Tasks werden beendet, der Treiber neu installiert und die Tasks
+     * wieder gestartet. Der RX-Ring bleibt reserviert und behält noch
+     * nicht ausgewertete Frames.
+     * 
+     * @return true bei Erfolg
+     */
+    bool reinstall() {
+        uint32_t begin = millis();
+        
+        bool wasRunning = m_running;
+        if (wasRunning) {
+            stop();
+        }
+        
+        // Laufen alte Tasks noch, hätte der Ring nach start() zwei
+        // Consumer: nichts deinstallieren, nichts neu starten
+        if (!tasksStopped()) {
+            Serial.println("[CAN] ERROR: Reinstall aborted, tasks still running");
+            return false;
+        }
+        
+        uninstallDriver();
+        m_initialized = installDriver();
+        if (!m_initialized) {
+            Serial.println("[CAN] ERROR: Driver reinstall failed");
+            return false;
+        }
+        
+        bool ok = wasRunning ? start() : true;
+        
+        m_reconfigCount++;
+        m_lastReconfigMs = millis() - begin;
+        Serial.printf("[CAN] Reinstalled in %lu ms\n", m_lastReconfigMs);
+        return ok;
+    }
+    
+    /**
+     * @brief Wartet bis alle Tasks nach m_running = false beendet sind
+     * 
+     * Statt einer festen Wartezeit wird nur so lange gewartet, bis der
+     * letzte Task sich abgemeldet hat (höchstens ein Receive-Timeout).
+     * @return false wenn nach TASK_STOP_TIMEOUT_MS noch Tasks laufen
+     */
+    bool waitForTasks() {
+        if (m_decodeTask) {
+            xTaskNotifyGive(m_decodeTask);  // Decode-Task sofort aufwecken
+        }
+        
+        uint32_t begin = millis();
+        while (!tasksStopped()) {
+            if (millis() - begin >= TASK_STOP_TIMEOUT_MS) {
+                Serial.println("[CAN] WARNING: Tasks did not stop in time");
+                return false;
+            }
+            vTaskDelay(1);
+        }
+        return true;
+    }
+    
+    bool tasksStopped() const {
+        return m_activeTasks.load(std::memory_order_acquire) == 0;
+    }
     
     // ========================================================================
     // Statische Task-Funktion
     // ========================================================================
     
+    /**
+     * @brief Übernimmt einen Frame aus der Hardware-Queue in den RX-Ring
+     * @return true wenn der Frame im Ring abgelegt wurde
+     */
+    bool enqueueFrame(const twai_message_t& message, int64_t timestampUs) {
+        CanFrame frame;
+        frame.timestampUs = timestampUs;
+        frame.id = message.identifier;
+        frame.length = message.data_length_code;
+        frame.flags = (message.extd ? CanFrame::FLAG_EXTENDED : 0) |
+                      (message.rtr ? CanFrame::FLAG_RTR : 0);
+        memcpy(frame.data, message.data, sizeof(frame.data));
+        
+        m_rxCount.fetch_add(1, std::memory_order_relaxed);
+        
+        // Abgriff im RX-Task (z.B. Bus-Monitor) - sieht auch Frames,
+        // die wegen vollem Ring verworfen werden
+        if (m_rxTapSink) {
+            m_rxTapSink(frame);
+        }
+        
+        // Bei vollem Ring wird der Frame verworfen und gezählt
+        return m_rxRing.push(frame);
+    }
+    
+    /**
+     * @brief Burst- und Raten-Statistik zurücksetzen (RX-Task bzw. gestoppt)
+     */
+    void clearRxStats() {
+        m_burstCount = 0;
+        m_lastBurst = 0;
+        m_maxBurst = 0;
+        m_rateWindowStart = millis();
+        m_rateWindowCount = m_rxCount.load(std::memory_order_relaxed);
+    }
+    
+    /**
+     * @brief Bus-Fehler- und Recovery-Statistik zurücksetzen (Alert-Task bzw. gestoppt)
+     */
+    void clearAlertStats() {
+        m_busErrorCount = 0;
+        m_errorPassiveCount = 0;
+        m_busOffCount = 0;
+        m_recoveryCount = 0;
+        m_lastRecoveryMs = 0;
+        m_maxRecoveryMs = 0;
+    }
+    
+    /**
+     * @brief Aktualisiert die Frames/s-Messung
+     */
+    void updateRate() {
+        uint32_t now = millis();
+        uint32_t elapsed = now - m_rateWindowStart;
+        
+        if (elapsed >= RATE_WINDOW_MS) {
+            uint32_t count = m_rxCount.load(std::memory_order_relaxed);
+            m_framesPerSecond = (uint32_t)(((uint64_t)(count - m_rateWindowCount) * 1000) / elapsed);
+            m_rateWindowStart = now;
+            m_rateWindowCount = count;
+        }
+    }
+    
     /**
      * @brief Task-Funktion für CAN-Empfang
+     * 
+     * Liest nur die Hardware-Queue aus und legt die Frames im RX-Ring ab.
+     * Kein Parsing, kein UI - der Task darf nie auf andere Module warten.
+     * 
+     * Burst-Drain: Nach jedem Wakeup werden alle anstehenden Frames ohne
+     * Wartezeit abgeholt, danach wird der Decode-Task einmal benachrichtigt.
+     * Blockiert wird nur, wenn die Hardware-Queue leer ist.
+     * 
      * @param parameter Zeiger auf CanDriver-Instanz
      */
     static void rxTaskFunction(void* parameter) {
@@ -83,44 +496,221 @@ private:
         
         Serial.println("[CAN Task] Started");
         
+        driver->m_rateWindowStart = millis();
+        driver->m_rateWindowCount = driver->m_rxCount.load(std::memory_order_relaxed);
+        
         while (driver->m_running) {
             // Warte auf Nachricht (mit Timeout)
             esp_err_t err = twai_receive(&message, pdMS_TO_TICKS(100));
             
             if (err == ESP_OK) {
-                driver->m_rxCount++;
+                // Alle weiteren anstehenden Frames ohne Warten abholen
+                uint32_t burst = 0;
+                bool queued = false;
+                do {
+                    queued |= driver->enqueueFrame(message, esp_timer_get_time());
+                    burst++;
+                } while (burst < RX_BURST_LIMIT && twai_receive(&message, 0) == ESP_OK);
                 
-                // Callback aufrufen
-                if (driver->m_messageCallback) {
-                    driver->m_messageCallback(
-                        message.identifier,
-                        message.data,
-                        message.data_length_code
-                    );
+                if (queued) {
+                    xTaskNotifyGive(driver->m_decodeTask);
                 }
-            } else if (err == ESP_ERR_TIMEOUT) {
-                // Timeout ist normal, einfach weiter warten
-                continue;
-            } else {
-                driver->m_errorCount++;
                 
-                // Error Callback
-                if (driver->m_errorCallback) {
-                    twai_status_info_t status;
-                    twai_get_status_info(&status);
-                    driver->m_errorCallback(status.state);
+                driver->m_burstCount++;
+                driver->m_lastBurst = burst;
+                if (burst > driver->m_maxBurst) {
+                    driver->m_maxBurst = burst;
                 }
+                
+                // Burst-Limit erreicht: kurz abgeben, damit der Idle-Task
+                // (Watchdog) bei Dauerlast nicht verhungert
+                if (burst >= RX_BURST_LIMIT) {
+                    vTaskDelay(1);
+                }
+            } else if (err != ESP_ERR_TIMEOUT) {
+                // Bus-Zustand wird vom Alert-Task behandelt, hier nur zählen
+                driver->m_errorCount.fetch_add(1, std::memory_order_relaxed);
+                
+                // Pause, damit ein dauerhafter Fehler nicht den Task blockiert
+                vTaskDelay(pdMS_TO_TICKS(1));
             }
             
-            // Kleine Pause um Watchdog zu füttern
-            vTaskDelay(pdMS_TO_TICKS(1));
+            if (driver->m_rxStatsReset.load(std::memory_order_relaxed) &&
+                driver->m_rxStatsReset.exchange(false, std::memory_order_acquire)) {
+                driver->clearRxStats();
+            }
+            driver->updateRate();
         }
         
         Serial.println("[CAN Task] Stopped");
+        driver->m_activeTasks.fetch_sub(1, std::memory_order_release);
+        vTaskDelete(nullptr);
+    }
+    
+    // ========================================================================
+    // Bus-Off Recovery
+    // ========================================================================
+    
+    void setRecoveryState(CanRecoveryState state) {
+        m_recoveryState.store((uint8_t)state, std::memory_order_release);
+    }
+    
+    CanRecoveryState recoveryState() const {
+        return (CanRecoveryState)m_recoveryState.load(std::memory_order_acquire);
+    }
+    
+    void notifyError(twai_state_t state) {
+        if (m_errorSink) {
+            m_errorSink(state);
+        }
+    }
+    
+    /**
+     * @brief Verarbeitet gelesene TWAI-Alerts
+     */
+    void handleAlerts(uint32_t alerts) {
+        if (alerts & TWAI_ALERT_BUS_ERROR) {
+            m_busErrorCount++;
+        }
+        
+        if (alerts & TWAI_ALERT_ERR_PASS) {
+            m_errorPassiveCount++;
+            Serial.println("[CAN] Error-passive");
+        }
+        
+        if (alerts & TWAI_ALERT_BUS_OFF) {
+            m_busOffCount++;
+            m_busOffSinceUs = esp_timer_get_time();
+            m_errorCount.fetch_add(1, std::memory_order_relaxed);
+            setRecoveryState(CAN_RECOVERY_BUS_OFF);
+            Serial.println("[CAN] Bus-Off detected");
+            notifyError(TWAI_STATE_BUS_OFF);
+        }
+        
+        if (alerts & TWAI_ALERT_BUS_RECOVERED) {
+            // Controller ist jetzt im Zustand STOPPED
+            setRecoveryState(CAN_RECOVERY_RESTART);
+        }
+    }
+    
+    /**
+     * @brief Führt den nächsten Recovery-Schritt aus
+     * 
+     * Schlägt ein Schritt fehl, bleibt der Zustand erhalten und der
+     * Schritt wird beim nächsten Durchlauf des Alert-Tasks wiederholt.
+     */
+    void advanceRecovery() {
+        switch (recoveryState()) {
+            case CAN_RECOVERY_BUS_OFF:
+                if (twai_initiate_recovery() == ESP_OK) {
+                    setRecoveryState(CAN_RECOVERY_RECOVERING);
+                    Serial.println("[CAN] Recovery initiated");
+                    notifyError(TWAI_STATE_RECOVERING);
+                }
+                break;
+                
+            case CAN_RECOVERY_RESTART:
+                if (twai_start() == ESP_OK) {
+                    uint32_t duration = (uint32_t)((esp_timer_get_time() - m_busOffSinceUs) / 1000);
+                    m_recoveryCount++;
+                    m_lastRecoveryMs = duration;
+                    if (duration > m_maxRecoveryMs) {
+                        m_maxRecoveryMs = duration;
+                    }
+                    setRecoveryState(CAN_RECOVERY_IDLE);
+                    Serial.printf("[CAN] Recovered in %lu ms (#%lu)\n", duration, m_recoveryCount);
+                    notifyError(TWAI_STATE_RUNNING);
+                }
+                break;
+                
+            default:
+                break;
+        }
+    }
+    
+    /**
+     * @brief Task-Funktion für TWAI-Alerts und Bus-Off Recovery
+     * 
+     * Ersetzt das frühere stop()/start() aus dem Error-Callback: der
+     * Controller wird nur über twai_initiate_recovery() und twai_start()
+     * wieder in Betrieb genommen, die übrigen Tasks bleiben bestehen.
+     * 
+     * @param parameter Zeiger auf CanDriver-Instanz
+     */
+    static void alertTaskFunction(void* parameter) {
+        CanDriver* driver = static_cast<CanDriver*>(parameter);
+        
+        Serial.println("[CAN Alert] Started");
+        
+        while (driver->m_running) {
+            uint32_t alerts = 0;
+            if (twai_read_alerts(&alerts, pdMS_TO_TICKS(100)) == ESP_OK) {
+                driver->handleAlerts(alerts);
+            }
+            if (driver->m_alertStatsReset.load(std::memory_order_relaxed) &&
+                driver->m_alertStatsReset.exchange(false, std::memory_order_acquire)) {
+                driver->clearAlertStats();
+            }
+            driver->advanceRecovery();
+        }
+        
+        Serial.println("[CAN Alert] Stopped");
+        driver->m_activeTasks.fetch_sub(1, std::memory_order_release);
+        vTaskDelete(nullptr);
+    }
+    
+    /**
+     * @brief Reicht alle Frames im Ring an den Message-Sink (nur Decode-Task)
+     */
+    void drainRing() {
+        // Frames direkt aus dem Ring-Slot weiterreichen (keine Kopie)
+        const CanFrame* frame;
+        while ((frame = m_rxRing.front()) != nullptr) {
+            if (m_messageSink) {
+                m_messageSink(*frame);
+            }
+            m_rxRing.popFront();
+        }
+    }
+    
+    /**
+     * @brief Task-Funktion für die Auswertung
+     * 
+     * Wartet auf Benachrichtigung durch den RX-Task und arbeitet dann
+     * alle Frames im Ring ab. Der Message-Sink (Parsing + UI) und der
+     * Tick-Sink (zeitgesteuerte Auswertung) laufen ausschließlich hier.
+     * Vor dem Beenden wird der Ring noch einmal geleert, damit stop()
+     * (z.B. bei einer Neuinstallation) keine empfangenen Frames verliert.
+     * 
+     * @param parameter Zeiger auf CanDriver-Instanz
+     */
+    static void decodeTaskFunction(void* parameter) {
+        CanDriver* driver = static_cast<CanDriver*>(parameter);
+        uint32_t lastTick = millis();
+        
+        Serial.println("[CAN Decode] Started");
+        
+        while (driver->m_running) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(TICK_INTERVAL_MS));
+            driver->drainRing();
+            
+            uint32_t now = millis();
+            if (driver->m_tickSink && now - lastTick >= TICK_INTERVAL_MS) {
+                lastTick = now;
+                driver->m_tickSink(now);
+            }
+        }
+        driver->drainRing();
+        
+        Serial.println("[CAN Decode] Stopped");
+        driver->m_activeTasks.fetch_sub(1, std::memory_order_release);
         vTaskDelete(nullptr);
     }
 
 public:
+    static constexpr uint32_t DEFAULT_RX_RING_DEPTH = 256;  ///< Standard-Tiefe RX-Ring
+    static constexpr uint32_t AUTOBAUD_LISTEN_MS = 300;     ///< Messfenster pro Baudrate
+    
     // ========================================================================
     // Konstruktor und Destruktor
     // ========================================================================
@@ -134,12 +724,39 @@ public:
         , m_txPin(0)
         , m_rxPin(0)
         , m_baudrate(0)
-        , m_messageCallback(nullptr)
-        , m_errorCallback(nullptr)
+        , m_mode(TWAI_MODE_NORMAL)
+        , m_rxRingDepth(DEFAULT_RX_RING_DEPTH)
+        , m_filter(CanFilterCalculator::calculate(nullptr, 0))
+        , m_messageSink()
+        , m_errorSink()
+        , m_rxTapSink()
+        , m_tickSink()
         , m_rxTask(nullptr)
+        , m_decodeTask(nullptr)
+        , m_alertTask(nullptr)
         , m_rxCount(0)
         , m_txCount(0)
+        , m_txFailedBase(0)
         , m_errorCount(0)
+        , m_burstCount(0)
+        , m_lastBurst(0)
+        , m_maxBurst(0)
+        , m_framesPerSecond(0)
+        , m_rateWindowStart(0)
+        , m_rateWindowCount(0)
+        , m_rxStatsReset(false)
+        , m_recoveryState(CAN_RECOVERY_IDLE)
+        , m_busErrorCount(0)
+        , m_errorPassiveCount(0)
+        , m_busOffCount(0)
+        , m_recoveryCount(0)
+        , m_lastRecoveryMs(0)
+        , m_maxRecoveryMs(0)
+        , m_busOffSinceUs(0)
+        , m_alertStatsReset(false)
+        , m_activeTasks(0)
+        , m_reconfigCount(0)
+        , m_lastReconfigMs(0)
     {
         Serial.println("[CAN] Driver created");
     }
@@ -147,7 +764,7 @@ public:
     /**
      * @brief Destruktor
      */
-    ~CanDriver() {
+    ~CanDriver() override {
         deinit();
     }
     
@@ -172,37 +789,16 @@ public:
         m_rxPin = rxPin;
         m_baudrate = baudrate;
         
-        Serial.printf("[CAN] Initializing on TX=%d, RX=%d @ %lu bps...\n", 
-                     m_txPin, m_rxPin, m_baudrate);
-        
-        // TWAI General Configuration
-        twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT(
-            (gpio_num_t)m_txPin, 
-            (gpio_num_t)m_rxPin, 
-            TWAI_MODE_NORMAL
-        );
-        g_config.rx_queue_len = 20;  // Größere Queue für mehr Nachrichten
-        g_config.tx_queue_len = 10;
-        
-        // TWAI Timing Configuration
-        twai_timing_config_t t_config;
-        switch (baudrate) {
-            case 125000:  t_config = TWAI_TIMING_CONFIG_125KBITS(); break;
-            case 250000:  t_config = TWAI_TIMING_CONFIG_250KBITS(); break;
-            case 500000:  t_config = TWAI_TIMING_CONFIG_500KBITS(); break;
-            case 1000000: t_config = TWAI_TIMING_CONFIG_1MBITS(); break;
-            default:
-                Serial.printf("[CAN] ERROR: Invalid baudrate: %lu\n", baudrate);
-                return false;
+        if (!m_rxRing.init(m_rxRingDepth)) {
+            Serial.println("[CAN] ERROR: RX ring allocation failed");
+            return false;
         }
         
-        // TWAI Filter Configuration (accept all messages)
-        twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+        Serial.printf("[CAN] Initializing on TX=%d, RX=%d @ %lu bps...\n", 
+                     m_txPin, m_rxPin, m_baudrate);
         
-        // Install TWAI driver
-        esp_err_t err = twai_driver_install(&g_config, &t_config, &f_config);
-        if (err != ESP_OK) {
-            Serial.printf("[CAN] ERROR: Driver install failed: %d\n", err);
+        if (!installDriver()) {
+            m_rxRing.release();
             return false;
         }
         
@@ -213,15 +809,20 @@ public:
     
     /**
      * @brief Deinitialisiert CAN-Hardware
-     * @return true bei Erfolg
+     * @return true bei Erfolg, false wenn die Tasks noch laufen
      */
     bool deinit() {
         if (m_running) {
             stop();
         }
+        if (!tasksStopped()) {
+            Serial.println("[CAN] ERROR: Deinit aborted, tasks still running");
+            return false;
+        }
         
         if (m_initialized) {
-            twai_driver_uninstall();
+            uninstallDriver();
+            m_rxRing.release();
             m_initialized = false;
             Serial.println("[CAN] Deinitialized");
         }
@@ -237,11 +838,15 @@ public:
      * @brief Startet CAN-Kommunikation
      * @return true bei Erfolg
      */
-    bool start() {
+    bool start() override {
         if (!m_initialized || m_running) {
             Serial.println("[CAN] ERROR: Not initialized or already running");
             return false;
         }
+        if (!tasksStopped()) {
+            Serial.println("[CAN] ERROR: Previous tasks still running");
+            return false;
+        }
         
         // TWAI starten
         esp_err_t err = twai_start();
@@ -250,8 +855,37 @@ public:
             return false;
         }
         
-        // RX-Task erstellen
+        // Kein m_rxRing.reset(): der Ring wird nur in init() angelegt, bei
+        // einer Neuinstallation noch liegende Frames werden weiter ausgewertet
+        setRecoveryState(CAN_RECOVERY_IDLE);
+        
+        // Flag vor Task-Start setzen, sonst beenden sich die Tasks sofort
+        m_running = true;
+        
+        // Decode-Task zuerst erstellen, der RX-Task benachrichtigt ihn.
+        // Zähler vor dem Erstellen erhöhen, der Task zählt beim Beenden herunter.
+        m_activeTasks.fetch_add(1, std::memory_order_relaxed);
         BaseType_t result = xTaskCreate(
+            decodeTaskFunction,
+            "can_decode_task",
+            4096,           // Stack size (Parsing + UI-Update)
+            this,           // Parameter (this pointer)
+            4,              // Priority (unter RX-Task)
+            &m_decodeTask
+        );
+        
+        if (result != pdPASS) {
+            Serial.println("[CAN] ERROR: Failed to create decode task");
+            m_activeTasks.fetch_sub(1, std::memory_order_relaxed);
+            m_running = false;
+            m_decodeTask = nullptr;
+            twai_stop();
+            return false;
+        }
+        
+        // RX-Task erstellen
+        m_activeTasks.fetch_add(1, std::memory_order_relaxed);
+        result = xTaskCreate(
             rxTaskFunction,
             "can_rx_task",
             4096,           // Stack size
@@ -262,38 +896,71 @@ public:
         
         if (result != pdPASS) {
             Serial.println("[CAN] ERROR: Failed to create RX task");
+            m_activeTasks.fetch_sub(1, std::memory_order_relaxed);
+            m_running = false;  // Decode-Task beendet sich selbst
+            m_rxTask = nullptr;
+            waitForTasks();
+            m_decodeTask = nullptr;
+            twai_stop();
+            return false;
+        }
+        
+        // Alert-Task erstellen (höchste Priorität, läuft nur bei Alerts)
+        m_activeTasks.fetch_add(1, std::memory_order_relaxed);
+        result = xTaskCreate(
+            alertTaskFunction,
+            "can_alert_task",
+            3072,           // Stack size
+            this,           // Parameter (this pointer)
+            6,              // Priority (über RX-Task)
+            &m_alertTask
+        );
+        
+        if (result != pdPASS) {
+            Serial.println("[CAN] ERROR: Failed to create alert task");
+            m_activeTasks.fetch_sub(1, std::memory_order_relaxed);
+            m_running = false;  // RX- und Decode-Task beenden sich selbst
+            m_alertTask = nullptr;
+            waitForTasks();
+            m_rxTask = nullptr;
+            m_decodeTask = nullptr;
             twai_stop();
             return false;
         }
         
-        m_running = true;
         Serial.println("[CAN] Started successfully");
         return true;
     }
     
     /**
      * @brief Stoppt CAN-Kommunikation
-     * @return true bei Erfolg
+     * @return true bei Erfolg, false wenn nicht gestartet oder die Tasks
+     *         nicht rechtzeitig beendet wurden (start() und Neuinstallation
+     *         werden dann verweigert, bis sie sich abgemeldet haben)
      */
-    bool stop() {
+    bool stop() override {
         if (!m_running) {
             return false;
         }
         
         Serial.println("[CAN] Stopping...");
         
-        // Task beenden
-        m_running = false;  // Flag setzen damit Task sich beendet
-        if (m_rxTask) {
-            vTaskDelay(pdMS_TO_TICKS(200));  // Task Zeit zum Beenden geben
+        // Tasks beenden
+        m_running = false;  // Flag setzen damit Tasks sich beenden
+        bool stopped = true;
+        if (m_rxTask || m_decodeTask || m_alertTask) {
+            stopped = waitForTasks();
             m_rxTask = nullptr;
+            m_decodeTask = nullptr;
+            m_alertTask = nullptr;
         }
         
-        // TWAI stoppen
+        // TWAI stoppen (schlägt im Bus-Off fehl, Deinstallation ist dort erlaubt)
         twai_stop();
+        setRecoveryState(CAN_RECOVERY_IDLE);
         
-        Serial.println("[CAN] Stopped");
-        return true;
+        Serial.println(stopped ? "[CAN] Stopped" : "[CAN] Stopped, tasks still exiting");
+        return stopped;
     }
     
     // ========================================================================
@@ -301,31 +968,88 @@ public:
     // ========================================================================
     
     /**
-     * @brief Sendet eine CAN-Nachricht
+     * @brief Stellt einen Frame in die Hardware-Sendequeue (blockiert nie)
+     * 
+     * Ob der Frame tatsächlich gesendet wurde, zeigen txDone/txFailed in
+     * CanDriverStats. Für priorisiertes und periodisches Senden siehe
+     * CanTxScheduler.
+     * 
+     * @param frame Zu sendender Frame (Flags bestimmen 11/29 Bit und RTR)
+     * @return CAN_TX_OK wenn eingereiht, CAN_TX_QUEUE_FULL wenn die
+     *         Hardware-Queue voll ist, CAN_TX_BUSY während Recovery oder
+     *         Neuinstallation, CAN_TX_REJECTED im Listen-Only Modus bzw.
+     *         bei ungültigem Frame, CAN_TX_ERROR bei sonstigen
+     *         Treiberfehlern (z.B. Bus-Off, bevor der Alert verarbeitet ist)
+     */
+    CanTxResult transmit(const CanFrame& frame) override {
+        if (m_mode == TWAI_MODE_LISTEN_ONLY || frame.length > 8) {
+            return CAN_TX_REJECTED;
+        }
+        if (!m_running || isRecovering()) {
+            return CAN_TX_BUSY;
+        }
+        
+        twai_message_t message = {};
+        message.identifier = frame.id;
+        message.data_length_code = frame.length;
+        message.extd = frame.isExtended() ? 1 : 0;
+        message.rtr = frame.isRtr() ? 1 : 0;
+        memcpy(message.data, frame.data, frame.length);
+        
+        esp_err_t err = twai_transmit(&message, 0);
+        if (err == ESP_OK) {
+            m_txCount.fetch_add(1, std::memory_order_relaxed);
+            return CAN_TX_OK;
+        }
+        if (err == ESP_ERR_TIMEOUT || err == ESP_FAIL) {
+            return CAN_TX_QUEUE_FULL;   // Queue voll bzw. ohne Queue gerade belegt
+        }
+        
+        m_errorCount.fetch_add(1, std::memory_order_relaxed);
+        if (err == ESP_ERR_INVALID_ARG || err == ESP_ERR_NOT_SUPPORTED) {
+            return CAN_TX_REJECTED;
+        }
+        // ESP_ERR_INVALID_STATE u.a.: kein Wiederholen, sonst hängt der
+        // Scheduler bis zur Recovery am selben Frame
+        return CAN_TX_ERROR;
+    }
+    
+    /**
+     * @brief Sendet eine CAN-Nachricht (blockiert nie)
      * @param canId CAN-Identifier
+     * @param extended true = 29-Bit Identifier (unabhängig vom Zahlenwert)
      * @param data Daten-Array
      * @param length Länge der Daten (max 8)
-     * @return true bei Erfolg
+     * @return true wenn die Nachricht eingereiht wurde
      */
-    bool sendMessage(uint32_t canId, const uint8_t* data, uint8_t length) {
-        if (!m_running || length > 8) {
+    bool sendMessage(uint32_t canId, bool extended, const uint8_t* data, uint8_t length) {
+        if (length > 8) {
             return false;
         }
         
-        twai_message_t message = {};
-        message.identifier = canId;
-        message.data_length_code = length;
-        message.extd = (canId > 0x7FF) ? 1 : 0;  // Extended ID wenn > 11 Bit
-        memcpy(message.data, data, length);
+        CanFrame frame = {};
+        frame.id = canId;
+        frame.length = length;
+        frame.flags = extended ? CanFrame::FLAG_EXTENDED : 0;
+        memcpy(frame.data, data, length);
         
-        esp_err_t err = twai_transmit(&message, pdMS_TO_TICKS(100));
-        if (err == ESP_OK) {
-            m_txCount++;
-            return true;
-        }
+        return transmit(frame) == CAN_TX_OK;
+    }
+    
+    /**
+     * @brief Liefert den Zustand der Hardware-Sendequeue
+     * @param pending Frames, die noch auf den Bus warten
+     * @param failed Fehlgeschlagene Übertragungen seit Start
+     */
+    void getTxStatus(uint32_t& pending, uint32_t& failed) const {
+        pending = 0;
+        failed = m_txFailedBase;
         
-        m_errorCount++;
-        return false;
+        twai_status_info_t status;
+        if (m_initialized && twai_get_status_info(&status) == ESP_OK) {
+            pending = status.msgs_to_tx;
+            failed += status.tx_failed_count;
+        }
     }
     
     // ========================================================================
@@ -333,29 +1057,243 @@ public:
     // ========================================================================
     
     /**
-     * @brief Registriert Callback für empfangene Nachrichten
-     * @param callback Callback-Funktion
+     * @brief Registriert Sink für empfangene Nachrichten
+     * @param sink z.B. CanMessageSink::function<onFrame>() oder
+     *             CanMessageSink::member<ProtocolManager, &ProtocolManager::handleFrame>(&mgr)
+     */
+    void setMessageSink(CanMessageSink sink) override {
+        m_messageSink = sink;
+    }
+    
+    /**
+     * @brief Registriert einen Abgriff, der im RX-Task für jeden Frame läuft
+     * 
+     * Für Statistik/Mitschnitt. Der Sink läuft vor dem Ring und muss
+     * schnell sein und darf niemals blockieren.
+     * 
+     * @param sink z.B. CanMessageSink::member<CanBusMonitor, &CanBusMonitor::recordFrame>(&mon)
+     */
+    void setRxTapSink(CanMessageSink sink) override {
+        m_rxTapSink = sink;
+    }
+    
+    /**
+     * @brief Registriert einen Tick, der etwa alle TICK_INTERVAL_MS im
+     *        Decode-Task läuft (auch ohne Frames)
+     * 
+     * @param sink z.B. CanTickSink::member<ProtocolManager, &ProtocolManager::update>(&mgr)
+     */
+    void setTickSink(CanTickSink sink) override {
+        m_tickSink = sink;
+    }
+    
+    /**
+     * @brief Registriert Sink für Bus-Zustandswechsel
+     * 
+     * Wird bei Bus-Off, Recovery-Start und erfolgreicher Recovery aus
+     * dem Alert-Task aufgerufen. Die Recovery selbst erledigt der Treiber.
+     * 
+     * @param sink z.B. CanErrorSink::function<onError>()
+     */
+    void setErrorSink(CanErrorSink sink) {
+        m_errorSink = sink;
+    }
+    
+    // ========================================================================
+    // Konfiguration
+    // ========================================================================
+    
+    /**
+     * @brief Setzt die Tiefe des RX-Rings
+     * @param depth Anzahl Frames (wird auf Zweierpotenz aufgerundet)
+     * @return true bei Erfolg
+     * @note Nur vor init() bzw. nach deinit() möglich
+     */
+    bool setRxRingDepth(uint32_t depth) {
+        if (m_initialized) {
+            Serial.println("[CAN] ERROR: Ring depth can only be set before init");
+            return false;
+        }
+        m_rxRingDepth = depth;
+        return true;
+    }
+    
+    /**
+     * @brief Setzt den Hardware-Akzeptanzfilter
+     * 
+     * Berechnet aus den Protokoll-Filtern ein TWAI Code/Mask-Paar. Der
+     * TWAI-Filter kann nur bei der Treiber-Installation gesetzt werden;
+     * ist der Treiber bereits installiert, wird er kurz deinstalliert
+     * und mit dem neuen Filter wieder gestartet.
+     * 
+     * @param filters ID-Filter (nullptr/0 = alles akzeptieren)
+     * @param count Anzahl Filter
+     * @param mode Filter-Modus (Single/Dual/Auto)
+     * @return true bei Erfolg
+     * @note Nicht aus dem Message- oder Error-Sink aufrufen
      */
-    void setMessageCallback(CanMessageCallback callback) {
-        m_messageCallback = callback;
+    bool setAcceptanceFilters(const CanIdFilter* filters, size_t count,
+                              CanFilterMode mode) {
+        CanFilterResult filter = CanFilterCalculator::calculate(filters, count, mode);
+        if (sameFilter(filter, m_filter)) {
+            return true;
+        }
+        
+        m_filter = filter;
+        printFilter(count);
+        
+        if (!m_initialized) {
+            return true;  // Wird bei init() übernommen
+        }
+        
+        return reinstall();
+    }
+    
+    bool setAcceptanceFilters(const CanIdFilter* filters, size_t count) override {
+        return setAcceptanceFilters(filters, count, CAN_FILTER_AUTO);
     }
     
     /**
-     * @brief Registriert Callback für Fehler
-     * @param callback Callback-Funktion
+     * @brief Ändert Baudrate und Betriebsart im laufenden Betrieb
+     * 
+     * Deinstalliert den Treiber, installiert ihn mit der neuen
+     * Konfiguration und startet die Tasks wieder, falls sie liefen.
+     * Schlägt die Neuinstallation fehl, wird die alte Konfiguration
+     * wiederhergestellt.
+     * 
+     * @param baudrate Baudrate (125000, 250000, 500000, 1000000)
+     * @param mode TWAI_MODE_NORMAL oder TWAI_MODE_LISTEN_ONLY
+     * @return true bei Erfolg
+     * @note Nicht aus dem Message- oder Error-Sink aufrufen
      */
-    void setErrorCallback(CanErrorCallback callback) {
-        m_errorCallback = callback;
+    bool reconfigure(uint32_t baudrate, twai_mode_t mode = TWAI_MODE_NORMAL) {
+        return applyConfig(baudrate, mode, nullptr, 0);
+    }
+    
+    /**
+     * @brief Ändert Baudrate, Betriebsart und Akzeptanzfilter gemeinsam
+     * 
+     * Wie reconfigure(), aber Filter und Modus werden mit einer einzigen
+     * Neuinstallation übernommen (z.B. Sniffer an/aus) statt mit zwei
+     * Installationen und der Empfangslücke dazwischen.
+     * 
+     * @param filters ID-Filter (nullptr/0 = alles akzeptieren)
+     * @param count Anzahl Filter
+     * @return true bei Erfolg
+     * @note Nicht aus dem Message- oder Error-Sink aufrufen
+     */
+    bool reconfigure(uint32_t baudrate, twai_mode_t mode,
+                     const CanIdFilter* filters, size_t count) {
+        CanFilterResult filter = CanFilterCalculator::calculate(filters, count, CAN_FILTER_AUTO);
+        return applyConfig(baudrate, mode, &filter, count);
+    }
+    
+    /**
+     * @brief Ermittelt die Baudrate des Busses automatisch
+     * 
+     * Testet 125k/250k/500k/1M nacheinander im Listen-Only Modus (kein
+     * ACK, keine Error-Frames vom Gerät) mit Accept-All Filter. Gewählt
+     * wird die Baudrate mit den meisten gültigen Frames ohne Bus-Fehler.
+     * Eine Rate mit AUTOBAUD_MIN_FRAMES fehlerfreien Frames beendet die
+     * Suche vorzeitig. Danach wird die gefundene Rate im vorherigen
+     * Modus übernommen, ohne Treffer bleibt die alte Rate aktiv.
+     * 
+     * Blockiert für bis zu 4 x listenMs.
+     * 
+     * @param probes Optional: Ergebnis pro Baudrate (mind. 4 Einträge)
+     * @param maxProbes Größe von probes
+     * @param listenMs Messfenster pro Baudrate
+     * @return Gefundene Baudrate oder 0
+     * @note Nicht aus dem Message- oder Error-Sink aufrufen
+     */
+    uint32_t detectBaudrate(CanBaudProbe* probes = nullptr, size_t maxProbes = 0,
+                            uint32_t listenMs = AUTOBAUD_LISTEN_MS) {
+        static const uint32_t rates[] = { 125000, 250000, 500000, 1000000 };
+        
+        if (!m_initialized) {
+            Serial.println("[CAN] ERROR: Auto-baud requires init()");
+            return 0;
+        }
+        
+        bool wasRunning = m_running;
+        if (wasRunning) {
+            stop();
+        }
+        if (!tasksStopped()) {
+            Serial.println("[CAN] ERROR: Auto-baud aborted, tasks still running");
+            return 0;
+        }
+        
+        uninstallDriver();
+        
+        uint32_t oldBaudrate = m_baudrate;
+        twai_mode_t oldMode = m_mode;
+        twai_filter_config_t acceptAll = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+        
+        uint32_t bestRate = 0;
+        uint32_t bestFrames = 0;
+        
+        Serial.println("[CAN] Auto-baud: sweeping in listen-only mode...");
+        
+        for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+            CanBaudProbe probe = { rates[i], 0, 0 };
+            
+            if (i > 0) {
+                twai_driver_uninstall();
+            }
+            m_baudrate = rates[i];
+            m_mode = TWAI_MODE_LISTEN_ONLY;
+            if (installDriver(acceptAll) && twai_start() == ESP_OK) {
+                listen(probe, listenMs);
+                twai_stop();
+            }
+            
+            Serial.printf("[CAN] Auto-baud: %7lu bps -> %lu frames, %lu errors\n",
+                         probe.baudrate, probe.frames, probe.errors);
+            
+            if (probes && i < maxProbes) {
+                probes[i] = probe;
+            }
+            
+            if (probe.errors == 0 && probe.frames > bestFrames) {
+                bestRate = probe.baudrate;
+                bestFrames = probe.frames;
+                if (bestFrames >= AUTOBAUD_MIN_FRAMES) {
+                    break;
+                }
+            }
+        }
+        
+        // Gefundene (oder alte) Baudrate im ursprünglichen Modus übernehmen
+        uninstallDriver();
+        m_baudrate = bestRate ? bestRate : oldBaudrate;
+        m_mode = oldMode;
+        m_initialized = installDriver();
+        
+        if (bestRate) {
+            Serial.printf("[CAN] Auto-baud: detected %lu bps\n", bestRate);
+        } else {
+            Serial.printf("[CAN] Auto-baud: no traffic detected, keeping %lu bps\n", oldBaudrate);
+        }
+        
+        if (m_initialized && wasRunning) {
+            start();
+        }
+        return bestRate;
     }
     
     // ========================================================================
     // Status und Statistiken
     // ========================================================================
     
+    const char* getName() const override {
+        return "TWAI";
+    }
+    
     /**
      * @brief Gibt an ob CAN läuft
      */
-    bool isRunning() const { 
+    bool isRunning() const override { 
         return m_running; 
     }
     
@@ -366,6 +1304,40 @@ public:
         return m_initialized; 
     }
     
+    /**
+     * @brief Aktuelle Baudrate in bps
+     */
+    uint32_t getBaudrate() const override {
+        return m_baudrate;
+    }
+    
+    /**
+     * @brief Gibt an ob der Treiber im Listen-Only Modus läuft
+     */
+    bool isListenOnly() const {
+        return m_mode == TWAI_MODE_LISTEN_ONLY;
+    }
+    
+    /**
+     * @brief Gibt an ob gerade eine Bus-Off Recovery läuft
+     */
+    bool isRecovering() const {
+        return recoveryState() != CAN_RECOVERY_IDLE;
+    }
+    
+    /**
+     * @brief Name eines Recovery-Zustands
+     */
+    static const char* getRecoveryStateName(CanRecoveryState state) {
+        switch (state) {
+            case CAN_RECOVERY_IDLE:       return "OK";
+            case CAN_RECOVERY_BUS_OFF:    return "BUS-OFF";
+            case CAN_RECOVERY_RECOVERING: return "RECOVERING";
+            case CAN_RECOVERY_RESTART:    return "RESTARTING";
+            default:                      return "UNKNOWN";
+        }
+    }
+    
     /**
      * @brief Gibt Statistiken zurück
      * @param rx Referenz für RX-Counter
@@ -373,18 +1345,67 @@ public:
      * @param errors Referenz für Error-Counter
      */
     void getStats(uint32_t& rx, uint32_t& tx, uint32_t& errors) const {
-        rx = m_rxCount;
-        tx = m_txCount;
-        errors = m_errorCount;
+        rx = m_rxCount.load(std::memory_order_relaxed);
+        tx = m_txCount.load(std::memory_order_relaxed);
+        errors = m_errorCount.load(std::memory_order_relaxed);
+    }
+    
+    /**
+     * @brief Gibt erweiterte Statistiken inkl. RX-Ring zurück
+     * @param stats Referenz für Statistik-Struktur
+     */
+    void getStats(CanDriverStats& stats) const {
+        stats.rxCount = m_rxCount.load(std::memory_order_relaxed);
+        stats.txCount = m_txCount.load(std::memory_order_relaxed);
+        getTxStatus(stats.txPending, stats.txFailed);
+        uint32_t settled = stats.txPending + stats.txFailed;
+        stats.txDone = stats.txCount > settled ? stats.txCount - settled : 0;
+        stats.errorCount = m_errorCount.load(std::memory_order_relaxed);
+        stats.ringDepth = m_rxRing.capacity();
+        stats.ringFill = m_rxRing.size();
+        stats.ringHighWater = m_rxRing.highWater();
+        stats.ringOverflows = m_rxRing.overflows();
+        stats.framesPerSecond = m_framesPerSecond;
+        stats.burstCount = m_burstCount;
+        stats.lastBurst = m_lastBurst;
+        stats.maxBurst = m_maxBurst;
+        stats.busErrorCount = m_busErrorCount;
+        stats.errorPassiveCount = m_errorPassiveCount;
+        stats.busOffCount = m_busOffCount;
+        stats.recoveryCount = m_recoveryCount;
+        stats.lastRecoveryMs = m_lastRecoveryMs;
+        stats.maxRecoveryMs = m_maxRecoveryMs;
+        stats.recoveryState = recoveryState();
+        stats.filterActive = !m_filter.acceptAll;
+        stats.filterAcceptance = m_filter.acceptance;
+        stats.reconfigCount = m_reconfigCount;
+        stats.lastReconfigMs = m_lastReconfigMs;
     }
     
     /**
      * @brief Setzt Statistiken zurück
+     * 
+     * Die atomaren Zähler sofort, Burst-/Raten- und Recovery-Statistik
+     * gehören dem RX- bzw. Alert-Task: laufen sie, übernehmen sie den
+     * Reset bei ihrem nächsten Durchlauf (spätestens nach 100 ms).
      */
     void resetStats() {
-        m_rxCount = 0;
-        m_txCount = 0;
-        m_errorCount = 0;
+        m_rxCount.store(0, std::memory_order_relaxed);
+        m_txCount.store(0, std::memory_order_relaxed);
+        
+        // Hardware-Zähler läuft weiter: Basis so setzen, dass die Summe 0 ergibt
+        uint32_t txPending, txFailed;
+        getTxStatus(txPending, txFailed);
+        m_txFailedBase -= txFailed;
+        m_errorCount.store(0, std::memory_order_relaxed);
+        if (m_running) {
+            m_rxStatsReset.store(true, std::memory_order_release);
+            m_alertStatsReset.store(true, std::memory_order_release);
+        } else {
+            clearRxStats();
+            clearAlertStats();
+        }
+        m_rxRing.resetStats();
     }
     
     /**
@@ -392,11 +1413,32 @@ public:
      */
     void printStats() const {
         Serial.println("\n=== CAN Driver Stats ===");
-        Serial.printf("RX Messages:  %lu\n", m_rxCount);
-        Serial.printf("TX Messages:  %lu\n", m_txCount);
-        Serial.printf("Errors:       %lu\n", m_errorCount);
+        uint32_t rx = m_rxCount.load(std::memory_order_relaxed);
+        Serial.printf("RX Messages:  %lu\n", rx);
+        uint32_t txPending, txFailed;
+        getTxStatus(txPending, txFailed);
+        Serial.printf("TX Messages:  %lu (pending %lu, failed %lu)\n",
+                     m_txCount.load(std::memory_order_relaxed), txPending, txFailed);
+        Serial.printf("Errors:       %lu\n", m_errorCount.load(std::memory_order_relaxed));
+        Serial.printf("RX Ring:      %lu/%lu (HWM %lu, Overflows %lu)\n",
+                     m_rxRing.size(), m_rxRing.capacity(),
+                     m_rxRing.highWater(), m_rxRing.overflows());
+        Serial.printf("RX Rate:      %lu frames/s\n", m_framesPerSecond);
+        Serial.printf("HW Filter:    %s\n", m_filter.acceptAll ? "accept all" :
+                     (m_filter.config.single_filter ? "single" : "dual"));
+        Serial.printf("RX Bursts:    %lu (last %lu, max %lu, avg %.1f)\n",
+                     m_burstCount, m_lastBurst, m_maxBurst,
+                     m_burstCount ? (float)rx / m_burstCount : 0.0f);
+        Serial.printf("Bus State:    %s (bus errors %lu, err-passive %lu)\n",
+                     getRecoveryStateName(recoveryState()),
+                     m_busErrorCount, m_errorPassiveCount);
+        Serial.printf("Bus-Off:      %lu (recovered %lu, last %lu ms, max %lu ms)\n",
+                     m_busOffCount, m_recoveryCount, m_lastRecoveryMs, m_maxRecoveryMs);
         Serial.printf("Running:      %s\n", m_running ? "YES" : "NO");
-        Serial.printf("Baudrate:     %lu bps\n", m_baudrate);
+        Serial.printf("Baudrate:     %lu bps (%s)\n", m_baudrate,
+                     m_mode == TWAI_MODE_LISTEN_ONLY ? "listen-only" : "normal");
+        Serial.printf("Reconfigs:    %lu (last downtime %lu ms)\n",
+                     m_reconfigCount, m_lastReconfigMs);
         Serial.println("========================\n");
     }
 };
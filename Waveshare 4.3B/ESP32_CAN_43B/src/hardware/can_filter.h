@@ -0,0 +1,245 @@
+/**
+ * @file can_filter.h
+ * @brief Berechnung der TWAI-Akzeptanzfilter aus Protokoll-Filtern
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Der TWAI-Controller besitzt genau ein 32-Bit Code/Mask-Paar, das
+ * entweder als ein Filter (Single Filter Mode) oder als zwei 16-Bit
+ * Filter (Dual Filter Mode) interpretiert wird. Diese Datei fasst die
+ * von den Protokollen deklarierten ID-Filter zu einem möglichst engen
+ * Code/Mask-Paar zusammen und wählt den Modus mit dem kleineren
+ * akzeptierten ID-Raum.
+ *
+ * Bit-Layout (TWAI-Maske: 1 = "don't care"):
+ *   Single, Standard:  [31:21] ID, [20] RTR, [19:0] Datenbytes
+ *   Single, Extended:  [31:3]  ID, [2]  RTR, [1:0]  unbenutzt
+ *   Dual,   Standard:  Filter 1 [31:21] ID, [20] RTR, [19:16]+[3:0] Datenbyte 1
+ *                      Filter 2 [15:5]  ID, [4]  RTR
+ *   Dual,   Extended:  Filter 1 [31:16], Filter 2 [15:0] = ID[28:13]
+ *
+ * SPEICHERN ALS: src/hardware/can_filter.h
+ */
+
+#ifndef CAN_FILTER_H
+#define CAN_FILTER_H
+
+#include <Arduino.h>
+#include "driver/twai.h"
+#include "../core/can_types.h"
+
+/**
+ * @brief Auswahl des Filter-Modus
+ */
+enum CanFilterMode {
+    CAN_FILTER_AUTO = 0,            ///< Modus mit kleinerem Akzeptanzraum wählen
+    CAN_FILTER_SINGLE,              ///< Ein 32-Bit Filter
+    CAN_FILTER_DUAL                 ///< Zwei 16-Bit Filter
+};
+
+/**
+ * @brief Ergebnis der Filterberechnung
+ */
+struct CanFilterResult {
+    twai_filter_config_t config;    ///< Fertige TWAI-Konfiguration
+    bool acceptAll;                 ///< true = keine Einschränkung
+    float acceptance;               ///< Geschätzter akzeptierter Anteil des ID-Raums (0..2)
+};
+
+/**
+ * @brief Berechnet TWAI Code/Mask-Paare aus CanIdFilter-Listen
+ */
+class CanFilterCalculator {
+public:
+    static constexpr size_t MAX_FILTERS = 32;   ///< Max. Eingangsfilter
+
+    /**
+     * @brief Berechnet die Hardware-Filterkonfiguration
+     * @param filters Protokoll-Filter
+     * @param count Anzahl Filter (0 = alles akzeptieren)
+     * @param mode Gewünschter Modus
+     * @return Filterkonfiguration
+     */
+    static CanFilterResult calculate(const CanIdFilter* filters, size_t count,
+                                     CanFilterMode mode = CAN_FILTER_AUTO) {
+        CanFilterResult result;
+        result.config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+        result.acceptAll = true;
+        result.acceptance = 2.0f;
+
+        if (!filters || count == 0 || count > MAX_FILTERS) {
+            return result;
+        }
+
+        float singleCost = 0.0f;
+        float dualCost = 0.0f;
+        twai_filter_config_t single = buildSingle(filters, count, singleCost);
+        twai_filter_config_t dual = buildDual(filters, count, dualCost);
+
+        bool useDual = (mode == CAN_FILTER_DUAL) ||
+                       (mode == CAN_FILTER_AUTO && dualCost < singleCost);
+
+        result.config = useDual ? dual : single;
+        result.acceptance = useDual ? dualCost : singleCost;
+        result.acceptAll = (result.config.acceptance_mask == 0xFFFFFFFF);
+        return result;
+    }
+
+private:
+    /**
+     * @brief 16-Bit Teilfilter im Dual-Modus
+     */
+    struct SubFilter {
+        uint16_t code;
+        uint16_t dontCare;          ///< 1 = beliebig
+        bool hasStd;                ///< Enthält 11-Bit Filter
+    };
+
+    static uint32_t popcount(uint32_t value) {
+        return (uint32_t)__builtin_popcount(value);
+    }
+
+    /**
+     * @brief Akzeptierter Anteil des ID-Raums bei gegebener Anzahl freier Bits
+     */
+    static float fraction(uint32_t dontCareBits, uint32_t totalBits) {
+        return (float)(1UL << dontCareBits) / (float)(1UL << totalBits);
+    }
+
+    // ========================================================================
+    // Single Filter Mode
+    // ========================================================================
+
+    static void toSingle(const CanIdFilter& f, uint32_t& code, uint32_t& dontCare) {
+        if (f.extended) {
+            uint32_t id = f.id & CAN_EXT_ID_MASK;
+            uint32_t relevant = f.mask & CAN_EXT_ID_MASK;
+            code = id << 3;                                     // RTR = 0
+            dontCare = ((~relevant & CAN_EXT_ID_MASK) << 3) | 0x00000003;
+        } else {
+            uint32_t id = f.id & CAN_STD_ID_MASK;
+            uint32_t relevant = f.mask & CAN_STD_ID_MASK;
+            code = id << 21;                                    // RTR = 0
+            dontCare = ((~relevant & CAN_STD_ID_MASK) << 21) | 0x000FFFFF;
+        }
+        code &= ~dontCare;
+    }
+
+    static twai_filter_config_t buildSingle(const CanIdFilter* filters, size_t count, float& cost) {
+        uint32_t code = 0;
+        uint32_t dontCare = 0;
+        toSingle(filters[0], code, dontCare);
+
+        for (size_t i = 1; i < count; i++) {
+            uint32_t c, m;
+            toSingle(filters[i], c, m);
+            dontCare |= m | (code ^ c);
+            code &= ~dontCare;
+        }
+
+        cost = fraction(popcount(dontCare & 0xFFE00000), 11) +
+               fraction(popcount(dontCare & 0xFFFFFFF8), 29);
+
+        twai_filter_config_t config;
+        config.acceptance_code = code;
+        config.acceptance_mask = dontCare;
+        config.single_filter = true;
+        return config;
+    }
+
+    // ========================================================================
+    // Dual Filter Mode
+    // ========================================================================
+
+    static SubFilter toSub(const CanIdFilter& f) {
+        SubFilter sub;
+        if (f.extended) {
+            // Nur ID[28:13] wird im Dual-Modus verglichen
+            uint32_t id = f.id & CAN_EXT_ID_MASK;
+            uint32_t relevant = f.mask & CAN_EXT_ID_MASK;
+            sub.code = (uint16_t)(id >> 13);
+            sub.dontCare = (uint16_t)(~(relevant >> 13));
+            sub.hasStd = false;
+        } else {
+            uint32_t id = f.id & CAN_STD_ID_MASK;
+            uint32_t relevant = f.mask & CAN_STD_ID_MASK;
+            sub.code = (uint16_t)(id << 5);                     // RTR = 0
+            sub.dontCare = (uint16_t)(((~relevant & CAN_STD_ID_MASK) << 5) | 0x000F);
+            sub.hasStd = true;
+        }
+        sub.code &= ~sub.dontCare;
+        return sub;
+    }
+
+    static SubFilter merge(const SubFilter& a, const SubFilter& b) {
+        SubFilter m;
+        m.dontCare = a.dontCare | b.dontCare | (a.code ^ b.code);
+        m.code = a.code & ~m.dontCare;
+        m.hasStd = a.hasStd || b.hasStd;
+        return m;
+    }
+
+    static float subCost(const SubFilter& sub) {
+        return fraction(popcount(sub.dontCare & 0xFFE0), 11) +
+               fraction(popcount(sub.dontCare), 16);
+    }
+
+    static twai_filter_config_t buildDual(const CanIdFilter* filters, size_t count, float& cost) {
+        SubFilter clusters[MAX_FILTERS];
+        size_t n = count;
+        for (size_t i = 0; i < n; i++) {
+            clusters[i] = toSub(filters[i]);
+        }
+
+        // Agglomerativ zusammenfassen, bis zwei Teilfilter übrig sind.
+        // Es wird jeweils das Paar mit dem kleinsten Ergebnis-Raum vereint.
+        while (n > 2) {
+            size_t bestA = 0, bestB = 1;
+            float bestCost = 1e9f;
+            for (size_t a = 0; a < n; a++) {
+                for (size_t b = a + 1; b < n; b++) {
+                    float c = subCost(merge(clusters[a], clusters[b]));
+                    if (c < bestCost) {
+                        bestCost = c;
+                        bestA = a;
+                        bestB = b;
+                    }
+                }
+            }
+            clusters[bestA] = merge(clusters[bestA], clusters[bestB]);
+            clusters[bestB] = clusters[n - 1];
+            n--;
+        }
+
+        SubFilter upper = clusters[0];
+        SubFilter lower = (n > 1) ? clusters[1] : clusters[0];
+
+        // Filter 1 vergleicht bei 11-Bit Frames zusätzlich Datenbyte 1.
+        // Standard-Teilfilter bevorzugt in Filter 2 legen, dort gibt es
+        // keine Datenbits.
+        if (upper.hasStd && !lower.hasStd) {
+            SubFilter tmp = upper;
+            upper = lower;
+            lower = tmp;
+        }
+
+        uint32_t code = ((uint32_t)upper.code << 16) | lower.code;
+        uint32_t dontCare = ((uint32_t)upper.dontCare << 16) | lower.dontCare;
+
+        if (upper.hasStd) {
+            // Datenbyte 1 (Bits [19:16] und [3:0]) für Filter 1 freigeben
+            dontCare |= 0x000F000F;
+        }
+        code &= ~dontCare;
+
+        cost = subCost(upper) + ((n > 1) ? subCost(lower) : 0.0f);
+
+        twai_filter_config_t config;
+        config.acceptance_code = code;
+        config.acceptance_mask = dontCare;
+        config.single_filter = false;
+        return config;
+    }
+};
+
+#endif // CAN_FILTER_H
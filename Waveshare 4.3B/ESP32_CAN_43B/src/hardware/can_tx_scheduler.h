@@ -0,0 +1,528 @@
+/**
+ * @file can_tx_scheduler.h
+ * @brief Priorisierter, nicht blockierender CAN-Sende-Scheduler
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Einzelne Frames werden über enqueue() in eine Prioritäts-Queue
+ * (Binär-Heap, 0 = höchste Priorität, gleiche Priorität in FIFO-
+ * Reihenfolge) gestellt. Periodische Frames (z.B. Pylontech 0x305
+ * Keep-Alive, Poll-Requests) stehen in einer festen Tabelle und werden
+ * zum Fälligkeitszeitpunkt in dieselbe Queue eingereiht. Die nächste
+ * Fälligkeit wird immer um genau eine Periode weitergeschoben, so
+ * entsteht keine Drift; verpasste Perioden werden gezählt, nicht
+ * nachgeholt.
+ *
+ * Ein eigener TX-Task übergibt die Frames mit ICanBus::transmit()
+ * ohne Wartezeit an die Hardware-Queue. Ist sie voll, wartet der Task
+ * einen Tick; im Bus-Off bleiben die Frames in der Queue, bis der
+ * Bus wieder sendebereit ist.
+ *
+ * enqueue() und die Tabellen-Funktionen dürfen aus jedem Task
+ * aufgerufen werden (kurze Critical Section).
+ *
+ * SPEICHERN ALS: src/hardware/can_tx_scheduler.h
+ */
+
+#ifndef CAN_TX_SCHEDULER_H
+#define CAN_TX_SCHEDULER_H
+
+#include <Arduino.h>
+#include "esp_timer.h"
+#include "../core/can_types.h"
+#include "can_bus.h"
+
+/**
+ * @brief Statistik des TX-Schedulers
+ */
+struct CanTxSchedulerStats {
+    uint32_t enqueued;                  ///< Angenommene Frames (einzeln + periodisch)
+    uint32_t submitted;                 ///< An die Hardware-Queue übergeben
+    uint32_t dropped;                   ///< Verworfen: Scheduler-Queue voll
+    uint32_t rejected;                  ///< Verworfen: Treiber lehnt Frame ab
+    uint32_t failed;                    ///< Verworfen: Treiberfehler (z.B. Bus-Off)
+    uint32_t hwQueueFull;               ///< Wartezyklen wegen voller Hardware-Queue
+    uint32_t periodicSent;              ///< Eingereihte periodische Frames
+    uint32_t periodicMissed;            ///< Verpasste Perioden
+    uint32_t queueFill;                 ///< Aktueller Füllstand
+    uint32_t queueHighWater;            ///< Maximaler Füllstand
+};
+
+/**
+ * @brief Sende-Scheduler mit Prioritäts-Queue und Periodentabelle
+ */
+class CanTxScheduler {
+public:
+    static constexpr size_t QUEUE_SIZE = 32;        ///< Plätze in der Prioritäts-Queue
+    static constexpr size_t MAX_PERIODIC = 16;      ///< Einträge in der Periodentabelle
+
+    static constexpr uint8_t PRIORITY_HIGH = 0;     ///< z.B. Steuerbefehle
+    static constexpr uint8_t PRIORITY_PERIODIC = 64;///< Standard für periodische Frames
+    static constexpr uint8_t PRIORITY_NORMAL = 128; ///< Standard für enqueue()
+    static constexpr uint8_t PRIORITY_LOW = 255;    ///< z.B. Diagnose
+
+private:
+    /**
+     * @brief Eintrag der Prioritäts-Queue
+     */
+    struct QueueEntry {
+        CanFrame frame;
+        uint8_t priority;
+        uint32_t sequence;              ///< FIFO bei gleicher Priorität
+    };
+
+    /**
+     * @brief Eintrag der Periodentabelle
+     */
+    struct PeriodicEntry {
+        CanFrame frame;
+        uint8_t priority;
+        bool used;
+        bool enabled;
+        int64_t periodUs;
+        int64_t nextDueUs;
+    };
+
+    ICanBus* m_bus;
+    TaskHandle_t m_task;
+    volatile bool m_running;
+    portMUX_TYPE m_lock;
+
+    QueueEntry m_queue[QUEUE_SIZE];     ///< Binär-Heap
+    size_t m_queueCount;
+    uint32_t m_sequence;
+
+    PeriodicEntry m_periodic[MAX_PERIODIC];
+
+    // Bereits entnommener, noch nicht angenommener Frame (nur TX-Task)
+    CanFrame m_held;
+    bool m_hasHeld;
+
+    CanTxSchedulerStats m_stats;
+
+    static constexpr uint32_t MAX_WAIT_MS = 100;    ///< Max. Schlafzeit ohne Fälligkeit
+
+    // ========================================================================
+    // Heap (nur unter m_lock)
+    // ========================================================================
+
+    static bool before(const QueueEntry& a, const QueueEntry& b) {
+        if (a.priority != b.priority) {
+            return a.priority < b.priority;
+        }
+        return (int32_t)(a.sequence - b.sequence) < 0;
+    }
+
+    bool pushLocked(const CanFrame& frame, uint8_t priority) {
+        if (m_queueCount >= QUEUE_SIZE) {
+            m_stats.dropped++;
+            return false;
+        }
+
+        size_t i = m_queueCount++;
+        m_queue[i].frame = frame;
+        m_queue[i].priority = priority;
+        m_queue[i].sequence = m_sequence++;
+
+        while (i > 0) {
+            size_t parent = (i - 1) / 2;
+            if (!before(m_queue[i], m_queue[parent])) {
+                break;
+            }
+            QueueEntry tmp = m_queue[i];
+            m_queue[i] = m_queue[parent];
+            m_queue[parent] = tmp;
+            i = parent;
+        }
+
+        m_stats.enqueued++;
+        if (m_queueCount > m_stats.queueHighWater) {
+            m_stats.queueHighWater = m_queueCount;
+        }
+        return true;
+    }
+
+    void popLocked() {
+        m_queue[0] = m_queue[--m_queueCount];
+
+        size_t i = 0;
+        for (;;) {
+            size_t left = 2 * i + 1;
+            size_t right = left + 1;
+            size_t best = i;
+            if (left < m_queueCount && before(m_queue[left], m_queue[best])) {
+                best = left;
+            }
+            if (right < m_queueCount && before(m_queue[right], m_queue[best])) {
+                best = right;
+            }
+            if (best == i) {
+                break;
+            }
+            QueueEntry tmp = m_queue[i];
+            m_queue[i] = m_queue[best];
+            m_queue[best] = tmp;
+            i = best;
+        }
+    }
+
+    // ========================================================================
+    // TX-Task
+    // ========================================================================
+
+    /**
+     * @brief Reiht fällige periodische Frames ein
+     * @return Zeit bis zur nächsten Fälligkeit in µs
+     */
+    int64_t schedulePeriodic(int64_t now) {
+        int64_t nextWake = (int64_t)MAX_WAIT_MS * 1000;
+
+        portENTER_CRITICAL(&m_lock);
+        for (size_t i = 0; i < MAX_PERIODIC; i++) {
+            PeriodicEntry& entry = m_periodic[i];
+            if (!entry.used || !entry.enabled) {
+                continue;
+            }
+
+            if (now >= entry.nextDueUs) {
+                if (pushLocked(entry.frame, entry.priority)) {
+                    m_stats.periodicSent++;
+                }
+
+                // Raster halten; bei Verzug ganze Perioden überspringen
+                entry.nextDueUs += entry.periodUs;
+                if (now >= entry.nextDueUs) {
+                    int64_t missed = (now - entry.nextDueUs) / entry.periodUs + 1;
+                    m_stats.periodicMissed += (uint32_t)missed;
+                    entry.nextDueUs += missed * entry.periodUs;
+                }
+            }
+
+            int64_t wait = entry.nextDueUs - now;
+            if (wait < nextWake) {
+                nextWake = wait;
+            }
+        }
+        portEXIT_CRITICAL(&m_lock);
+
+        return nextWake;
+    }
+
+    /**
+     * @brief Übergibt Frames in Prioritätsreihenfolge an den Treiber
+     *
+     * Der oberste Frame wird entnommen und bis zur Annahme durch den
+     * Treiber gehalten, damit gleichzeitige enqueue()-Aufrufe den Heap
+     * frei umsortieren können.
+     *
+     * @return false wenn die Hardware-Queue voll ist oder der Treiber
+     *         gerade nicht senden kann
+     */
+    bool drainQueue() {
+        for (;;) {
+            if (!m_hasHeld) {
+                portENTER_CRITICAL(&m_lock);
+                if (m_queueCount == 0) {
+                    portEXIT_CRITICAL(&m_lock);
+                    return true;
+                }
+                m_held = m_queue[0].frame;
+                popLocked();
+                portEXIT_CRITICAL(&m_lock);
+                m_hasHeld = true;
+            }
+
+            CanTxResult result = m_bus->transmit(m_held);
+
+            if (result == CAN_TX_QUEUE_FULL) {
+                m_stats.hwQueueFull++;
+                return false;
+            }
+            if (result == CAN_TX_BUSY) {
+                return false;   // Nach Recovery bzw. Neuinstallation weitersenden
+            }
+
+            m_hasHeld = false;
+            portENTER_CRITICAL(&m_lock);
+            if (result == CAN_TX_OK) {
+                m_stats.submitted++;
+            } else if (result == CAN_TX_ERROR) {
+                m_stats.failed++;
+            } else {
+                m_stats.rejected++;
+            }
+            portEXIT_CRITICAL(&m_lock);
+        }
+    }
+
+    static void taskFunction(void* parameter) {
+        CanTxScheduler* scheduler = static_cast<CanTxScheduler*>(parameter);
+
+        Serial.println("[CAN TX] Started");
+
+        while (scheduler->m_running) {
+            int64_t nextWake = scheduler->schedulePeriodic(esp_timer_get_time());
+
+            TickType_t wait;
+            if (!scheduler->drainQueue()) {
+                wait = 1;       // Hardware-Queue voll bzw. Recovery: kurz warten
+            } else {
+                uint32_t waitMs = (uint32_t)((nextWake + 999) / 1000);
+                wait = pdMS_TO_TICKS(waitMs > 0 ? waitMs : 1);
+            }
+
+            // Aufwachen bei Fälligkeit oder neuem Frame (enqueue)
+            ulTaskNotifyTake(pdTRUE, wait);
+        }
+
+        Serial.println("[CAN TX] Stopped");
+        scheduler->m_task = nullptr;
+        vTaskDelete(nullptr);
+    }
+
+    void wake() {
+        TaskHandle_t task = m_task;
+        if (task) {
+            xTaskNotifyGive(task);
+        }
+    }
+
+public:
+    CanTxScheduler()
+        : m_bus(nullptr)
+        , m_task(nullptr)
+        , m_running(false)
+        , m_lock(portMUX_INITIALIZER_UNLOCKED)
+        , m_queueCount(0)
+        , m_sequence(0)
+        , m_held()
+        , m_hasHeld(false)
+        , m_stats()
+    {
+        for (size_t i = 0; i < MAX_PERIODIC; i++) {
+            m_periodic[i].used = false;
+        }
+    }
+
+    ~CanTxScheduler() {
+        end();
+    }
+
+    CanTxScheduler(const CanTxScheduler&) = delete;
+    CanTxScheduler& operator=(const CanTxScheduler&) = delete;
+
+    /**
+     * @brief Startet den TX-Task
+     * @param bus CAN-Bus (z.B. CanDriver)
+     * @return true bei Erfolg
+     */
+    bool begin(ICanBus* bus) {
+        if (m_running || !bus) {
+            return false;
+        }
+
+        m_bus = bus;
+        m_running = true;
+
+        BaseType_t result = xTaskCreate(
+            taskFunction,
+            "can_tx_task",
+            3072,           // Stack size
+            this,           // Parameter (this pointer)
+            5,              // Priority (wie RX-Task, Kadenz wichtiger als UI)
+            &m_task
+        );
+
+        if (result != pdPASS) {
+            Serial.println("[CAN TX] ERROR: Failed to create task");
+            m_running = false;
+            m_task = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Beendet den TX-Task (noch nicht gesendete Frames bleiben in der Queue)
+     */
+    void end() {
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+        wake();
+
+        uint32_t begin = millis();
+        while (m_task && millis() - begin < MAX_WAIT_MS * 2) {
+            vTaskDelay(1);
+        }
+    }
+
+    // ========================================================================
+    // Einzelne Frames
+    // ========================================================================
+
+    /**
+     * @brief Stellt einen Frame zum Senden ein (blockiert nie)
+     * @param frame Frame (Flags bestimmen 11/29 Bit)
+     * @param priority 0 = höchste Priorität
+     * @return false wenn die Queue voll ist
+     */
+    bool enqueue(const CanFrame& frame, uint8_t priority = PRIORITY_NORMAL) {
+        portENTER_CRITICAL(&m_lock);
+        bool ok = pushLocked(frame, priority);
+        portEXIT_CRITICAL(&m_lock);
+
+        if (ok) {
+            wake();
+        }
+        return ok;
+    }
+
+    // ========================================================================
+    // Periodische Frames
+    // ========================================================================
+
+    /**
+     * @brief Legt einen periodischen Frame an
+     * @param frame Frame-Inhalt
+     * @param periodMs Periode in ms
+     * @param enabled Sofort aktivieren
+     * @param priority Priorität in der Queue
+     * @return Handle (>= 0) oder -1 wenn die Tabelle voll ist
+     */
+    int addPeriodic(const CanFrame& frame, uint32_t periodMs, bool enabled = true,
+                    uint8_t priority = PRIORITY_PERIODIC) {
+        if (periodMs == 0) {
+            return -1;
+        }
+
+        int handle = -1;
+        portENTER_CRITICAL(&m_lock);
+        for (size_t i = 0; i < MAX_PERIODIC; i++) {
+            PeriodicEntry& entry = m_periodic[i];
+            if (!entry.used) {
+                entry.frame = frame;
+                entry.priority = priority;
+                entry.used = true;
+                entry.enabled = enabled;
+                entry.periodUs = (int64_t)periodMs * 1000;
+                entry.nextDueUs = esp_timer_get_time();
+                handle = (int)i;
+                break;
+            }
+        }
+        portEXIT_CRITICAL(&m_lock);
+
+        if (handle >= 0) {
+            wake();
+        }
+        return handle;
+    }
+
+    /**
+     * @brief Ersetzt die Nutzdaten eines periodischen Frames
+     * @return false bei ungültigem Handle
+     */
+    bool updatePeriodic(int handle, const uint8_t* data, uint8_t length) {
+        if (handle < 0 || (size_t)handle >= MAX_PERIODIC || length > 8) {
+            return false;
+        }
+
+        portENTER_CRITICAL(&m_lock);
+        PeriodicEntry& entry = m_periodic[handle];
+        bool ok = entry.used;
+        if (ok) {
+            entry.frame.length = length;
+            memcpy(entry.frame.data, data, length);
+        }
+        portEXIT_CRITICAL(&m_lock);
+        return ok;
+    }
+
+    /**
+     * @brief Aktiviert oder pausiert einen periodischen Frame
+     *
+     * Beim Aktivieren wird der erste Frame sofort gesendet und das
+     * Raster ab jetzt neu aufgebaut.
+     */
+    bool setPeriodicEnabled(int handle, bool enabled) {
+        if (handle < 0 || (size_t)handle >= MAX_PERIODIC) {
+            return false;
+        }
+
+        portENTER_CRITICAL(&m_lock);
+        PeriodicEntry& entry = m_periodic[handle];
+        bool ok = entry.used;
+        if (ok) {
+            if (enabled && !entry.enabled) {
+                entry.nextDueUs = esp_timer_get_time();
+            }
+            entry.enabled = enabled;
+        }
+        portEXIT_CRITICAL(&m_lock);
+
+        if (ok && enabled) {
+            wake();
+        }
+        return ok;
+    }
+
+    /**
+     * @brief Gibt an ob ein periodischer Frame aktiv ist
+     */
+    bool isPeriodicEnabled(int handle) const {
+        if (handle < 0 || (size_t)handle >= MAX_PERIODIC) {
+            return false;
+        }
+        return m_periodic[handle].used && m_periodic[handle].enabled;
+    }
+
+    /**
+     * @brief Entfernt einen periodischen Frame
+     */
+    bool removePeriodic(int handle) {
+        if (handle < 0 || (size_t)handle >= MAX_PERIODIC) {
+            return false;
+        }
+
+        portENTER_CRITICAL(&m_lock);
+        bool ok = m_periodic[handle].used;
+        m_periodic[handle].used = false;
+        portEXIT_CRITICAL(&m_lock);
+        return ok;
+    }
+
+    // ========================================================================
+    // Statistik
+    // ========================================================================
+
+    void getStats(CanTxSchedulerStats& stats) {
+        portENTER_CRITICAL(&m_lock);
+        stats = m_stats;
+        stats.queueFill = m_queueCount + (m_hasHeld ? 1 : 0);
+        portEXIT_CRITICAL(&m_lock);
+    }
+
+    void resetStats() {
+        portENTER_CRITICAL(&m_lock);
+        m_stats = CanTxSchedulerStats();
+        portEXIT_CRITICAL(&m_lock);
+    }
+
+    void printStats() {
+        CanTxSchedulerStats stats;
+        getStats(stats);
+
+        Serial.println("\n=== CAN TX Scheduler ===");
+        Serial.printf("Enqueued:     %lu (periodic %lu, missed periods %lu)\n",
+                     stats.enqueued, stats.periodicSent, stats.periodicMissed);
+        Serial.printf("Submitted:    %lu (dropped %lu, rejected %lu, failed %lu, HW queue full %lu)\n",
+                     stats.submitted, stats.dropped, stats.rejected, stats.failed, stats.hwQueueFull);
+        Serial.printf("Queue:        %lu/%u (HWM %lu)\n",
+                     stats.queueFill, (unsigned)QUEUE_SIZE, stats.queueHighWater);
+        Serial.println("========================\n");
+    }
+};
+
+#endif // CAN_TX_SCHEDULER_H
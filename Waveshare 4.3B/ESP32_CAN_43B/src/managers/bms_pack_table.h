@@ -0,0 +1,439 @@
+/**
+ * @file bms_pack_table.h
+ * @brief Mehrere BMS-Packs am selben Bus und Gesamtsicht der Bank
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Parallel geschaltete Packs (z.B. mehrere DALY mit eigener J1939-
+ * Quelladresse) senden dieselben Nachrichten. Die Tabelle hält je
+ * (BMS-Typ, Pack-Adresse) ein bms_data_t, alle Einträge liegen
+ * zusammenhängend in einem festen Array (keine Heap-Allokation im
+ * Decode-Pfad).
+ *
+ * Die Bank-Werte (Summenstrom, SOC-Minimum/-Maximum, schwächster Pack)
+ * werden bei jedem Update inkrementell nachgeführt. Einen Durchlauf über
+ * alle Packs gibt es nur, wenn der bisherige Extremwert-Pack sich in die
+ * Gegenrichtung bewegt oder ein Pack offline geht.
+ *
+ * Geschrieben wird nur im Auswerte-Kontext (Decode-Task bzw. RX-Thread
+ * des Host-Builds): acquire()/update()/touch() aus routeMessage(),
+ * expire() aus ProtocolManager::update() über den Tick-Sink des Busses.
+ * Daher ohne Sperren. Ausgaben aus loop() (printPacks()) lesen ohne
+ * Sperre und können einen Zwischenstand zeigen.
+ *
+ * SPEICHERN ALS: src/managers/bms_pack_table.h
+ */
+
+#ifndef BMS_PACK_TABLE_H
+#define BMS_PACK_TABLE_H
+
+#include <Arduino.h>
+#include "../core/bms_data_types.h"
+#include "../core/deferred_log.h"
+#include "can_cycle_aggregator.h"
+
+/**
+ * @brief Ein Pack der Bank
+ */
+struct BmsPack {
+    bms_type_t type;
+    uint8_t node;                       ///< Pack-Adresse (z.B. J1939-Quelladresse)
+    bool online;
+    uint32_t lastUpdate;                ///< RX-Zeit (ms) des letzten Frames
+    bms_data_t data;
+    CanCycleState cycle;                ///< Sendezyklus (ProtocolManager)
+};
+
+/**
+ * @brief Gesamtsicht aller Packs des Bank-Typs
+ */
+struct BmsBankSummary {
+    uint8_t packCount;                  ///< Bekannte Packs
+    uint8_t onlineCount;                ///< Davon online
+    float totalCurrent;                 ///< Summe der Pack-Ströme in A
+    float averageVoltage;               ///< Mittelwert der Pack-Spannungen in V
+    float averageSoc;
+    float minSoc;
+    float maxSoc;
+    int weakestPack;                    ///< Index mit minimalem SOC, -1 = keiner
+    int strongestPack;                  ///< Index mit maximalem SOC, -1 = keiner
+};
+
+class BmsPackTable {
+public:
+    static constexpr size_t MAX_PACKS = 16;
+    static constexpr int NO_PACK = -1;
+    static constexpr uint32_t PACK_TIMEOUT_MS = 5000;   ///< Wie CanProtocolBase::isConnected()
+
+private:
+    BmsPack m_packs[MAX_PACKS];
+    size_t m_count;
+    int m_lastFound;                    ///< Letzter Treffer von find() (meist derselbe Pack)
+    bms_type_t m_bankType;              ///< BMS_NONE = alle Typen
+    uint32_t m_overflows;               ///< acquire() bei voller Tabelle
+
+    // Inkrementell nachgeführte Bank-Werte
+    uint8_t m_onlineCount;
+    float m_totalCurrent;
+    float m_sumVoltage;
+    float m_sumSoc;
+    int m_weakest;
+    int m_strongest;
+
+    bool inBank(const BmsPack& pack) const {
+        return pack.online && (m_bankType == BMS_NONE || pack.type == m_bankType);
+    }
+
+    /**
+     * @brief Bank-Werte komplett neu berechnen (Pack offline, Typwechsel)
+     */
+    void recompute() {
+        m_onlineCount = 0;
+        m_totalCurrent = 0.0f;
+        m_sumVoltage = 0.0f;
+        m_sumSoc = 0.0f;
+        m_weakest = NO_PACK;
+        m_strongest = NO_PACK;
+
+        for (size_t i = 0; i < m_count; i++) {
+            const BmsPack& pack = m_packs[i];
+            if (!inBank(pack)) {
+                continue;
+            }
+            m_onlineCount++;
+            m_totalCurrent += pack.data.current;
+            m_sumVoltage += pack.data.voltage;
+            m_sumSoc += pack.data.soc;
+            if (m_weakest == NO_PACK || pack.data.soc < m_packs[m_weakest].data.soc) {
+                m_weakest = (int)i;
+            }
+            if (m_strongest == NO_PACK || pack.data.soc > m_packs[m_strongest].data.soc) {
+                m_strongest = (int)i;
+            }
+        }
+    }
+
+    /**
+     * @brief Pack kommt zur Bank hinzu (neu oder wieder online)
+     */
+    void addToBank(int index) {
+        const bms_data_t& data = m_packs[index].data;
+        m_onlineCount++;
+        m_totalCurrent += data.current;
+        m_sumVoltage += data.voltage;
+        m_sumSoc += data.soc;
+        if (m_weakest == NO_PACK || data.soc < m_packs[m_weakest].data.soc) {
+            m_weakest = index;
+        }
+        if (m_strongest == NO_PACK || data.soc > m_packs[m_strongest].data.soc) {
+            m_strongest = index;
+        }
+    }
+
+public:
+    BmsPackTable()
+        : m_count(0)
+        , m_lastFound(NO_PACK)
+        , m_bankType(BMS_NONE)
+        , m_overflows(0)
+    {
+        clear();
+    }
+
+    void clear() {
+        m_count = 0;
+        m_lastFound = NO_PACK;
+        m_overflows = 0;
+        recompute();
+    }
+
+    /**
+     * @brief Frames, für deren Pack kein Slot mehr frei war
+     */
+    uint32_t getOverflows() const {
+        return m_overflows;
+    }
+
+    /**
+     * @brief Sucht einen Pack
+     * @return Index oder NO_PACK
+     */
+    int find(bms_type_t type, uint8_t node) {
+        if (m_lastFound != NO_PACK &&
+            m_packs[m_lastFound].type == type && m_packs[m_lastFound].node == node) {
+            return m_lastFound;
+        }
+        for (size_t i = 0; i < m_count; i++) {
+            if (m_packs[i].type == type && m_packs[i].node == node) {
+                m_lastFound = (int)i;
+                return m_lastFound;
+            }
+        }
+        return NO_PACK;
+    }
+
+    /**
+     * @brief Sucht einen Pack und legt ihn bei Bedarf an (offline, leere Daten)
+     * @return Index oder NO_PACK wenn die Tabelle voll ist
+     */
+    int acquire(bms_type_t type, uint8_t node) {
+        int index = find(type, node);
+        if (index != NO_PACK) {
+            return index;
+        }
+        if (m_count >= MAX_PACKS) {
+            m_overflows++;
+            return NO_PACK;
+        }
+
+        BmsPack& pack = m_packs[m_count];
+        pack.type = type;
+        pack.node = node;
+        pack.online = false;
+        pack.lastUpdate = 0;
+        pack.data = bms_data_t();
+        pack.data.type = type;
+        pack.cycle = CanCycleState();
+
+        BMS_LOG_INFO("[Packs] New %s pack, node 0x%02X (slot %u)\n",
+                     getBmsTypeName(type), node, (unsigned)m_count);
+        m_lastFound = (int)m_count++;
+        return m_lastFound;
+    }
+
+    /**
+     * @brief Übernimmt neu decodierte Daten eines Packs
+     * @param index Index aus acquire()
+     * @param data Decodierter Stand des Packs
+     * @param now RX-Zeit (ms)
+     */
+    void update(int index, const bms_data_t& data, uint32_t now) {
+        if (index < 0 || (size_t)index >= m_count) {
+            return;
+        }
+        BmsPack& pack = m_packs[index];
+        bool wasInBank = inBank(pack);
+        float oldSoc = pack.data.soc;
+
+        if (wasInBank) {
+            m_totalCurrent += data.current - pack.data.current;
+            m_sumVoltage += data.voltage - pack.data.voltage;
+            m_sumSoc += data.soc - oldSoc;
+        }
+
+        pack.data = data;
+        pack.lastUpdate = now;
+        pack.online = true;
+
+        if (!wasInBank) {
+            if (inBank(pack)) {
+                addToBank(index);
+            }
+            return;
+        }
+
+        // Extremwerte: nur nachrechnen, wenn der bisherige Extrem-Pack
+        // sich in Richtung Mitte bewegt
+        if (data.soc < m_packs[m_weakest].data.soc) {
+            m_weakest = index;
+        } else if (index == m_weakest && data.soc > oldSoc) {
+            recompute();
+            return;
+        }
+        if (data.soc > m_packs[m_strongest].data.soc) {
+            m_strongest = index;
+        } else if (index == m_strongest && data.soc < oldSoc) {
+            recompute();
+        }
+    }
+
+    /**
+     * @brief Frame mit unveränderten Nutzdaten: Pack bleibt online
+     */
+    void touch(int index, uint32_t now) {
+        if (index < 0 || (size_t)index >= m_count) {
+            return;
+        }
+        BmsPack& pack = m_packs[index];
+        pack.lastUpdate = now;
+        if (!pack.online) {
+            pack.online = true;
+            if (inBank(pack)) {
+                addToBank(index);
+            }
+        }
+    }
+
+    /**
+     * @brief Setzt Packs ohne Frames seit PACK_TIMEOUT_MS offline
+     */
+    void expire(uint32_t now) {
+        bool changed = false;
+        for (size_t i = 0; i < m_count; i++) {
+            BmsPack& pack = m_packs[i];
+            if (pack.online && (int32_t)(now - pack.lastUpdate) >= (int32_t)PACK_TIMEOUT_MS) {
+                pack.online = false;
+                changed = true;
+                BMS_LOG_INFO("[Packs] %s node 0x%02X offline\n",
+                             getBmsTypeName(pack.type), pack.node);
+            }
+        }
+        if (changed) {
+            recompute();
+        }
+    }
+
+    /**
+     * @brief Beschränkt die Bank auf einen BMS-Typ (aktives Protokoll)
+     * @param type BMS_NONE = Packs aller Typen
+     */
+    void setBankType(bms_type_t type) {
+        if (type != m_bankType) {
+            m_bankType = type;
+            recompute();
+        }
+    }
+
+    size_t getPackCount() const {
+        return m_count;
+    }
+
+    const BmsPack& getPack(size_t index) const {
+        return m_packs[index];
+    }
+
+    /**
+     * @brief Zyklus-Zustand eines Packs (nur Decode-Task)
+     */
+    CanCycleState& getCycle(size_t index) {
+        return m_packs[index].cycle;
+    }
+
+    /**
+     * @brief Anzahl Packs des Bank-Typs, die online sind
+     */
+    uint8_t getOnlineCount() const {
+        return m_onlineCount;
+    }
+
+    BmsBankSummary getSummary() const {
+        BmsBankSummary summary;
+        summary.packCount = 0;
+        for (size_t i = 0; i < m_count; i++) {
+            if (m_bankType == BMS_NONE || m_packs[i].type == m_bankType) {
+                summary.packCount++;
+            }
+        }
+        summary.onlineCount = m_onlineCount;
+        summary.totalCurrent = m_totalCurrent;
+        summary.averageVoltage = m_onlineCount ? m_sumVoltage / m_onlineCount : 0.0f;
+        summary.averageSoc = m_onlineCount ? m_sumSoc / m_onlineCount : 0.0f;
+        summary.minSoc = (m_weakest != NO_PACK) ? m_packs[m_weakest].data.soc : 0.0f;
+        summary.maxSoc = (m_strongest != NO_PACK) ? m_packs[m_strongest].data.soc : 0.0f;
+        summary.weakestPack = m_weakest;
+        summary.strongestPack = m_strongest;
+        return summary;
+    }
+
+    /**
+     * @brief Bank als ein bms_data_t (für UI und Ausgaben)
+     *
+     * Parallelschaltung: Strom = Summe, Spannung und SOC = Mittelwert,
+     * Temperatur und Zyklen = Maximum. Der Status nennt den schwächsten Pack,
+     * die Zellwerte sind die des Packs mit der schwächsten Zelle.
+     * @return false wenn kein Pack online ist
+     */
+    bool getBankData(bms_data_t& data) const {
+        if (m_onlineCount == 0) {
+            return false;
+        }
+        BmsBankSummary summary = getSummary();
+        const BmsPack& weakest = m_packs[summary.weakestPack];
+
+        data = bms_data_t();
+        data.type = weakest.type;
+        data.connected = true;
+        data.voltage = summary.averageVoltage;
+        data.current = summary.totalCurrent;
+        data.soc = summary.averageSoc;
+        data.charging = summary.totalCurrent > 0.5f;
+        data.discharging = summary.totalCurrent < -0.5f;
+        data.temperature = -273.0f;
+        const BmsPack* weakestCells = nullptr;
+        for (size_t i = 0; i < m_count; i++) {
+            const BmsPack& pack = m_packs[i];
+            if (!inBank(pack)) {
+                continue;
+            }
+            if (pack.data.temperature > data.temperature) {
+                data.temperature = pack.data.temperature;
+            }
+            if (pack.data.cycles > data.cycles) {
+                data.cycles = pack.data.cycles;
+            }
+            if (pack.lastUpdate > data.last_update) {
+                data.last_update = pack.lastUpdate;
+            }
+            if (pack.data.cells.getCellCount() > 0 &&
+                (!weakestCells || pack.data.cells.getMinMv() < weakestCells->data.cells.getMinMv())) {
+                weakestCells = &pack;
+            }
+        }
+        if (weakestCells) {
+            data.cells = weakestCells->data.cells;
+        }
+        snprintf(data.status_text, sizeof(data.status_text),
+                 "Bank %u/%u, min SOC %.0f%% (0x%02X)",
+                 (unsigned)summary.onlineCount, (unsigned)summary.packCount,
+                 summary.minSoc, weakest.node);
+        return true;
+    }
+
+    /**
+     * @brief Zellzeile eines Packs (nur wenn das Protokoll Zellen meldet)
+     */
+    static void printCells(const BmsCellStore& cells) {
+        if (cells.getCellCount() == 0) {
+            return;
+        }
+        Serial.printf("    %u cells: %.3f..%.3f V, delta %u mV (low #%u, high #%u)",
+                     (unsigned)cells.getCellCount(), cells.getMinMv() / 1000.0f,
+                     cells.getMaxMv() / 1000.0f, (unsigned)cells.getDeltaMv(),
+                     cells.getWeakestCell() + 1u, cells.getStrongestCell() + 1u);
+        int16_t minTemp, maxTemp;
+        if (cells.getTemperatureRange(minTemp, maxTemp)) {
+            Serial.printf(", %u sensors %.1f..%.1f °C", (unsigned)cells.getTemperatureCount(),
+                         minTemp / 10.0f, maxTemp / 10.0f);
+        }
+        Serial.println();
+    }
+
+    void printPacks() const {
+        Serial.println("\n=== BMS Packs ===");
+
+        for (size_t i = 0; i < m_count; i++) {
+            const BmsPack& pack = m_packs[i];
+            Serial.printf("#%-2u %-10s node 0x%02X: %6.2f V, %6.1f A, SOC %5.1f %%, %5.1f °C %s%s\n",
+                         (unsigned)i, getBmsTypeName(pack.type), pack.node,
+                         pack.data.voltage, pack.data.current, pack.data.soc,
+                         pack.data.temperature,
+                         pack.online ? "" : "[OFFLINE]",
+                         ((int)i == m_weakest && m_onlineCount > 1) ? "[WEAKEST]" : "");
+            printCells(pack.data.cells);
+        }
+
+        BmsBankSummary summary = getSummary();
+        Serial.printf("Bank (%s): %u/%u online, %.1f A total, avg %.2f V, SOC %.1f..%.1f %% (avg %.1f)\n",
+                     m_bankType == BMS_NONE ? "all" : getBmsTypeName(m_bankType),
+                     (unsigned)summary.onlineCount, (unsigned)summary.packCount,
+                     summary.totalCurrent, summary.averageVoltage,
+                     summary.minSoc, summary.maxSoc, summary.averageSoc);
+        if (m_overflows) {
+            Serial.printf("Table full: %lu frames of further packs dropped\n", m_overflows);
+        }
+
+        Serial.println("=================\n");
+    }
+};
+
+#endif // BMS_PACK_TABLE_H
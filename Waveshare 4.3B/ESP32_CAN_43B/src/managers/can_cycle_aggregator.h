@@ -0,0 +1,142 @@
+/**
+ * @file can_cycle_aggregator.h
+ * @brief Fasst die Frames eines Sendezyklus zu einer Aktualisierung zusammen
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Ein BMS sendet seine Werte zyklisch als Frame-Satz (Pylontech z.B.
+ * 0x359, 0x35C, 0x355, 0x356, 0x35E etwa einmal pro Sekunde). Statt nach
+ * jedem Frame einen halb aktualisierten Stand zu veröffentlichen, sammelt
+ * der Aggregator die Frames eines Zyklus pro Pack und meldet genau eine
+ * Aktualisierung, wenn
+ *   - alle Nachrichten des Zyklus (CanProtocolBase::getCycleMessages())
+ *     eingetroffen sind,
+ *   - eine Zyklus-Nachricht erneut kommt (der nächste Zyklus beginnt,
+ *     eine Nachricht fehlte), oder
+ *   - seit dem ersten Frame des Zyklus die Deadline verstrichen ist.
+ * Veröffentlicht wird nur, wenn sich im Zyklus Nutzdaten geändert haben
+ * (Payload-Cache). Die Deadline wird beim nächsten Frame des Packs
+ * geprüft; bleibt der Bus still, greift die Daten-Timeout-Anzeige.
+ *
+ * Nur vom Decode-Task benutzt, daher ohne Sperren.
+ *
+ * SPEICHERN ALS: src/managers/can_cycle_aggregator.h
+ */
+
+#ifndef CAN_CYCLE_AGGREGATOR_H
+#define CAN_CYCLE_AGGREGATOR_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Zyklus-Zustand eines Packs
+ */
+struct CanCycleState {
+    uint32_t seen;                      ///< Eingetroffene Nachrichten (Index-Bits)
+    uint32_t startMs;                   ///< RX-Zeit des ersten Frames
+    bool open;                          ///< Zyklus begonnen
+    bool changed;                       ///< Mindestens ein Frame neu decodiert
+};
+
+/**
+ * @brief Statistik der Zusammenfassung
+ */
+struct CanCycleStats {
+    uint32_t frames;                    ///< Gezählte Frames
+    uint32_t complete;                  ///< Zyklen mit vollständigem Frame-Satz
+    uint32_t restarted;                 ///< Durch Wiederholung abgeschlossen (Frame fehlte)
+    uint32_t deadline;                  ///< Durch die Deadline abgeschlossen
+    uint32_t published;                 ///< Gemeldete Aktualisierungen
+};
+
+class CanCycleAggregator {
+public:
+    static constexpr uint32_t DEFAULT_DEADLINE_MS = 1000;
+
+private:
+    uint32_t m_deadlineMs;
+    CanCycleStats m_stats;
+
+    bool close(CanCycleState& state) {
+        bool publish = state.changed;
+        state.seen = 0;
+        state.open = false;
+        state.changed = false;
+        if (publish) {
+            m_stats.published++;
+        }
+        return publish;
+    }
+
+public:
+    CanCycleAggregator()
+        : m_deadlineMs(DEFAULT_DEADLINE_MS)
+    {
+        resetStats();
+    }
+
+    /**
+     * @brief Maximale Dauer eines Zyklus bis zur Veröffentlichung
+     */
+    void setDeadline(uint32_t deadlineMs) {
+        m_deadlineMs = deadlineMs;
+    }
+
+    uint32_t getDeadline() const {
+        return m_deadlineMs;
+    }
+
+    /**
+     * @brief Nimmt einen Frame in den Zyklus seines Packs auf
+     * @param state Zyklus-Zustand des Packs
+     * @param required Nachrichten eines vollständigen Zyklus (0 = jeder Frame)
+     * @param messageIndex Index der Nachricht in der Protokolltabelle (>= 32: keiner)
+     * @param changed true = neu decodiert, false = unverändert (Payload-Cache)
+     * @param now RX-Zeit in ms
+     * @return true = Zyklus abgeschlossen, neuen Stand veröffentlichen
+     */
+    bool add(CanCycleState& state, uint32_t required, uint8_t messageIndex, bool changed, uint32_t now) {
+        m_stats.frames++;
+        if (required == 0) {
+            if (changed) {
+                m_stats.published++;
+            }
+            return changed;
+        }
+
+        uint32_t bit = messageIndex < 32 ? (1u << messageIndex) : 0;
+        bool publish = false;
+        if (state.open) {
+            if (bit & required & state.seen) {
+                m_stats.restarted++;
+                publish = close(state);
+            } else if (now - state.startMs >= m_deadlineMs) {
+                m_stats.deadline++;
+                publish = close(state);
+            }
+        }
+
+        if (!state.open) {
+            state.open = true;
+            state.startMs = now;
+        }
+        state.seen |= bit;
+        state.changed |= changed;
+
+        if ((state.seen & required) == required) {
+            m_stats.complete++;
+            publish |= close(state);
+        }
+        return publish;
+    }
+
+    CanCycleStats getStats() const {
+        return m_stats;
+    }
+
+    void resetStats() {
+        memset(&m_stats, 0, sizeof(m_stats));
+    }
+};
+
+#endif // CAN_CYCLE_AGGREGATOR_H
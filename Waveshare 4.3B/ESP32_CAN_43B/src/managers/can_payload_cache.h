@@ -0,0 +1,204 @@
+/**
+ * @file can_payload_cache.h
+ * @brief Letzte Nutzdaten pro (Identifier, IDE) vor den Decodern
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Ein BMS wiederholt 0x355/0x356/0x359 usw. jede Sekunde, meist mit
+ * identischem Inhalt. Der Cache vergleicht DLC und 8 Datenbytes (ein
+ * 64-Bit Vergleich) mit dem letzten erfolgreich decodierten Frame der
+ * gleichen ID. Bei Gleichheit entfällt parseMessage() samt Log-Ausgabe,
+ * getData() und UI-Update; das Protokoll aktualisiert nur Zeitstempel
+ * und Verbindungsstatus. Zu jedem Eintrag merkt sich der Cache den
+ * Tabellenindex der Nachricht, damit auch unveränderte Frames im
+ * Sendezyklus mitzählen (CanCycleAggregator).
+ *
+ * Nachrichten, die ein Zielfeld mit einer anderen Nachricht teilen
+ * (CanProtocolBase::getSharedMessages(), z.B. Pylontech 0x35A/0x35E und
+ * status_text), werden als nicht cachebar eingetragen und immer
+ * decodiert; sonst bliebe nach einem unveränderten Frame der Wert der
+ * anderen Nachricht stehen.
+ *
+ * Nur vom Decode-Task benutzt, daher ohne Sperren.
+ *
+ * SPEICHERN ALS: src/managers/can_payload_cache.h
+ */
+
+#ifndef CAN_PAYLOAD_CACHE_H
+#define CAN_PAYLOAD_CACHE_H
+
+#include <Arduino.h>
+#include "../core/can_types.h"
+
+/**
+ * @brief Trefferstatistik des Payload-Caches
+ */
+struct CanPayloadCacheStats {
+    uint32_t hits;                      ///< Unveränderte Frames, Decoder übersprungen
+    uint32_t misses;                    ///< Neue oder geänderte Nutzdaten, decodiert
+    uint32_t bypassed;                  ///< Nicht cachebar (RTR, Tabelle voll, gemeinsames Zielfeld)
+    uint32_t entries;                   ///< Belegte Slots
+};
+
+class CanPayloadCache {
+public:
+    static constexpr size_t TABLE_SIZE = 64;        ///< Slots (Zweierpotenz)
+    static constexpr size_t NO_SLOT = TABLE_SIZE;
+
+private:
+    static constexpr uint32_t KEY_EMPTY = 0xFFFFFFFF;
+    static constexpr uint32_t HASH_SHIFT = 26;      ///< 32 - log2(TABLE_SIZE)
+    static constexpr uint8_t LENGTH_INVALID = 0xFF; ///< Slot belegt, Inhalt ungültig
+    static constexpr uint8_t LENGTH_UNCACHED = 0xFE;///< Slot belegt, immer decodieren
+
+    struct Entry {
+        uint32_t key;
+        uint8_t length;
+        uint8_t messageIndex;           ///< Tabellenindex beim letzten Decodieren
+        uint64_t payload;
+    };
+
+    Entry m_entries[TABLE_SIZE];
+    size_t m_count;
+    uint32_t m_hits;
+    uint32_t m_misses;
+    uint32_t m_bypassed;
+
+    static uint32_t hashKey(uint32_t key) {
+        // Wie CanRouteTable: multiplikativer Hash (Knuth)
+        return (key * 2654435761u) >> HASH_SHIFT;
+    }
+
+    static uint64_t loadPayload(const CanFrame& frame) {
+        uint64_t payload = 0;
+        memcpy(&payload, frame.data, frame.length);
+        return payload;
+    }
+
+    size_t probe(uint32_t key) const {
+        uint32_t index = hashKey(key);
+        for (size_t i = 0; i < TABLE_SIZE; i++) {
+            size_t slot = (index + i) & (TABLE_SIZE - 1);
+            if (m_entries[slot].key == key || m_entries[slot].key == KEY_EMPTY) {
+                return slot;
+            }
+        }
+        return NO_SLOT;
+    }
+
+public:
+    CanPayloadCache()
+        : m_count(0)
+        , m_hits(0)
+        , m_misses(0)
+        , m_bypassed(0)
+    {
+        clear();
+    }
+
+    /**
+     * @brief Vergisst alle Nutzdaten (z.B. nach Protokoll-Initialisierung)
+     */
+    void clear() {
+        for (size_t i = 0; i < TABLE_SIZE; i++) {
+            m_entries[i].key = KEY_EMPTY;
+            m_entries[i].length = LENGTH_INVALID;
+            m_entries[i].messageIndex = 0xFF;
+            m_entries[i].payload = 0;
+        }
+        m_count = 0;
+    }
+
+    /**
+     * @brief Prüft, ob der Frame dem zuletzt decodierten gleicht
+     * @param frame Empfangener Frame
+     * @param slot Slot für commit()/forget(), NO_SLOT wenn nicht cachebar
+     * @return true = unverändert, Decoder kann entfallen
+     */
+    bool check(const CanFrame& frame, size_t& slot) {
+        slot = NO_SLOT;
+        if (frame.isRtr() || frame.length > 8) {
+            m_bypassed++;
+            return false;
+        }
+
+        uint32_t key = frame.key();
+        size_t index = probe(key);
+        // Füllgrad unter 75% halten, neue Schlüssel sonst nicht aufnehmen
+        if (index == NO_SLOT ||
+            (m_entries[index].key == KEY_EMPTY && m_count >= (TABLE_SIZE * 3) / 4)) {
+            m_bypassed++;
+            return false;
+        }
+
+        slot = index;
+        const Entry& entry = m_entries[index];
+        if (entry.key == key && entry.length == LENGTH_UNCACHED) {
+            m_bypassed++;
+            return false;
+        }
+        if (entry.key == key && entry.length == frame.length &&
+            entry.payload == loadPayload(frame)) {
+            m_hits++;
+            return true;
+        }
+        m_misses++;
+        return false;
+    }
+
+    /**
+     * @brief Merkt sich die Nutzdaten nach erfolgreichem Decodieren
+     * @param messageIndex Tabellenindex der Nachricht (getMessageIndex())
+     * @param cacheable false = ID immer decodieren (gemeinsames Zielfeld)
+     */
+    void commit(size_t slot, const CanFrame& frame, uint8_t messageIndex, bool cacheable = true) {
+        if (slot >= TABLE_SIZE) {
+            return;
+        }
+        Entry& entry = m_entries[slot];
+        if (entry.key == KEY_EMPTY) {
+            entry.key = frame.key();
+            m_count++;
+        }
+        entry.length = cacheable ? frame.length : LENGTH_UNCACHED;
+        entry.messageIndex = messageIndex;
+        entry.payload = loadPayload(frame);
+    }
+    
+    /**
+     * @brief Tabellenindex zu einem Treffer von check()
+     */
+    uint8_t getMessageIndex(size_t slot) const {
+        return slot < TABLE_SIZE ? m_entries[slot].messageIndex : 0xFF;
+    }
+
+    /**
+     * @brief Verwirft die Nutzdaten nach einem Decodierfehler
+     *
+     * Ein fehlerhafter Frame kann den Protokollzustand bereits verändert
+     * haben; die nächste Wiederholung des alten Inhalts muss daher wieder
+     * decodiert werden.
+     */
+    void forget(size_t slot) {
+        if (slot < TABLE_SIZE && m_entries[slot].key != KEY_EMPTY) {
+            m_entries[slot].length = LENGTH_INVALID;
+        }
+    }
+
+    CanPayloadCacheStats getStats() const {
+        CanPayloadCacheStats stats;
+        stats.hits = m_hits;
+        stats.misses = m_misses;
+        stats.bypassed = m_bypassed;
+        stats.entries = (uint32_t)m_count;
+        return stats;
+    }
+
+    void resetStats() {
+        m_hits = 0;
+        m_misses = 0;
+        m_bypassed = 0;
+    }
+};
+
+#endif // CAN_PAYLOAD_CACHE_H
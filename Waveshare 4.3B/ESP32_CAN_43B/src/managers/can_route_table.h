@@ -0,0 +1,159 @@
+/**
+ * @file can_route_table.h
+ * @brief Routing-Tabelle (Identifier, IDE) -> Protokoll-Index
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Exakte Identifier aus den Protokoll-Filtern landen in einer offen
+ * adressierten Hash-Tabelle, der Schlüssel ist canKey(id, extended).
+ * Ein Frame wird damit in einem Zugriff (im Normalfall ein Slot)
+ * seinem Protokoll zugeordnet. Filter mit Maske (z.B. JK BMS, 256 IDs)
+ * stehen in einer kurzen Liste, die nur bei einem Fehlgriff in der
+ * Hash-Tabelle geprüft wird.
+ *
+ * Aufbau beim Registrieren der Protokolle, danach nur noch lesend.
+ *
+ * SPEICHERN ALS: src/managers/can_route_table.h
+ */
+
+#ifndef CAN_ROUTE_TABLE_H
+#define CAN_ROUTE_TABLE_H
+
+#include <Arduino.h>
+#include "../core/can_types.h"
+
+/**
+ * @brief Zuordnung CAN-Schlüssel -> Handler-Index
+ */
+class CanRouteTable {
+public:
+    static constexpr size_t TABLE_SIZE = 64;        ///< Slots (Zweierpotenz)
+    static constexpr size_t MAX_MASK_ROUTES = 8;    ///< Filter mit Maske
+    static constexpr int NO_ROUTE = -1;
+
+private:
+    static constexpr uint32_t KEY_EMPTY = 0xFFFFFFFF;
+    static constexpr uint32_t HASH_SHIFT = 26;      ///< 32 - log2(TABLE_SIZE)
+
+    struct Slot {
+        uint32_t key;
+        uint8_t handler;
+    };
+
+    struct MaskRoute {
+        CanIdFilter filter;
+        uint8_t handler;
+    };
+
+    Slot m_slots[TABLE_SIZE];
+    size_t m_exactCount;
+    MaskRoute m_maskRoutes[MAX_MASK_ROUTES];
+    size_t m_maskCount;
+
+    static uint32_t hashKey(uint32_t key) {
+        // Multiplikativer Hash (Knuth), TABLE_SIZE ist Zweierpotenz
+        return (key * 2654435761u) >> HASH_SHIFT;
+    }
+
+    /**
+     * @brief Sucht den Slot eines Schlüssels bzw. den ersten freien
+     * @return Slot-Index oder TABLE_SIZE wenn die Tabelle voll ist
+     */
+    size_t probe(uint32_t key) const {
+        uint32_t index = hashKey(key);
+        for (size_t i = 0; i < TABLE_SIZE; i++) {
+            size_t slot = (index + i) & (TABLE_SIZE - 1);
+            if (m_slots[slot].key == key || m_slots[slot].key == KEY_EMPTY) {
+                return slot;
+            }
+        }
+        return TABLE_SIZE;
+    }
+
+public:
+    CanRouteTable()
+        : m_exactCount(0)
+        , m_maskCount(0)
+    {
+        clear();
+    }
+
+    void clear() {
+        for (size_t i = 0; i < TABLE_SIZE; i++) {
+            m_slots[i].key = KEY_EMPTY;
+            m_slots[i].handler = 0;
+        }
+        m_exactCount = 0;
+        m_maskCount = 0;
+    }
+
+    /**
+     * @brief Trägt einen Filter für einen Handler ein
+     *
+     * Ein bereits belegter Schlüssel behält seinen ersten Handler.
+     *
+     * @return false wenn die Tabelle voll ist oder der Schlüssel bereits
+     *         einem anderen Handler gehört
+     */
+    bool add(const CanIdFilter& filter, uint8_t handler) {
+        if (!filter.isExact()) {
+            if (m_maskCount >= MAX_MASK_ROUTES) {
+                return false;
+            }
+            m_maskRoutes[m_maskCount].filter = filter;
+            m_maskRoutes[m_maskCount].handler = handler;
+            m_maskCount++;
+            return true;
+        }
+
+        // Füllgrad unter 75% halten, damit Suchen kurz bleiben
+        if (m_exactCount >= (TABLE_SIZE * 3) / 4) {
+            return false;
+        }
+
+        uint32_t key = canKey(filter.id, filter.extended);
+        size_t index = probe(key);
+        if (index == TABLE_SIZE) {
+            return false;
+        }
+
+        Slot& slot = m_slots[index];
+        if (slot.key == key) {
+            return slot.handler == handler;
+        }
+
+        slot.key = key;
+        slot.handler = handler;
+        m_exactCount++;
+        return true;
+    }
+
+    /**
+     * @brief Liefert den Handler für einen Frame
+     * @return Handler-Index oder NO_ROUTE
+     */
+    int lookup(uint32_t canId, bool extended) const {
+        uint32_t key = canKey(canId, extended);
+
+        size_t index = probe(key);
+        if (index != TABLE_SIZE && m_slots[index].key == key) {
+            return m_slots[index].handler;
+        }
+
+        for (size_t i = 0; i < m_maskCount; i++) {
+            if (m_maskRoutes[i].filter.matches(canId, extended)) {
+                return m_maskRoutes[i].handler;
+            }
+        }
+        return NO_ROUTE;
+    }
+
+    int lookup(const CanFrame& frame) const {
+        return lookup(frame.id, frame.isExtended());
+    }
+
+    size_t getExactCount() const { return m_exactCount; }
+    size_t getMaskCount() const { return m_maskCount; }
+};
+
+#endif // CAN_ROUTE_TABLE_H
@@ -0,0 +1,553 @@
+/**
+ * @file daly_poller.h
+ * @brief Abfrage-Engine für DALY BMS (Request/Response, mehrere Packs)
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Fragt je Pack-Adresse die Data-IDs einer Runde ab
+ * (DalyPollCan::POLL_ROUND). Pro Pack ist immer höchstens eine Anfrage
+ * offen (das BMS beantwortet sie der Reihe nach), über die Packs hinweg
+ * laufen die Anfragen parallel, begrenzt durch ein Fenster offener
+ * Anfragen. Die Aktualisierungsrate der Bank wächst so mit der Zahl der
+ * Packs, statt sich auf alle Packs aufzuteilen.
+ *
+ *   - Antworten werden über (BMS-Adresse, Data-ID) der offenen Anfrage
+ *     zugeordnet; die Umlaufzeit zählt vom Einreihen der Anfrage (erster
+ *     Sendeversuch, Wiederholungen eingeschlossen) bis zum RX-Zeitstempel
+ *     des ersten Antwort-Frames.
+ *   - Folgeframes mehrteiliger Antworten (0x95, 0x96) gehören zur
+ *     zuletzt beantworteten Anfrage des Packs.
+ *   - Ohne Antwort nach dem Timeout wird die Anfrage wiederholt, nach
+ *     allen Wiederholungen übersprungen.
+ *   - Jede Runde eines Packs beginnt im festen Raster (Intervall),
+ *     verpasste Runden werden nicht nachgeholt.
+ *
+ * Aufteilung auf die Tasks: onFrame() läuft im CAN Decode-Task und legt
+ * Antworten nur in einem SPSC-Ring ab. Zuordnung, Timeouts und neue
+ * Anfragen macht service() in einem eigenen Task (bzw. der Host-
+ * Hauptschleife); der Zustand hat damit genau einen Besitzer. Die
+ * Statistik veröffentlicht service() als Seqlock-Schnappschuss, andere
+ * Tasks lesen nur diesen; resetStats() wird als Anfrage übernommen.
+ * Gesendet wird über eine Sink (z.B. CanTxScheduler::enqueue()); eine
+ * verworfene Anfrage läuft in den Timeout und wird wiederholt.
+ *
+ * SPEICHERN ALS: src/managers/daly_poller.h
+ */
+
+#ifndef DALY_POLLER_H
+#define DALY_POLLER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "esp_timer.h"
+#include "../core/can_types.h"
+#include "../core/sink.h"
+#include "../core/spsc_ring.h"
+#include "../core/seqlock_snapshot.h"
+#include "../protocols/daly_poll_can.h"
+
+/**
+ * @brief Statistik der Abfrage-Engine
+ */
+struct DalyPollStats {
+    uint32_t requests;                  ///< Gesendete Anfragen (inkl. Wiederholungen)
+    uint32_t responses;                 ///< Zugeordnete Antworten
+    uint32_t followFrames;              ///< Folgeframes mehrteiliger Antworten
+    uint32_t retries;                   ///< Wiederholte Anfragen
+    uint32_t timeouts;                  ///< Nach allen Wiederholungen ohne Antwort
+    uint32_t unmatched;                 ///< Antworten ohne offene Anfrage
+    uint32_t rounds;                    ///< Abgeschlossene Runden (alle Packs)
+    uint32_t missedRounds;              ///< Verpasste Rundenstarts
+    uint32_t ringOverflows;             ///< Verworfene Antworten (Ring voll)
+    uint32_t rttMinUs;
+    uint32_t rttMaxUs;
+    uint32_t rttAvgUs;
+    uint32_t inFlight;                  ///< Aktuell offene Anfragen
+    uint32_t inFlightHighWater;
+};
+
+class DalyPoller {
+public:
+    static constexpr size_t MAX_PACKS = 16;
+    static constexpr size_t MAX_DATA_IDS = 9;           ///< 0x90..0x98
+
+    static constexpr uint32_t DEFAULT_INTERVAL_MS = 1000;
+    static constexpr uint32_t DEFAULT_TIMEOUT_MS = 100;
+    static constexpr uint8_t DEFAULT_RETRIES = 2;
+    static constexpr uint8_t DEFAULT_WINDOW = 8;        ///< Offene Anfragen über alle Packs
+    static constexpr uint32_t RESPONSE_RING_DEPTH = 64;
+
+private:
+    /**
+     * @brief Antwort-Frame (Decode-Task -> service())
+     */
+    struct Response {
+        int64_t rxUs;
+        uint8_t dataId;
+        uint8_t address;
+    };
+
+    /**
+     * @brief Abfragezustand eines Packs
+     */
+    struct PackState {
+        uint8_t address;
+        uint8_t next;                   ///< Index in m_dataIds
+        uint8_t attempts;               ///< Sendeversuche der offenen Anfrage
+        uint8_t lastAnswered;           ///< Data-ID der letzten Antwort (Folgeframes)
+        bool pending;
+        int64_t queuedUs;               ///< Erster Sendeversuch (Umlaufzeit)
+        int64_t sentUs;                 ///< Letzter Sendeversuch (Timeout)
+        int64_t roundStartUs;           ///< Raster der Runden
+        int64_t dueUs;                  ///< Nächste Anfrage frühestens
+        uint32_t responses;
+        uint32_t timeouts;
+        uint32_t lastRttUs;
+    };
+
+    /**
+     * @brief Statistik-Schnappschuss (service() -> beliebiger Task)
+     */
+    struct Report {
+        DalyPollStats stats;
+        uint8_t packCount;
+        struct {
+            uint8_t address;
+            uint32_t responses;
+            uint32_t timeouts;
+            uint32_t lastRttUs;
+        } packs[MAX_PACKS];
+    };
+
+    PackState m_packs[MAX_PACKS];
+    size_t m_packCount;
+    uint8_t m_dataIds[MAX_DATA_IDS];
+    size_t m_dataIdCount;
+    size_t m_nextPack;                  ///< Round-Robin beim Senden
+
+    int64_t m_intervalUs;
+    int64_t m_timeoutUs;
+    uint8_t m_retries;
+    uint8_t m_window;
+    uint8_t m_inFlight;
+
+    Sink<const CanFrame&> m_transmit;
+    SpscRing<Response> m_responses;
+    std::atomic<bool> m_enabled;
+    bool m_active;                      ///< Zustand in service() (nur Service-Task)
+
+    DalyPollStats m_stats;
+    uint64_t m_rttSumUs;
+    uint32_t m_rttCount;
+    std::atomic<bool> m_resetRequested;
+    SeqlockSnapshot<Report> m_report;
+
+#ifdef ESP_PLATFORM
+    TaskHandle_t m_task;
+    TickType_t m_intervalTicks;         ///< Max. Schlafzeit des Abfrage-Tasks
+#endif
+
+    // ========================================================================
+    // Ablauf (nur service())
+    // ========================================================================
+
+    void restart(int64_t now) {
+        m_inFlight = 0;
+        for (size_t i = 0; i < m_packCount; i++) {
+            PackState& pack = m_packs[i];
+            pack.next = 0;
+            pack.attempts = 0;
+            pack.lastAnswered = 0;
+            pack.pending = false;
+            pack.roundStartUs = now;
+            pack.dueUs = now;
+        }
+    }
+
+    void send(PackState& pack, int64_t now) {
+        m_transmit(DalyPollCan::makeRequest(m_dataIds[pack.next], pack.address));
+        pack.sentUs = now;
+        pack.attempts++;
+        m_stats.requests++;
+    }
+
+    /**
+     * @brief Anfrage erledigt (Antwort oder aufgegeben): nächste Data-ID
+     */
+    void advance(PackState& pack, int64_t now) {
+        pack.pending = false;
+        pack.attempts = 0;
+        m_inFlight--;
+
+        if (++pack.next < m_dataIdCount) {
+            pack.dueUs = now;
+            return;
+        }
+
+        // Runde komplett: nächster Start im Raster, verpasste Starts überspringen
+        pack.next = 0;
+        m_stats.rounds++;
+        pack.roundStartUs += m_intervalUs;
+        if (now >= pack.roundStartUs) {
+            int64_t missed = (now - pack.roundStartUs) / m_intervalUs + 1;
+            m_stats.missedRounds += (uint32_t)missed;
+            pack.roundStartUs += missed * m_intervalUs;
+        }
+        pack.dueUs = pack.roundStartUs;
+    }
+
+    void clearStats() {
+        memset(&m_stats, 0, sizeof(m_stats));
+        m_rttSumUs = 0;
+        m_rttCount = 0;
+    }
+
+    void publishReport() {
+        Report report;
+        report.stats = m_stats;
+        report.stats.rttAvgUs = m_rttCount ? (uint32_t)(m_rttSumUs / m_rttCount) : 0;
+        report.stats.inFlight = m_inFlight;
+        report.stats.ringOverflows = m_responses.overflows();
+        report.packCount = (uint8_t)m_packCount;
+        for (size_t i = 0; i < MAX_PACKS; i++) {
+            const PackState& pack = m_packs[i];
+            report.packs[i].address = pack.address;
+            report.packs[i].responses = pack.responses;
+            report.packs[i].timeouts = pack.timeouts;
+            report.packs[i].lastRttUs = pack.lastRttUs;
+        }
+        m_report.publish(report);
+    }
+
+    PackState* findPack(uint8_t address) {
+        for (size_t i = 0; i < m_packCount; i++) {
+            if (m_packs[i].address == address) {
+                return &m_packs[i];
+            }
+        }
+        return nullptr;
+    }
+
+    void handleResponse(const Response& response) {
+        PackState* pack = findPack(response.address);
+        if (!pack) {
+            m_stats.unmatched++;
+            return;
+        }
+
+        if (pack->pending && m_dataIds[pack->next] == response.dataId) {
+            // Ab dem ersten Versuch: eine späte Antwort auf ihn käme sonst
+            // nach einer Wiederholung mit zu kurzer Umlaufzeit an
+            int64_t elapsed = response.rxUs - pack->queuedUs;
+            uint32_t rtt = elapsed > 0 ? (uint32_t)elapsed : 0;
+            pack->lastRttUs = rtt;
+            pack->lastAnswered = response.dataId;
+            pack->responses++;
+            m_stats.responses++;
+            m_rttSumUs += rtt;
+            m_rttCount++;
+            if (m_rttCount == 1 || rtt < m_stats.rttMinUs) {
+                m_stats.rttMinUs = rtt;
+            }
+            if (rtt > m_stats.rttMaxUs) {
+                m_stats.rttMaxUs = rtt;
+            }
+            advance(*pack, response.rxUs);
+        } else if (response.dataId == pack->lastAnswered) {
+            m_stats.followFrames++;
+        } else {
+            m_stats.unmatched++;
+        }
+    }
+
+    void checkTimeouts(int64_t now) {
+        for (size_t i = 0; i < m_packCount; i++) {
+            PackState& pack = m_packs[i];
+            if (!pack.pending || now - pack.sentUs < m_timeoutUs) {
+                continue;
+            }
+            if (pack.attempts <= m_retries) {
+                m_stats.retries++;
+                send(pack, now);
+            } else {
+                m_stats.timeouts++;
+                pack.timeouts++;
+                pack.lastAnswered = 0;
+                advance(pack, now);
+            }
+        }
+    }
+
+    void issueRequests(int64_t now) {
+        for (size_t n = 0; n < m_packCount && m_inFlight < m_window; n++) {
+            size_t index = (m_nextPack + n) % m_packCount;
+            PackState& pack = m_packs[index];
+            if (pack.pending || now < pack.dueUs) {
+                continue;
+            }
+            pack.pending = true;
+            pack.queuedUs = now;
+            m_inFlight++;
+            send(pack, now);
+            m_nextPack = index + 1;
+        }
+        if (m_inFlight > m_stats.inFlightHighWater) {
+            m_stats.inFlightHighWater = m_inFlight;
+        }
+    }
+
+public:
+    DalyPoller()
+        : m_packCount(0)
+        , m_dataIdCount(0)
+        , m_nextPack(0)
+        , m_intervalUs((int64_t)DEFAULT_INTERVAL_MS * 1000)
+        , m_timeoutUs((int64_t)DEFAULT_TIMEOUT_MS * 1000)
+        , m_retries(DEFAULT_RETRIES)
+        , m_window(DEFAULT_WINDOW)
+        , m_inFlight(0)
+        , m_enabled(false)
+        , m_active(false)
+        , m_rttSumUs(0)
+        , m_rttCount(0)
+        , m_resetRequested(false)
+#ifdef ESP_PLATFORM
+        , m_task(nullptr)
+        , m_intervalTicks(1)
+#endif
+    {
+        memset(m_packs, 0, sizeof(m_packs));
+        memcpy(m_dataIds, DalyPollCan::POLL_ROUND, sizeof(DalyPollCan::POLL_ROUND));
+        m_dataIdCount = sizeof(DalyPollCan::POLL_ROUND);
+        clearStats();
+    }
+
+    DalyPoller(const DalyPoller&) = delete;
+    DalyPoller& operator=(const DalyPoller&) = delete;
+
+    // ========================================================================
+    // Konfiguration (vor begin() bzw. bei deaktivierter Abfrage)
+    // ========================================================================
+
+    /**
+     * @brief Fragt die BMS-Adressen first..first+count-1 ab
+     * @return false bei ungültigem Bereich (max. MAX_PACKS, nicht 0x40)
+     */
+    bool setPackRange(uint8_t first, uint8_t count) {
+        if (count == 0 || count > MAX_PACKS || first == 0 ||
+            (first <= DalyPollCan::HOST_ADDRESS && first + count > DalyPollCan::HOST_ADDRESS)) {
+            return false;
+        }
+        memset(m_packs, 0, sizeof(m_packs));
+        for (uint8_t i = 0; i < count; i++) {
+            m_packs[i].address = (uint8_t)(first + i);
+        }
+        m_packCount = count;
+        m_nextPack = 0;
+        return true;
+    }
+
+    /**
+     * @brief Data-IDs einer Runde (Standard: DalyPollCan::POLL_ROUND)
+     */
+    bool setDataIds(const uint8_t* dataIds, size_t count) {
+        if (count == 0 || count > MAX_DATA_IDS) {
+            return false;
+        }
+        memcpy(m_dataIds, dataIds, count);
+        m_dataIdCount = count;
+        return true;
+    }
+
+    /**
+     * @brief Rundenintervall je Pack, Antwort-Timeout, Wiederholungen, Fenster
+     */
+    void setTiming(uint32_t intervalMs, uint32_t timeoutMs, uint8_t retries, uint8_t window) {
+        m_intervalUs = (int64_t)(intervalMs ? intervalMs : DEFAULT_INTERVAL_MS) * 1000;
+        m_timeoutUs = (int64_t)(timeoutMs ? timeoutMs : DEFAULT_TIMEOUT_MS) * 1000;
+        m_retries = retries;
+        m_window = window ? window : 1;
+    }
+
+    /**
+     * @brief Reserviert den Antwort-Ring und setzt die Sende-Sink
+     * @param transmit Stellt einen Frame zum Senden ein (darf nicht blockieren)
+     */
+    bool begin(Sink<const CanFrame&> transmit) {
+        if (!transmit || m_packCount == 0) {
+            return false;
+        }
+        m_transmit = transmit;
+        if (!m_responses.init(RESPONSE_RING_DEPTH)) {
+            Serial.println("[DALY Poll] ERROR: Failed to allocate response ring");
+            return false;
+        }
+        Serial.printf("[DALY Poll] %u packs (0x%02X..0x%02X), %u data IDs, interval %lu ms\n",
+                     (unsigned)m_packCount, m_packs[0].address, m_packs[m_packCount - 1].address,
+                     (unsigned)m_dataIdCount, (uint32_t)(m_intervalUs / 1000));
+        return true;
+    }
+
+    /**
+     * @brief Startet bzw. stoppt die Abfrage (beliebiger Task)
+     */
+    void setEnabled(bool enabled) {
+        m_enabled.store(enabled, std::memory_order_relaxed);
+#ifdef ESP_PLATFORM
+        if (m_task) {
+            xTaskNotifyGive(m_task);
+        }
+#endif
+    }
+
+    bool isEnabled() const {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    // ========================================================================
+    // Laufzeit
+    // ========================================================================
+
+    /**
+     * @brief Nimmt einen empfangenen Frame entgegen (nur CAN Decode-Task)
+     * @return true wenn es eine DALY-Antwort ist
+     */
+    bool onFrame(const CanFrame& frame) {
+        Response response;
+        if (!isEnabled() || !DalyPollCan::parseResponse(frame, response.dataId, response.address)) {
+            return false;
+        }
+        response.rxUs = frame.timestampUs;
+        m_responses.push(response);
+#ifdef ESP_PLATFORM
+        if (m_task) {
+            xTaskNotifyGive(m_task);
+        }
+#endif
+        return true;
+    }
+
+    /**
+     * @brief Ordnet Antworten zu, prüft Timeouts, sendet fällige Anfragen
+     *
+     * Nur aus einem Task aufrufen (startTask() bzw. Host-Hauptschleife).
+     * Veröffentlicht am Ende den Statistik-Schnappschuss.
+     * @param now Aktuelle Zeit in µs (esp_timer_get_time())
+     */
+    void service(int64_t now) {
+        if (m_resetRequested.exchange(false, std::memory_order_acquire)) {
+            clearStats();
+        }
+
+        bool enabled = m_enabled.load(std::memory_order_relaxed);
+        if (enabled != m_active) {
+            restart(now);
+            m_active = enabled;
+            Serial.printf("[DALY Poll] %s\n", enabled ? "Started" : "Stopped");
+        }
+
+        Response response;
+        while (m_responses.pop(response)) {
+            if (m_active) {
+                handleResponse(response);
+            }
+        }
+        if (m_active) {
+            checkTimeouts(now);
+            issueRequests(now);
+        }
+        publishReport();
+    }
+
+#ifdef ESP_PLATFORM
+    /**
+     * @brief Startet den Abfrage-Task
+     *
+     * Wacht bei jeder Antwort (onFrame()) und spätestens nach
+     * intervalMs auf, so folgt die nächste Anfrage eines Packs
+     * unmittelbar auf dessen Antwort.
+     */
+    bool startTask(UBaseType_t priority = 4, uint32_t intervalMs = 5) {
+        if (m_task) {
+            return true;
+        }
+        TickType_t interval = pdMS_TO_TICKS(intervalMs);
+        m_intervalTicks = interval > 0 ? interval : 1;
+
+        BaseType_t result = xTaskCreate(
+            [](void* parameter) {
+                DalyPoller* poller = static_cast<DalyPoller*>(parameter);
+                for (;;) {
+                    poller->service(esp_timer_get_time());
+                    ulTaskNotifyTake(pdTRUE, poller->m_intervalTicks);
+                }
+            },
+            "daly_poll_task",
+            3072,           // Stack size
+            this,
+            priority,
+            &m_task
+        );
+        if (result != pdPASS) {
+            Serial.println("[DALY Poll] ERROR: Failed to create task");
+            m_task = nullptr;
+            return false;
+        }
+        return true;
+    }
+#endif
+
+    // ========================================================================
+    // Statistik
+    // ========================================================================
+
+    /**
+     * @brief Stand des letzten service()-Durchlaufs (beliebiger Task)
+     */
+    DalyPollStats getStats() const {
+        Report report;
+        m_report.read(report);
+        return report.stats;
+    }
+
+    /**
+     * @brief Setzt die Statistik zurück (beliebiger Task)
+     *
+     * Übernommen beim nächsten service()-Durchlauf.
+     */
+    void resetStats() {
+        m_resetRequested.store(true, std::memory_order_release);
+#ifdef ESP_PLATFORM
+        if (m_task) {
+            xTaskNotifyGive(m_task);
+        }
+#endif
+    }
+
+    void printStats() const {
+        Report report;
+        m_report.read(report);
+        const DalyPollStats& stats = report.stats;
+
+        Serial.println("\n=== DALY Poll ===");
+        Serial.printf("State:        %s, %u packs, window %u, timeout %lu ms, %u retries\n",
+                     isEnabled() ? "ON" : "OFF", (unsigned)report.packCount, m_window,
+                     (uint32_t)(m_timeoutUs / 1000), m_retries);
+        Serial.printf("Requests:     %lu (retries %lu, timeouts %lu), in flight %lu (HWM %lu)\n",
+                     stats.requests, stats.retries, stats.timeouts,
+                     stats.inFlight, stats.inFlightHighWater);
+        Serial.printf("Responses:    %lu (+%lu follow frames, %lu unmatched, %lu ring overflows)\n",
+                     stats.responses, stats.followFrames, stats.unmatched, stats.ringOverflows);
+        Serial.printf("Rounds:       %lu (missed %lu)\n", stats.rounds, stats.missedRounds);
+        Serial.printf("RTT:          min %lu us, avg %lu us, max %lu us\n",
+                     stats.rttMinUs, stats.rttAvgUs, stats.rttMaxUs);
+        for (size_t i = 0; i < report.packCount; i++) {
+            Serial.printf("  BMS 0x%02X:   %lu responses, %lu timeouts, last RTT %lu us\n",
+                         report.packs[i].address, report.packs[i].responses,
+                         report.packs[i].timeouts, report.packs[i].lastRttUs);
+        }
+        Serial.println("=================\n");
+    }
+};
+
+#endif // DALY_POLLER_H
@@ -3,36 +3,150 @@
  * @brief Protocol Manager mit Auto-Detection
  * @date 2025
  * 
+ * Task-Zuordnung: Routing, Decodierung, Pack-Tabelle und Erkennungs-
+ * zustand gehören dem Auswerte-Kontext (CAN Decode-Task, im Host-Build
+ * der RX-Thread): routeMessage() pro Frame, update() über den Tick-Sink.
+ * Andere Tasks (loop(), UI) lesen nur die atomaren Felder (aktives
+ * Protokoll, Auto-Detect, Revalidierung) und stellen Änderungen über
+ * setAutoDetect()/selectProtocol()/resetStats() als Anfrage ein, die
+ * beim nächsten Frame oder Tick übernommen wird. Statistik-Ausgaben
+ * lesen ohne Sperre und können einen Zwischenstand zeigen.
+ * 
  * SPEICHERN ALS: src/managers/protocol_manager.h
  */
 
 #ifndef PROTOCOL_MANAGER_H
 #define PROTOCOL_MANAGER_H
 
+#include "esp_timer.h"
 #include "../protocols/protocol_base_can.h"
+#include "can_route_table.h"
+#include "can_payload_cache.h"
+#include "can_cycle_aggregator.h"
+#include "bms_pack_table.h"
 #include <vector>
+#include <functional>
+#include <atomic>
+#include <math.h>
+
+/**
+ * @brief Callback bei Wechsel des aktiven Protokolls
+ * @param protocol Aktives Protokoll (nullptr = Auto-Detection)
+ */
+using ProtocolChangeCallback = std::function<void(CanProtocolBase* protocol)>;
 
 class ProtocolManager {
 private:
     struct DetectionStats {
         CanProtocolBase* protocol;
         uint32_t matchCount;
-        uint32_t lastMatch;
+        uint32_t errorCount;            ///< Zugeordnete, aber nicht decodierbare Frames
+        uint32_t lastMatch;             ///< RX-Zeit (ms) des letzten decodierten Frames
+        float score;                    ///< Konfidenz zum Zeitpunkt scoreTime
+        uint32_t scoreTime;
         
-        DetectionStats() : protocol(nullptr), matchCount(0), lastMatch(0) {}
+        DetectionStats()
+            : protocol(nullptr), matchCount(0), errorCount(0), lastMatch(0)
+            , score(0.0f), scoreTime(0) {}
     };
     
     std::vector<CanProtocolBase*> m_protocols;
     std::vector<DetectionStats> m_detectionStats;
-    CanProtocolBase* m_activeProtocol;
-    bool m_autoDetect;
+    // Geschrieben nur im Auswerte-Kontext, gelesen auch aus loop()
+    std::atomic<CanProtocolBase*> m_activeProtocol;
+    std::atomic<bool> m_autoDetect;
+    std::atomic<bool> m_revalidating;   ///< Alle Kandidaten werden bewertet
+    uint32_t m_revalidationTime;        ///< Lock-In bzw. Beginn/Ende der letzten Revalidierung
+    
+    // Anfragen anderer Tasks, übernommen von applyRequests()
+    static constexpr int REQUEST_NONE = -1;
+    static constexpr int REQUEST_AUTO = -2;             ///< Auto-Detection ein, neu erkennen
+    static constexpr int REQUEST_MANUAL = -3;           ///< Auto-Detection aus, Protokoll bleibt
+    std::atomic<int> m_modeRequest;     ///< REQUEST_* oder Index des gewählten Protokolls
+    std::atomic<bool> m_resetRequested;
+    
+    // Routing (ID, IDE) -> Protokoll-Index, aufgebaut in registerProtocol()
+    CanRouteTable m_routes;
+    CanPayloadCache m_payloadCache;
+    bool m_payloadCacheEnabled;         ///< false = jeden Frame decodieren (Vergleichsläufe)
+    std::vector<uint8_t> m_unfilteredProtocols;  ///< Protokolle ohne Filterangabe
+    
+    // Multi-Pack: Daten je (Typ, Pack-Adresse), geladener Pack je Protokoll
+    BmsPackTable m_packs;
+    std::vector<int> m_loadedPacks;
+    
+    // Sendezyklen: ein veröffentlichter Stand pro Zyklus und Pack
+    CanCycleAggregator m_cycles;
+    ProtocolChangeCallback m_changeCallback;
+    
+    // Routing-Statistik (Effizienz des Hardware-Filters)
+    uint32_t m_routedCount;             ///< Von einem Protokoll verarbeitet
+    uint32_t m_unroutedCount;           ///< Von keinem Protokoll verarbeitet
+    
+    // Latenz RX-Zeitstempel -> Frame geparst
+    uint32_t m_lastLatencyUs;           ///< Latenz des letzten Frames
+    uint32_t m_maxLatencyUs;            ///< Maximale Latenz
+    uint64_t m_sumLatencyUs;            ///< Summe für Mittelwert
+    
+    void setActiveProtocol(CanProtocolBase* protocol) {
+        if (protocol == m_activeProtocol.load(std::memory_order_relaxed)) {
+            return;
+        }
+        m_activeProtocol.store(protocol, std::memory_order_release);
+        m_packs.setBankType(protocol ? protocol->getType() : BMS_NONE);
+        if (m_changeCallback) {
+            m_changeCallback(protocol);
+        }
+    }
     
-    static constexpr uint32_t DETECTION_THRESHOLD = 5;
+    // Auto-Detection: Konfidenz = zeitlich abklingende Summe der Treffer
+    static constexpr float LOCK_SCORE = 5.0f;                   ///< Mindest-Konfidenz für Lock-In
+    static constexpr float LOCK_MARGIN = 2.0f;                  ///< Faktor gegenüber dem Zweitbesten
+    static constexpr float SWITCH_MARGIN = 2.0f;                ///< Faktor gegenüber dem aktiven Protokoll
+    static constexpr float ERROR_PENALTY = 2.0f;                ///< Abzug je nicht decodierbarem Frame
+    static constexpr uint32_t SCORE_HALF_LIFE_MS = 5000;
+    static constexpr uint32_t SILENCE_TIMEOUT_MS = 10000;       ///< Aktives Protokoll stumm -> neu erkennen
+    static constexpr uint32_t REVALIDATE_INTERVAL_MS = 60000;
+    static constexpr uint32_t REVALIDATE_WINDOW_MS = 3000;
+    static constexpr size_t MAX_ROUTE_FILTERS = 32;     ///< Filter pro Protokoll
+    
+    /**
+     * @brief Trägt die Filter eines Protokolls in die Routing-Tabelle ein
+     */
+    void addRoutes(CanProtocolBase* protocol, uint8_t index) {
+        CanIdFilter filters[MAX_ROUTE_FILTERS];
+        size_t count = protocol->getIdFilters(filters, MAX_ROUTE_FILTERS);
+        
+        if (count == 0) {
+            // Keine Filterangabe: nach Tabellen-Fehlgriff per canAcceptMessage prüfen
+            m_unfilteredProtocols.push_back(index);
+            return;
+        }
+        
+        for (size_t i = 0; i < count; i++) {
+            if (!m_routes.add(filters[i], index)) {
+                Serial.printf("[ProtocolMgr] WARNING: Route 0x%lX%s of %s not added (conflict or table full)\n",
+                             filters[i].id, filters[i].extended ? "x" : "",
+                             protocol->getName());
+            }
+        }
+    }
 
 public:
     ProtocolManager() 
         : m_activeProtocol(nullptr)
         , m_autoDetect(true)
+        , m_revalidating(false)
+        , m_revalidationTime(0)
+        , m_modeRequest(REQUEST_NONE)
+        , m_resetRequested(false)
+        , m_payloadCacheEnabled(true)
+        , m_changeCallback(nullptr)
+        , m_routedCount(0)
+        , m_unroutedCount(0)
+        , m_lastLatencyUs(0)
+        , m_maxLatencyUs(0)
+        , m_sumLatencyUs(0)
     {
         Serial.println("[ProtocolMgr] Initialized");
     }
@@ -49,6 +163,8 @@ public:
         }
         
         m_protocols.push_back(protocol);
+        m_loadedPacks.push_back(BmsPackTable::NO_PACK);
+        addRoutes(protocol, (uint8_t)(m_protocols.size() - 1));
         
         DetectionStats stats;
         stats.protocol = protocol;
@@ -62,6 +178,13 @@ public:
     bool initializeAll() {
         Serial.println("[ProtocolMgr] Initializing all protocols...");
         
+        // initialize() verwirft die Protokolldaten, gleiche Frames müssen neu decodiert werden
+        m_payloadCache.clear();
+        m_packs.clear();
+        for (auto& loaded : m_loadedPacks) {
+            loaded = BmsPackTable::NO_PACK;
+        }
+        
         bool success = true;
         for (auto* protocol : m_protocols) {
             if (!protocol->initialize()) {
@@ -105,31 +228,44 @@ public:
             }
         }
         
-        m_activeProtocol = nullptr;
+        setActiveProtocol(nullptr);
         return success;
     }
     
+    /**
+     * @brief Auto-Detection ein- bzw. ausschalten (beliebiger Task)
+     * 
+     * Übernommen beim nächsten Frame oder Tick im Auswerte-Kontext.
+     * Ein: Scores verwerfen, aktives Protokoll lösen, neu erkennen.
+     */
     void setAutoDetect(bool enable) {
-        m_autoDetect = enable;
-        if (enable) {
-            m_activeProtocol = nullptr;
-            Serial.println("[ProtocolMgr] Auto-detection ENABLED");
-        } else {
-            Serial.println("[ProtocolMgr] Auto-detection DISABLED");
-        }
+        m_modeRequest.store(enable ? REQUEST_AUTO : REQUEST_MANUAL, std::memory_order_release);
+        Serial.printf("[ProtocolMgr] Auto-detection %s\n", enable ? "ENABLED" : "DISABLED");
     }
     
+    /**
+     * @brief Auto-Detection aktiv bzw. angefordert
+     */
     bool isAutoDetectEnabled() const {
-        return m_autoDetect;
+        int request = m_modeRequest.load(std::memory_order_acquire);
+        if (request != REQUEST_NONE) {
+            return request == REQUEST_AUTO;
+        }
+        return m_autoDetect.load(std::memory_order_relaxed);
     }
     
+    /**
+     * @brief Wählt ein Protokoll fest aus, Auto-Detection aus (beliebiger Task)
+     * 
+     * Übernommen beim nächsten Frame oder Tick im Auswerte-Kontext.
+     * @return false wenn kein Protokoll dieses Typs registriert ist
+     */
     bool selectProtocol(bms_type_t type) {
-        for (auto* protocol : m_protocols) {
-            if (protocol->getType() == type) {
-                m_activeProtocol = protocol;
-                m_autoDetect = false;
+        for (size_t i = 0; i < m_protocols.size(); i++) {
+            if (m_protocols[i]->getType() == type) {
+                m_modeRequest.store((int)i, std::memory_order_release);
                 Serial.printf("[ProtocolMgr] Manually selected: %s\n", 
-                            protocol->getName());
+                            m_protocols[i]->getName());
                 return true;
             }
         }
@@ -138,47 +274,480 @@ public:
         return false;
     }
     
-    bool routeMessage(uint32_t canId, const uint8_t* data, uint8_t length) {
-        // Wenn ein Protokoll aktiv ist und Auto-Detect aus
-        if (m_activeProtocol && !m_autoDetect) {
-            if (m_activeProtocol->canAcceptMessage(canId)) {
-                return m_activeProtocol->parseMessage(canId, data, length);
+    /**
+     * @brief Registriert Callback für Wechsel des aktiven Protokolls
+     * 
+     * Wird z.B. genutzt, um den Hardware-Filter nachzuführen
+     * (getIdFilters()).
+     */
+    void setProtocolChangeCallback(ProtocolChangeCallback callback) {
+        m_changeCallback = callback;
+    }
+    
+    /**
+     * @brief Sammelt die ID-Filter für den Hardware-Filter
+     * 
+     * Bei manueller Auswahl nur die Filter des gewählten Protokolls,
+     * mit Auto-Detection immer die aller registrierten Protokolle - auch
+     * nach dem Lock-In. Lock-In, Revalidierung und Stille ändern den
+     * Hardware-Filter so nie (jede Änderung installiert den Treiber neu,
+     * mit Empfangslücke); eingerastet verwirft dispatchMessage() fremde
+     * Frames in Software.
+     * 
+     * @param filters Ziel-Array
+     * @param maxFilters Größe des Ziel-Arrays
+     * @return Anzahl Filter, 0 = keine Einschränkung möglich
+     */
+    size_t getIdFilters(CanIdFilter* filters, size_t maxFilters) const {
+        CanProtocolBase* active = m_activeProtocol.load(std::memory_order_acquire);
+        if (active && !m_autoDetect.load(std::memory_order_relaxed)) {
+            return active->getIdFilters(filters, maxFilters);
+        }
+        
+        size_t total = 0;
+        for (auto* protocol : m_protocols) {
+            size_t count = protocol->getIdFilters(filters + total, maxFilters - total);
+            if (count == 0) {
+                // Protokoll ohne Filterangabe oder Array voll -> alles akzeptieren
+                return 0;
+            }
+            total += count;
+        }
+        return total;
+    }
+    
+    /**
+     * @brief Leitet einen Frame an das zuständige Protokoll
+     * @param frame Empfangener Frame
+     * @param updated true = Sendezyklus des Packs abgeschlossen und mit
+     *        geänderten Daten: getData() liefert einen neuen, in sich
+     *        konsistenten Stand (einmal pro Zyklus statt pro Frame)
+     * @return true wenn ein Protokoll den Frame angenommen hat
+     */
+    bool routeMessage(const CanFrame& frame, bool& updated) {
+        bool routed = dispatchMessage(frame, updated);
+        if (routed) {
+            m_routedCount++;
+            
+            uint32_t latency = (uint32_t)(esp_timer_get_time() - frame.timestampUs);
+            m_lastLatencyUs = latency;
+            m_sumLatencyUs += latency;
+            if (latency > m_maxLatencyUs) {
+                m_maxLatencyUs = latency;
             }
+        } else {
+            m_unroutedCount++;
+        }
+        return routed;
+    }
+    
+    bool routeMessage(const CanFrame& frame) {
+        bool updated;
+        return routeMessage(frame, updated);
+    }
+    
+    /**
+     * @brief Sink-Einstieg für CanDriver (ohne Rückgabewert)
+     * 
+     * Direkt bindbar: CanMessageSink::member<ProtocolManager, &ProtocolManager::handleFrame>(&mgr)
+     */
+    void handleFrame(const CanFrame& frame) {
+        routeMessage(frame);
+    }
+    
+    /**
+     * @brief Routing-Statistik
+     * @param routed Von einem Protokoll verarbeitete Frames
+     * @param unrouted Von keinem Protokoll verarbeitete Frames
+     */
+    void getRoutingStats(uint32_t& routed, uint32_t& unrouted) const {
+        routed = m_routedCount;
+        unrouted = m_unroutedCount;
+    }
+    
+    /**
+     * @brief Payload-Cache ein/aus (Default ein)
+     * 
+     * Aus: Jeder Frame wird decodiert. Für Vergleichsläufe (can_replay
+     * --no-cache), die Ausgabe muss in beiden Fällen identisch sein.
+     * @note Vor dem Start des Decode-Tasks setzen
+     */
+    void setPayloadCacheEnabled(bool enabled) {
+        m_payloadCacheEnabled = enabled;
+        m_payloadCache.clear();
+    }
+    
+    /**
+     * @brief Trefferstatistik des Payload-Caches
+     */
+    CanPayloadCacheStats getPayloadCacheStats() const {
+        return m_payloadCache.getStats();
+    }
+    
+    /**
+     * @brief Maximale Dauer eines Sendezyklus bis zur Veröffentlichung
+     * @note Vor dem Start des Decode-Tasks setzen
+     */
+    void setCycleDeadline(uint32_t deadlineMs) {
+        m_cycles.setDeadline(deadlineMs);
+    }
+    
+    CanCycleStats getCycleStats() const {
+        return m_cycles.getStats();
+    }
+    
+    /**
+     * @brief Latenz vom RX-Zeitstempel bis zum fertig geparsten Frame
+     * @param lastUs Letzter Frame
+     * @param avgUs Mittelwert
+     * @param maxUs Maximum
+     */
+    void getLatencyStats(uint32_t& lastUs, uint32_t& avgUs, uint32_t& maxUs) const {
+        lastUs = m_lastLatencyUs;
+        avgUs = m_routedCount ? (uint32_t)(m_sumLatencyUs / m_routedCount) : 0;
+        maxUs = m_maxLatencyUs;
+    }
+
+private:
+    /**
+     * @brief Ermittelt das zuständige Protokoll über (ID, IDE)
+     * @return Protokoll-Index oder CanRouteTable::NO_ROUTE
+     */
+    int resolveRoute(const CanFrame& frame) const {
+        int index = m_routes.lookup(frame);
+        if (index != CanRouteTable::NO_ROUTE) {
+            return index;
+        }
+        
+        for (uint8_t candidate : m_unfilteredProtocols) {
+            if (m_protocols[candidate]->canAcceptMessage(frame.id, frame.isExtended())) {
+                return candidate;
+            }
+        }
+        return CanRouteTable::NO_ROUTE;
+    }
+    
+    /**
+     * @brief Decodiert einen Frame, sofern sich die Nutzdaten geändert haben
+     * 
+     * Zuerst wird der Stand des sendenden Packs in das Protokoll geladen
+     * (nur bei Pack-Wechsel, auch für unveränderte Frames, damit der
+     * Protokollstand mit und ohne Cache derselbe ist), nach dem
+     * Decodieren das Ergebnis in die Pack-Tabelle übernommen. Jeder
+     * Frame, auch ein unveränderter, zählt zum Sendezyklus seines Packs;
+     * updated meldet dessen Abschluss.
+     */
+    bool decodeMessage(int index, const CanFrame& frame, bool& updated) {
+        CanProtocolBase* protocol = m_protocols[index];
+        int pack = m_packs.acquire(protocol->getType(), protocol->getNodeAddress(frame));
+        if (pack == BmsPackTable::NO_PACK) {
+            // Tabelle voll: nicht in den zuletzt geladenen Pack decodieren,
+            // Frame verwerfen (BmsPackTable::getOverflows())
             return false;
         }
+        uint32_t now = (uint32_t)(frame.timestampUs / 1000);
+        CanCycleState& cycle = m_packs.getCycle(pack);
         
-        // Auto-Detection
+        if (pack != m_loadedPacks[index]) {
+            protocol->loadPackData(m_packs.getPack(pack).data);
+            m_loadedPacks[index] = pack;
+        }
+        
+        size_t slot = CanPayloadCache::NO_SLOT;
+        if (m_payloadCacheEnabled && m_payloadCache.check(frame, slot)) {
+            protocol->refresh(frame);
+            m_packs.touch(pack, now);
+            updated = m_cycles.add(cycle, protocol->getCycleMessages(),
+                                   m_payloadCache.getMessageIndex(slot), false, now);
+            return true;
+        }
+        
+        if (!protocol->parseMessage(frame)) {
+            m_payloadCache.forget(slot);
+            return false;
+        }
+        
+        uint8_t messageIndex = protocol->getLastMessageIndex();
+        bool shared = messageIndex < 32 && (protocol->getSharedMessages() & (1u << messageIndex));
+        m_payloadCache.commit(slot, frame, messageIndex, !shared);
+        m_packs.update(pack, protocol->getPackData(), now);
+        updated = m_cycles.add(cycle, protocol->getCycleMessages(), messageIndex, true, now);
+        return true;
+    }
+    
+    // ========================================================================
+    // Auto-Detection
+    // ========================================================================
+    
+    static float decayScore(float score, uint32_t elapsedMs) {
+        if ((int32_t)elapsedMs <= 0) {
+            return score;
+        }
+        return score * exp2f(-(float)elapsedMs / SCORE_HALF_LIFE_MS);
+    }
+    
+    static float currentScore(const DetectionStats& stats, uint32_t now) {
+        return decayScore(stats.score, now - stats.scoreTime);
+    }
+    
+    static void addEvidence(DetectionStats& stats, uint32_t now, float weight) {
+        float score = currentScore(stats, now) + weight;
+        stats.score = (score > 0.0f) ? score : 0.0f;
+        stats.scoreTime = now;
+    }
+    
+    void resetScores(uint32_t now) {
+        for (auto& stats : m_detectionStats) {
+            stats.score = 0.0f;
+            stats.scoreTime = now;
+        }
+    }
+    
+    int indexOf(const CanProtocolBase* protocol) const {
         for (size_t i = 0; i < m_protocols.size(); i++) {
-            auto* protocol = m_protocols[i];
-            
-            if (protocol->canAcceptMessage(canId)) {
-                bool success = protocol->parseMessage(canId, data, length);
-                
-                if (success) {
-                    m_detectionStats[i].matchCount++;
-                    m_detectionStats[i].lastMatch = millis();
-                    
-                    if (m_detectionStats[i].matchCount >= DETECTION_THRESHOLD && !m_activeProtocol) {
-                        m_activeProtocol = protocol;
-                        Serial.printf("\n*** [ProtocolMgr] AUTO-DETECTED: %s ***\n\n", 
-                                    protocol->getName());
-                    }
-                    
-                    return true;
-                }
+            if (m_protocols[i] == protocol) {
+                return (int)i;
+            }
+        }
+        return -1;
+    }
+    
+    /**
+     * @brief Bester Kandidat und Konfidenz des Zweitbesten
+     */
+    int findBest(uint32_t now, float& bestScore, float& secondScore) const {
+        int best = -1;
+        bestScore = 0.0f;
+        secondScore = 0.0f;
+        for (size_t i = 0; i < m_detectionStats.size(); i++) {
+            float score = currentScore(m_detectionStats[i], now);
+            if (score > bestScore) {
+                secondScore = bestScore;
+                bestScore = score;
+                best = (int)i;
+            } else if (score > secondScore) {
+                secondScore = score;
             }
         }
+        return best;
+    }
+    
+    /**
+     * @brief Lock-In, wenn ein Kandidat klar vorne liegt (Hysterese)
+     */
+    void evaluateLock(uint32_t now) {
+        float bestScore, secondScore;
+        int best = findBest(now, bestScore, secondScore);
+        if (best < 0 || bestScore < LOCK_SCORE || bestScore < LOCK_MARGIN * secondScore) {
+            return;
+        }
         
-        return false;
+        BMS_LOG_INFO("\n*** [ProtocolMgr] AUTO-DETECTED: %s (confidence %.1f, next %.1f) ***\n\n", 
+                    m_protocols[best]->getName(), bestScore, secondScore);
+        m_revalidationTime = now;
+        setActiveProtocol(m_protocols[best]);
+    }
+    
+    /**
+     * @brief Übernimmt Anfragen anderer Tasks (nur Auswerte-Kontext)
+     */
+    void applyRequests(uint32_t now) {
+        if (m_resetRequested.load(std::memory_order_relaxed) &&
+            m_resetRequested.exchange(false, std::memory_order_acquire)) {
+            clearStats(now);
+        }
+        
+        if (m_modeRequest.load(std::memory_order_relaxed) == REQUEST_NONE) {
+            return;
+        }
+        int request = m_modeRequest.exchange(REQUEST_NONE, std::memory_order_acquire);
+        if (request == REQUEST_NONE) {
+            return;
+        }
+        
+        bool wasAuto = m_autoDetect.load(std::memory_order_relaxed);
+        CanProtocolBase* before = m_activeProtocol.load(std::memory_order_relaxed);
+        m_revalidating = false;
+        if (request == REQUEST_AUTO) {
+            m_autoDetect = true;
+            resetScores(now);
+            setActiveProtocol(nullptr);
+        } else {
+            m_autoDetect = false;
+            if (request >= 0 && (size_t)request < m_protocols.size()) {
+                setActiveProtocol(m_protocols[request]);
+            }
+        }
+        
+        // Filter hängt auch vom Modus ab (getIdFilters()): melden, selbst
+        // wenn das aktive Protokoll gleich geblieben ist
+        if (wasAuto != m_autoDetect.load(std::memory_order_relaxed) &&
+            before == m_activeProtocol.load(std::memory_order_relaxed) && m_changeCallback) {
+            m_changeCallback(before);
+        }
+    }
+    
+    void clearStats(uint32_t now) {
+        for (auto& stats : m_detectionStats) {
+            stats.matchCount = 0;
+            stats.errorCount = 0;
+            stats.lastMatch = 0;
+        }
+        resetScores(now);
+        m_revalidating = false;
+        
+        for (auto* protocol : m_protocols) {
+            protocol->resetStats();
+        }
+        
+        m_routedCount = 0;
+        m_unroutedCount = 0;
+        m_lastLatencyUs = 0;
+        m_maxLatencyUs = 0;
+        m_sumLatencyUs = 0;
+        m_payloadCache.resetStats();
+        m_cycles.resetStats();
+        setActiveProtocol(nullptr);
     }
     
+    bool dispatchMessage(const CanFrame& frame, bool& updated) {
+        updated = false;
+        uint32_t now = (uint32_t)(frame.timestampUs / 1000);
+        applyRequests(now);
+        
+        int index = resolveRoute(frame);
+        if (index == CanRouteTable::NO_ROUTE) {
+            return false;
+        }
+        
+        auto* protocol = m_protocols[index];
+        CanProtocolBase* active = m_activeProtocol.load(std::memory_order_relaxed);
+        
+        // Wenn ein Protokoll aktiv ist und Auto-Detect aus
+        if (active && !m_autoDetect.load(std::memory_order_relaxed)) {
+            return (protocol == active) && decodeMessage(index, frame, updated);
+        }
+        
+        // Eingerastet: schneller Pfad, nur das aktive Protokoll wird
+        // decodiert, bewertet wird nur während einer Revalidierung
+        bool locked = active && !m_revalidating.load(std::memory_order_relaxed);
+        if (locked && protocol != active) {
+            return false;
+        }
+        
+        // Auto-Detection: jeder zugeordnete Frame ist Evidenz für sein Protokoll
+        bool parsed = decodeMessage(index, frame, updated);
+        
+        DetectionStats& stats = m_detectionStats[index];
+        if (parsed) {
+            stats.matchCount++;
+            stats.lastMatch = now;
+        } else {
+            stats.errorCount++;
+        }
+        
+        if (locked) {
+            return parsed;
+        }
+        
+        addEvidence(stats, now, parsed ? 1.0f : -ERROR_PENALTY);
+        if (!active) {
+            evaluateLock(now);
+        }
+        return parsed;
+    }
+
+public:
+    
     CanProtocolBase* getActiveProtocol() const {
-        return m_activeProtocol;
+        return m_activeProtocol.load(std::memory_order_acquire);
+    }
+    
+    /**
+     * @brief Zeitgesteuerter Teil der Auto-Detection
+     * 
+     * Läuft im selben Kontext wie routeMessage(), auf dem Gerät über den
+     * Tick-Sink im CAN Decode-Task (ICanBus::setTickSink()), nie aus
+     * loop(): Pack-Tabelle und Erkennungszustand haben so einen einzigen
+     * Schreiber.
+     * 
+     * - Aktives Protokoll stumm -> Lock lösen, neu erkennen
+     * - Packs ohne Frames seit BmsPackTable::PACK_TIMEOUT_MS -> offline
+     * - Alle REVALIDATE_INTERVAL_MS: für REVALIDATE_WINDOW_MS alle
+     *   Kandidaten bewerten und nur bei deutlichem Vorsprung wechseln; der
+     *   Hardware-Filter bleibt dabei unverändert (getIdFilters())
+     */
+    void update(uint32_t now) {
+        applyRequests(now);
+        m_packs.expire(now);
+        
+        CanProtocolBase* active = m_activeProtocol.load(std::memory_order_relaxed);
+        if (!m_autoDetect || !active) {
+            return;
+        }
+        
+        int activeIndex = indexOf(active);
+        if (activeIndex < 0) {
+            return;
+        }
+        
+        uint32_t silentMs = now - m_detectionStats[activeIndex].lastMatch;
+        if ((int32_t)silentMs >= (int32_t)SILENCE_TIMEOUT_MS) {
+            BMS_LOG_INFO("[ProtocolMgr] %s silent for %lu ms, restarting detection\n",
+                         active->getName(), silentMs);
+            m_revalidating = false;
+            resetScores(now);
+            setActiveProtocol(nullptr);
+            return;
+        }
+        
+        if (!m_revalidating) {
+            if (now - m_revalidationTime >= REVALIDATE_INTERVAL_MS) {
+                // Frische Evidenz für alle, auch das aktive Protokoll wurde
+                // im schnellen Pfad nicht bewertet
+                resetScores(now);
+                m_revalidating = true;
+                m_revalidationTime = now;
+            }
+            return;
+        }
+        
+        if (now - m_revalidationTime < REVALIDATE_WINDOW_MS) {
+            return;
+        }
+        
+        float bestScore, secondScore;
+        int best = findBest(now, bestScore, secondScore);
+        float activeScore = currentScore(m_detectionStats[activeIndex], now);
+        m_revalidating = false;
+        m_revalidationTime = now;
+        
+        if (best >= 0 && best != activeIndex &&
+            bestScore >= LOCK_SCORE && bestScore >= SWITCH_MARGIN * activeScore) {
+            BMS_LOG_INFO("\n*** [ProtocolMgr] RE-DETECTED: %s (confidence %.1f) replaces %s (%.1f) ***\n\n",
+                         m_protocols[best]->getName(), bestScore,
+                         active->getName(), activeScore);
+            setActiveProtocol(m_protocols[best]);
+        }
+    }
+    
+    /**
+     * @brief Zustand der Auto-Detection als Text
+     */
+    const char* getDetectionStateName() const {
+        if (!m_autoDetect) {
+            return "MANUAL";
+        }
+        if (!m_activeProtocol.load(std::memory_order_acquire)) {
+            return "DETECTING";
+        }
+        return m_revalidating ? "REVALIDATING" : "LOCKED";
     }
     
     bool isConnected() const {
-        if (m_activeProtocol) {
-            return m_activeProtocol->isConnected();
+        CanProtocolBase* active = m_activeProtocol.load(std::memory_order_acquire);
+        if (active) {
+            return active->isConnected();
         }
         
         for (auto* protocol : m_protocols) {
@@ -190,9 +759,20 @@ public:
         return false;
     }
     
+    /**
+     * @brief Aktuelle BMS-Daten
+     * 
+     * Sind mehrere Packs des aktiven Protokolls online, wird die
+     * Bank-Sicht geliefert (siehe BmsPackTable::getBankData()).
+     */
     bool getData(bms_data_t& data) const {
-        if (m_activeProtocol) {
-            return m_activeProtocol->getData(data);
+        CanProtocolBase* active = m_activeProtocol.load(std::memory_order_relaxed);
+        if (active && m_packs.getOnlineCount() > 1) {
+            return m_packs.getBankData(data);
+        }
+        
+        if (active) {
+            return active->getData(data);
         }
         
         for (auto* protocol : m_protocols) {
@@ -204,6 +784,13 @@ public:
         return false;
     }
     
+    /**
+     * @brief Pack-Tabelle (Multi-Pack) mit Bank-Summen
+     */
+    const BmsPackTable& getPackTable() const {
+        return m_packs;
+    }
+    
     size_t getProtocolCount() const {
         return m_protocols.size();
     }
@@ -211,12 +798,41 @@ public:
     void printDetectionStats() const {
         Serial.println("\n=== Protocol Detection Stats ===");
         
+        uint32_t total = m_routedCount + m_unroutedCount;
+        Serial.printf("Routed: %lu, Unrouted: %lu (%.1f%% relevant)\n",
+                     m_routedCount, m_unroutedCount,
+                     total ? (100.0f * m_routedCount / total) : 0.0f);
+        
+        uint32_t lastUs, avgUs, maxUs;
+        getLatencyStats(lastUs, avgUs, maxUs);
+        Serial.printf("RX->Parsed latency: last %lu us, avg %lu us, max %lu us\n",
+                     lastUs, avgUs, maxUs);
+        Serial.printf("Detection: %s\n", getDetectionStateName());
+        Serial.printf("Routes: %u exact (ID, IDE), %u masked, %u unfiltered protocols\n",
+                     (unsigned)m_routes.getExactCount(), (unsigned)m_routes.getMaskCount(),
+                     (unsigned)m_unfilteredProtocols.size());
+        
+        CanPayloadCacheStats cache = m_payloadCache.getStats();
+        uint32_t lookups = cache.hits + cache.misses;
+        Serial.printf("Payload cache: %lu unchanged, %lu decoded, %lu bypassed, %lu IDs (%.1f%% decode skipped)\n",
+                     cache.hits, cache.misses, cache.bypassed, cache.entries,
+                     lookups ? (100.0f * cache.hits / lookups) : 0.0f);
+        
+        CanCycleStats cycles = m_cycles.getStats();
+        Serial.printf("Cycles: %lu complete, %lu incomplete, %lu deadline (%lu ms); %lu updates for %lu frames (%.1f frames/update)\n",
+                     cycles.complete, cycles.restarted, cycles.deadline, m_cycles.getDeadline(),
+                     cycles.published, cycles.frames,
+                     cycles.published ? (float)cycles.frames / cycles.published : 0.0f);
+        
+        uint32_t now = millis();
         for (const auto& stats : m_detectionStats) {
-            uint32_t age = (stats.lastMatch > 0) ? (millis() - stats.lastMatch) : 0;
+            uint32_t age = (stats.lastMatch > 0) ? (now - stats.lastMatch) : 0;
             
-            Serial.printf("%-20s: %4lu matches, last: %5lu ms ago %s\n",
+            Serial.printf("%-20s: %4lu matches, %4lu errors, confidence %5.1f, last: %5lu ms ago %s\n",
                          stats.protocol->getName(),
                          stats.matchCount,
+                         stats.errorCount,
+                         currentScore(stats, now),
                          age,
                          (stats.protocol == m_activeProtocol) ? "[ACTIVE]" : "");
         }
@@ -235,27 +851,22 @@ public:
             
             uint32_t msgCount, errCount;
             protocol->getStats(msgCount, errCount);
-            Serial.printf("  Messages: %lu, Errors: %lu, Age: %lu ms\n",
-                         msgCount, errCount, protocol->getDataAge());
+            Serial.printf("  Messages: %lu, Errors: %lu, Age: %lu ms, Inter-arrival: %lu us\n",
+                         msgCount, errCount, protocol->getDataAge(),
+                         protocol->getLastInterArrivalUs());
         }
         
         Serial.println("============================\n");
     }
     
+    /**
+     * @brief Setzt Statistik und Erkennung zurück (beliebiger Task)
+     * 
+     * Übernommen beim nächsten Frame oder Tick im Auswerte-Kontext.
+     */
     void resetStats() {
-        Serial.println("[ProtocolMgr] Resetting all statistics...");
-        
-        for (auto& stats : m_detectionStats) {
-            stats.matchCount = 0;
-            stats.lastMatch = 0;
-        }
-        
-        for (auto* protocol : m_protocols) {
-            protocol->resetStats();
-        }
-        
-        m_activeProtocol = nullptr;
-        Serial.println("[ProtocolMgr] Statistics reset complete");
+        m_resetRequested.store(true, std::memory_order_release);
+        Serial.println("[ProtocolMgr] Statistics reset requested");
     }
 };
 
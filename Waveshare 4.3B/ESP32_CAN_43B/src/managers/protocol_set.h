@@ -0,0 +1,275 @@
+/**
+ * @file protocol_set.h
+ * @brief Zur Compile-Zeit zusammengesetzte Protokollmenge
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * ProtocolSet<PylontechCan, JkBmsCan, DalyCan> baut aus den ROUTES der
+ * Protokolle zur Compile-Zeit eine perfekte Hash-Tabelle (Schlüssel
+ * canKey(id, extended), Multiplikator so gewählt, dass kein Slot doppelt
+ * belegt ist). Ein Frame wird mit einer Multiplikation und einem
+ * Vergleich seinem Protokoll zugeordnet und ohne virtuellen Aufruf an
+ * dessen parseMessage() übergeben. Maskierte Routen (JK BMS) werden nur
+ * bei einem Fehlgriff geprüft.
+ *
+ * Ergänzt ProtocolManager für feste Protokollkombinationen (z.B. Gateway
+ * mit bekanntem BMS); Auto-Detection und Filterwechsel bleiben dort.
+ * Benchmark: src/bench/protocol_dispatch_bench.h
+ *
+ * SPEICHERN ALS: src/managers/protocol_set.h
+ */
+
+#ifndef PROTOCOL_SET_H
+#define PROTOCOL_SET_H
+
+#include <Arduino.h>
+#include <array>
+#include <tuple>
+#include <utility>
+#include "../core/can_types.h"
+
+namespace protocol_set_detail {
+
+static constexpr uint32_t KEY_EMPTY = 0xFFFFFFFF;   ///< Kein gültiger canKey()
+static constexpr uint32_t HASH_SEED = 2654435761u;  ///< Knuth, wie CanRouteTable
+static constexpr uint32_t MAX_HASH_ATTEMPTS = 4096;
+
+struct Route {
+    uint32_t key;
+    uint8_t handler;
+};
+
+struct MaskRoute {
+    CanIdFilter filter;
+    uint8_t handler;
+};
+
+template <size_t N>
+constexpr size_t countRoutes(const CanIdFilter (&routes)[N], bool exact) {
+    size_t count = 0;
+    for (size_t i = 0; i < N; i++) {
+        if (routes[i].isExact() == exact) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Exakte und maskierte Routen aller Protokolle
+ */
+template <size_t EXACT, size_t MASKED>
+struct RouteLists {
+    std::array<Route, EXACT> exact;
+    std::array<MaskRoute, MASKED> masked;
+    size_t exactCount;
+    size_t maskedCount;
+
+    template <size_t N>
+    constexpr void add(const CanIdFilter (&routes)[N], uint8_t handler) {
+        for (size_t i = 0; i < N; i++) {
+            if (routes[i].isExact()) {
+                exact[exactCount++] = {canKey(routes[i].id, routes[i].extended), handler};
+            } else {
+                masked[maskedCount++] = {routes[i], handler};
+            }
+        }
+    }
+
+    constexpr bool hasDuplicates() const {
+        for (size_t i = 0; i < EXACT; i++) {
+            for (size_t j = i + 1; j < EXACT; j++) {
+                if (exact[i].key == exact[j].key) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+};
+
+template <size_t EXACT, size_t MASKED, size_t... I, typename... Protocols>
+constexpr RouteLists<EXACT, MASKED> buildLists(std::index_sequence<I...>, const Protocols*...) {
+    RouteLists<EXACT, MASKED> lists{};
+    (lists.add(Protocols::ROUTES, (uint8_t)I), ...);
+    return lists;
+}
+
+/**
+ * @brief Kleinste Zweierpotenz-Bitbreite mit mindestens 4 Slots pro Schlüssel
+ */
+constexpr uint32_t tableBits(size_t keys) {
+    uint32_t bits = 2;
+    while (((size_t)1 << bits) < keys * 4) {
+        bits++;
+    }
+    return bits;
+}
+
+template <uint32_t BITS>
+constexpr uint32_t hashKey(uint32_t key, uint32_t multiplier) {
+    return (key * multiplier) >> (32 - BITS);
+}
+
+template <uint32_t BITS>
+struct HashTable {
+    uint32_t multiplier;            ///< 0 = keine kollisionsfreie Funktion gefunden
+    std::array<Route, (size_t)1 << BITS> slots;
+};
+
+/**
+ * @brief Sucht einen Multiplikator ohne Kollisionen (perfekter Hash)
+ */
+template <uint32_t BITS, size_t EXACT>
+constexpr HashTable<BITS> buildHash(const std::array<Route, EXACT>& routes) {
+    HashTable<BITS> table{};
+    for (uint32_t attempt = 0; attempt < MAX_HASH_ATTEMPTS; attempt++) {
+        uint32_t multiplier = HASH_SEED + 2 * attempt;     // ungerade
+        for (size_t i = 0; i < table.slots.size(); i++) {
+            table.slots[i] = {KEY_EMPTY, 0};
+        }
+
+        bool collision = false;
+        for (size_t i = 0; i < EXACT && !collision; i++) {
+            Route& slot = table.slots[hashKey<BITS>(routes[i].key, multiplier)];
+            if (slot.key != KEY_EMPTY) {
+                collision = true;
+            } else {
+                slot = routes[i];
+            }
+        }
+
+        if (!collision) {
+            table.multiplier = multiplier;
+            return table;
+        }
+    }
+    table.multiplier = 0;
+    return table;
+}
+
+} // namespace protocol_set_detail
+
+/**
+ * @brief Protokollmenge mit statischer ID -> Decoder Tabelle
+ *
+ * Jedes Protokoll braucht static constexpr CanIdFilter ROUTES[].
+ * Die Protokoll-Objekte gehören dem Aufrufer (Referenzen).
+ */
+template <typename... Protocols>
+class ProtocolSet {
+public:
+    static constexpr size_t PROTOCOL_COUNT = sizeof...(Protocols);
+    static constexpr int NO_ROUTE = -1;
+
+    static_assert(PROTOCOL_COUNT > 0, "ProtocolSet braucht mindestens ein Protokoll");
+    static_assert(PROTOCOL_COUNT <= 255, "Handler-Index ist 8 Bit");
+
+private:
+    using Route = protocol_set_detail::Route;
+    using MaskRoute = protocol_set_detail::MaskRoute;
+
+    static constexpr size_t EXACT_COUNT =
+        (protocol_set_detail::countRoutes(Protocols::ROUTES, true) + ...);
+    static constexpr size_t MASK_COUNT =
+        (protocol_set_detail::countRoutes(Protocols::ROUTES, false) + ...);
+    static constexpr uint32_t TABLE_BITS = protocol_set_detail::tableBits(EXACT_COUNT);
+
+    static constexpr protocol_set_detail::RouteLists<EXACT_COUNT, MASK_COUNT> LISTS =
+        protocol_set_detail::buildLists<EXACT_COUNT, MASK_COUNT>(
+            std::index_sequence_for<Protocols...>{}, (const Protocols*)nullptr...);
+
+    static_assert(!LISTS.hasDuplicates(), "CAN-ID in mehreren Protokollen deklariert");
+
+    static constexpr protocol_set_detail::HashTable<TABLE_BITS> TABLE =
+        protocol_set_detail::buildHash<TABLE_BITS>(LISTS.exact);
+
+    static_assert(TABLE.multiplier != 0, "Kein kollisionsfreier Hash gefunden");
+
+    std::tuple<Protocols&...> m_protocols;
+
+    template <size_t I>
+    bool decode(const CanFrame& frame) {
+        using Protocol = std::tuple_element_t<I, std::tuple<Protocols...>>;
+        // Qualifizierter Aufruf: statisch gebunden, kein vtable-Zugriff
+        return std::get<I>(m_protocols).Protocol::parseMessage(frame);
+    }
+
+    template <size_t... I>
+    bool decodeAt(int handler, const CanFrame& frame, std::index_sequence<I...>) {
+        bool parsed = false;
+        (void)((handler == (int)I && ((parsed = decode<I>(frame)), true)) || ...);
+        return parsed;
+    }
+
+public:
+    explicit ProtocolSet(Protocols&... protocols)
+        : m_protocols(protocols...)
+    {
+    }
+
+    /**
+     * @brief Ermittelt den Protokoll-Index eines Frames
+     * @return Index in der Template-Parameterliste oder NO_ROUTE
+     */
+    static int route(uint32_t canId, bool extended) {
+        uint32_t key = canKey(canId, extended);
+        const Route& slot = TABLE.slots[protocol_set_detail::hashKey<TABLE_BITS>(key, TABLE.multiplier)];
+        if (slot.key == key) {
+            return slot.handler;
+        }
+
+        for (const MaskRoute& masked : LISTS.masked) {
+            if (masked.filter.matches(canId, extended)) {
+                return masked.handler;
+            }
+        }
+        return NO_ROUTE;
+    }
+
+    static int route(const CanFrame& frame) {
+        return route(frame.id, frame.isExtended());
+    }
+
+    /**
+     * @brief Übergibt den Frame direkt an den Decoder seines Protokolls
+     * @return true wenn ein Protokoll den Frame erfolgreich decodiert hat
+     */
+    bool dispatch(const CanFrame& frame) {
+        int handler = route(frame);
+        if (handler == NO_ROUTE) {
+            return false;
+        }
+        return decodeAt(handler, frame, std::index_sequence_for<Protocols...>{});
+    }
+
+    template <size_t I>
+    auto& get() {
+        return std::get<I>(m_protocols);
+    }
+
+    /**
+     * @brief Alle Routen als Hardware-Filter
+     */
+    static size_t getIdFilters(CanIdFilter* filters, size_t maxFilters) {
+        size_t count = 0;
+        for (size_t i = 0; i < EXACT_COUNT && count < maxFilters; i++) {
+            uint32_t key = LISTS.exact[i].key;
+            bool extended = (key & CAN_KEY_EXTENDED) != 0;
+            filters[count++] = {key & CAN_EXT_ID_MASK,
+                                extended ? CAN_EXT_ID_MASK : CAN_STD_ID_MASK,
+                                extended};
+        }
+        for (size_t i = 0; i < MASK_COUNT && count < maxFilters; i++) {
+            filters[count++] = LISTS.masked[i].filter;
+        }
+        return count;
+    }
+
+    static constexpr size_t getExactCount() { return EXACT_COUNT; }
+    static constexpr size_t getMaskCount() { return MASK_COUNT; }
+    static constexpr size_t getTableSize() { return (size_t)1 << TABLE_BITS; }
+    static constexpr uint32_t getHashMultiplier() { return TABLE.multiplier; }
+};
+
+#endif // PROTOCOL_SET_H
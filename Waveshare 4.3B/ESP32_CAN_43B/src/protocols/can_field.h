@@ -0,0 +1,164 @@
+/**
+ * @file can_field.h
+ * @brief Zur Compile-Zeit spezialisierte Feld-Extraktion aus CAN-Nutzdaten
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Die Nutzdaten werden einmal als 64-Bit Wort geladen (CanPayload), ein
+ * Feld ist dann nur noch Shift und Maske bzw. Vorzeichenerweiterung.
+ * Byte-Reihenfolge, Position, Breite und Vorzeichen sind Template-
+ * Parameter, es bleibt kein Laufzeit-Vergleich übrig:
+ *
+ *   CanPayload payload = CanPayload::load(frame);
+ *   uint16_t voltage = BeU16<0>::get(payload);        // Bytes 0..1, Motorola
+ *   int16_t current = LeI16<2>::get(payload);         // Bytes 2..3, Intel
+ *   uint8_t flags = CanField<SIGNAL_BIG_ENDIAN, 1, 4, false, 4>::get(payload);
+ *
+ * Big-Endian Felder lesen aus payload.big() (ein bswap64 pro Frame, der
+ * Compiler fasst mehrere Aufrufe zusammen). Für ein einzelnes Feld ohne
+ * CanPayload gibt es get(data): ein Load in Feldbreite plus bswap16/32.
+ *
+ * Benchmark gegen extractUint16/32: src/bench/field_extract_bench.h
+ *
+ * SPEICHERN ALS: src/protocols/can_field.h
+ */
+
+#ifndef CAN_FIELD_H
+#define CAN_FIELD_H
+
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include "../core/can_types.h"
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#error "CanPayload/CanField erwarten eine Little-Endian CPU (ESP32, x86)"
+#endif
+
+/**
+ * @brief Byte-Reihenfolge (DBC: Intel = 1, Motorola = 0)
+ */
+enum CanByteOrder : uint8_t {
+    SIGNAL_LITTLE_ENDIAN = 0,
+    SIGNAL_BIG_ENDIAN
+};
+
+/**
+ * @brief Nutzdaten eines Frames als ein 64-Bit Wort
+ */
+struct CanPayload {
+    uint64_t little;                ///< Byte 0 = Bits 0..7, fehlende Bytes 0
+
+    /**
+     * @brief Lädt die Nutzdaten, Bytes hinter dem DLC sind 0
+     */
+    static CanPayload load(const CanFrame& frame) {
+        CanPayload payload = {0};
+        memcpy(&payload.little, frame.data, frame.length <= 8 ? frame.length : 8);
+        return payload;
+    }
+
+    /**
+     * @brief Lädt 8 Bytes ab data (ein 64-Bit Load)
+     */
+    static CanPayload load(const uint8_t* data) {
+        CanPayload payload;
+        memcpy(&payload.little, data, 8);
+        return payload;
+    }
+
+    /**
+     * @brief Dieselben Daten als Big-Endian Wort (Byte 0 = Bits 56..63)
+     */
+    uint64_t big() const {
+        return __builtin_bswap64(little);
+    }
+};
+
+/**
+ * @brief Ein Feld fester Position
+ * @tparam Order Byte-Reihenfolge
+ * @tparam StartByte Erstes Byte in Übertragungsreihenfolge
+ * @tparam BitLength 1..32
+ * @tparam Signed Zweierkomplement
+ * @tparam BitOffset Ab dem niederwertigsten Bit des Feldes (ganze Bytes: 0)
+ *
+ * Dieselbe Positionsangabe wie CanSignal, ein Eintrag einer Signaltabelle
+ * lässt sich also 1:1 übernehmen.
+ */
+template <CanByteOrder Order, uint8_t StartByte, uint8_t BitLength, bool Signed = false, uint8_t BitOffset = 0>
+struct CanField {
+    static_assert(BitLength >= 1 && BitLength <= 32, "CanField: 1..32 Bit");
+    static_assert(StartByte * 8 + BitOffset + BitLength <= 64, "CanField: Feld endet hinter Byte 7");
+
+    using unsigned_type = typename std::conditional<(BitLength <= 8), uint8_t,
+                          typename std::conditional<(BitLength <= 16), uint16_t, uint32_t>::type>::type;
+    using value_type = typename std::conditional<Signed, typename std::make_signed<unsigned_type>::type,
+                                                 unsigned_type>::type;
+
+    static constexpr uint8_t BYTES = (BitOffset + BitLength + 7) / 8;
+    static constexpr uint8_t SHIFT = Order == SIGNAL_LITTLE_ENDIAN
+                                   ? StartByte * 8 + BitOffset
+                                   : 64 - (StartByte + BYTES) * 8 + BitOffset;
+
+    /**
+     * @brief Feld aus einem geladenen Wort (little bzw. big passend zu Order)
+     */
+    static value_type fromWord(uint64_t word) {
+        word >>= SHIFT;
+        if (BitLength == sizeof(unsigned_type) * 8) {
+            // Volle Breite: Schmaler Cast genügt (auch für das Vorzeichen)
+            return (value_type)(unsigned_type)word;
+        }
+        if (Signed) {
+            return (value_type)((int64_t)(word << (64 - BitLength)) >> (64 - BitLength));
+        }
+        return (value_type)(word & ((1ull << BitLength) - 1));
+    }
+
+    static value_type get(const CanPayload& payload) {
+        return fromWord(Order == SIGNAL_LITTLE_ENDIAN ? payload.little : payload.big());
+    }
+
+    /**
+     * @brief Feld direkt aus den Nutzdaten (nur für einzelne Felder)
+     *
+     * Byte-ausgerichtete 8/16/32 Bit: ein Load in Feldbreite plus bswap,
+     * sonst 64-Bit Load wie über CanPayload.
+     */
+    static value_type get(const uint8_t* data) {
+        if (BitOffset == 0 && BitLength == sizeof(unsigned_type) * 8) {
+            unsigned_type raw;
+            memcpy(&raw, data + StartByte, sizeof(raw));
+            if (Order == SIGNAL_BIG_ENDIAN) {
+                raw = swap(raw);
+            }
+            return (value_type)raw;
+        }
+        return get(CanPayload::load(data));
+    }
+
+private:
+    static uint8_t swap(uint8_t value) { return value; }
+    static uint16_t swap(uint16_t value) { return __builtin_bswap16(value); }
+    static uint32_t swap(uint32_t value) { return __builtin_bswap32(value); }
+};
+
+// ============================================================================
+// Kurzformen für ganze Bytes
+// ============================================================================
+
+template <uint8_t StartByte> using CanU8 = CanField<SIGNAL_LITTLE_ENDIAN, StartByte, 8>;
+template <uint8_t StartByte> using CanI8 = CanField<SIGNAL_LITTLE_ENDIAN, StartByte, 8, true>;
+
+template <uint8_t StartByte> using BeU16 = CanField<SIGNAL_BIG_ENDIAN, StartByte, 16>;
+template <uint8_t StartByte> using BeI16 = CanField<SIGNAL_BIG_ENDIAN, StartByte, 16, true>;
+template <uint8_t StartByte> using BeU32 = CanField<SIGNAL_BIG_ENDIAN, StartByte, 32>;
+template <uint8_t StartByte> using BeI32 = CanField<SIGNAL_BIG_ENDIAN, StartByte, 32, true>;
+
+template <uint8_t StartByte> using LeU16 = CanField<SIGNAL_LITTLE_ENDIAN, StartByte, 16>;
+template <uint8_t StartByte> using LeI16 = CanField<SIGNAL_LITTLE_ENDIAN, StartByte, 16, true>;
+template <uint8_t StartByte> using LeU32 = CanField<SIGNAL_LITTLE_ENDIAN, StartByte, 32>;
+template <uint8_t StartByte> using LeI32 = CanField<SIGNAL_LITTLE_ENDIAN, StartByte, 32, true>;
+
+#endif // CAN_FIELD_H
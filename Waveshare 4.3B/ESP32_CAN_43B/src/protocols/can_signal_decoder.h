@@ -0,0 +1,379 @@
+/**
+ * @file can_signal_decoder.h
+ * @brief Tabellengesteuerter Decoder für CAN-Signale
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Ein Protokoll beschreibt seine Nachrichten als constexpr-Tabellen
+ * (CanMessageDef mit CanSignal-Liste): Byte-/Bit-Position, Länge,
+ * Byte-Reihenfolge, Vorzeichen, Faktor, Offset, gültiger Bereich und
+ * Zielfeld in bms_data_t. Ein neues Protokoll ist damit nur noch Daten.
+ *
+ * Ablauf pro Frame:
+ *   - Nachricht über (ID & Maske, IDE) suchen
+ *   - Nutzdaten einmal als 64-Bit Wort laden (Big-Endian: einmal bswap)
+ *   - alle Signale in einem Durchlauf extrahieren, skalieren, prüfen
+ *   - nur wenn alle Signale gültig sind, in bms_data_t übernehmen
+ *
+ * Abgeleitete Werte (charging/discharging aus dem Strom, status_text aus
+ * Alarm/Status/Zyklen) setzt der Decoder einheitlich.
+ * Benchmark gegen die früheren switch-Parser: src/bench/signal_decode_bench.h
+ *
+ * SPEICHERN ALS: src/protocols/can_signal_decoder.h
+ */
+
+#ifndef CAN_SIGNAL_DECODER_H
+#define CAN_SIGNAL_DECODER_H
+
+#include <Arduino.h>
+#include "../core/bms_data_types.h"
+#include "../core/can_types.h"
+#include "can_field.h"
+
+/**
+ * @brief Zielfeld eines Signals
+ */
+enum CanSignalTarget : uint8_t {
+    SIGNAL_NONE = 0,        ///< Nur protokollieren
+    SIGNAL_VOLTAGE,         ///< bms_data_t::voltage
+    SIGNAL_CURRENT,         ///< bms_data_t::current (+ charging/discharging)
+    SIGNAL_SOC,             ///< bms_data_t::soc
+    SIGNAL_TEMPERATURE,     ///< bms_data_t::temperature
+    SIGNAL_CYCLES,          ///< bms_data_t::cycles (status_text)
+    SIGNAL_STATUS,          ///< Statuscode (status_text)
+    SIGNAL_ALARM            ///< Alarm-Flags, != 0 = Alarm (status_text)
+};
+
+static constexpr float SIGNAL_UNCHECKED_MIN = 1.0f;    ///< Mit SIGNAL_UNCHECKED_MAX: ohne Bereichsprüfung
+static constexpr float SIGNAL_UNCHECKED_MAX = 0.0f;
+
+/**
+ * @brief Ein Signal innerhalb einer Nachricht
+ *
+ * Position: startByte ist das erste Byte des Signals in Übertragungs-
+ * reihenfolge, bitOffset zählt ab dem niederwertigsten Bit des Signals
+ * (bei ganzen Bytes 0).
+ */
+struct CanSignal {
+    const char* name;
+    const char* unit;
+    uint8_t startByte;
+    uint8_t bitOffset;
+    uint8_t bitLength;              ///< 1..32 (validMessageTable())
+    CanByteOrder byteOrder;
+    bool isSigned;
+    float scale;
+    float offset;
+    float minValue;                 ///< minValue > maxValue = ohne Bereichsprüfung
+    float maxValue;
+    CanSignalTarget target;
+};
+
+/**
+ * @brief Eine Nachricht: ID-Muster und ihre Signale
+ */
+struct CanMessageDef {
+    uint32_t id;
+    uint32_t mask;                  ///< Relevante ID-Bits (z.B. ohne Quelladresse)
+    bool extended;
+    uint8_t minLength;              ///< Kürzere Frames sind Fehler
+    const CanSignal* signals;
+    uint8_t signalCount;            ///< 0 = Nachricht wird nur angenommen
+};
+
+/**
+ * @brief Nachricht mit Signalliste (Anzahl aus der Array-Größe)
+ */
+template <size_t N>
+constexpr CanMessageDef canMessage(uint32_t id, uint32_t mask, bool extended, uint8_t minLength,
+                                   const CanSignal (&signals)[N]) {
+    return {id, mask, extended, minLength, signals, (uint8_t)N};
+}
+
+/**
+ * @brief Nachricht ohne Signale (wird nur angenommen)
+ */
+constexpr CanMessageDef canMessage(uint32_t id, uint32_t mask, bool extended, uint8_t minLength) {
+    return {id, mask, extended, minLength, nullptr, 0};
+}
+
+/**
+ * @brief Bit eines Zielfelds im Rückgabewert von decode()
+ */
+static constexpr uint32_t signalBit(CanSignalTarget target) {
+    return 1u << target;
+}
+
+/**
+ * @brief Nachrichten, die mindestens eines der Zielfelder liefern
+ * @param fields Zielfelder (signalBit())
+ * @return Bit i = messages[i] (höchstens 32 Nachrichten)
+ */
+template <size_t N>
+constexpr uint32_t messageMaskFor(const CanMessageDef (&messages)[N], uint32_t fields) {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < N && i < 32; i++) {
+        for (size_t s = 0; s < messages[i].signalCount; s++) {
+            if (fields & signalBit(messages[i].signals[s].target)) {
+                mask |= 1u << i;
+            }
+        }
+    }
+    return mask;
+}
+
+/**
+ * @brief Zielfelder, die eine Nachricht in bms_data_t schreibt
+ *
+ * Cycles, Status und Alarm landen gemeinsam in status_text und zählen
+ * daher als ein Feld.
+ */
+constexpr uint32_t messageFields(const CanMessageDef& message) {
+    constexpr uint32_t STATUS_TEXT = (1u << SIGNAL_CYCLES) | (1u << SIGNAL_STATUS) | (1u << SIGNAL_ALARM);
+    uint32_t fields = 0;
+    for (size_t s = 0; s < message.signalCount; s++) {
+        if (message.signals[s].target != SIGNAL_NONE) {
+            fields |= 1u << message.signals[s].target;
+        }
+    }
+    return (fields & STATUS_TEXT) ? (fields | STATUS_TEXT) : fields;
+}
+
+/**
+ * @brief Nachrichten, die ein Zielfeld mit einer anderen Nachricht teilen
+ *
+ * Eine solche Nachricht überschreibt, was die andere geschrieben hat
+ * (z.B. Pylontech 0x35A und 0x35E beide status_text); sie muss auch bei
+ * unveränderten Nutzdaten decodiert werden (Payload-Cache).
+ * @return Bit i = messages[i] (höchstens 32 Nachrichten)
+ */
+template <size_t N>
+constexpr uint32_t sharedMessageMask(const CanMessageDef (&messages)[N]) {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < N && i < 32; i++) {
+        for (size_t j = 0; j < N; j++) {
+            if (i != j && (messageFields(messages[i]) & messageFields(messages[j]))) {
+                mask |= 1u << i;
+            }
+        }
+    }
+    return mask;
+}
+
+class CanSignalDecoder {
+public:
+    static constexpr size_t MAX_SIGNALS = 16;   ///< Signale pro Nachricht
+
+    /**
+     * @brief Ergebnis von decode()
+     */
+    enum Result : uint8_t {
+        DECODE_OK = 0,
+        DECODE_TOO_SHORT,           ///< DLC kleiner als minLength
+        DECODE_OUT_OF_RANGE         ///< Mindestens ein Signal außerhalb des Bereichs
+    };
+
+    /**
+     * @brief Sucht die Nachricht zu einem Frame
+     * @return Definition oder nullptr
+     */
+    template <size_t N>
+    static const CanMessageDef* find(const CanMessageDef (&messages)[N], const CanFrame& frame) {
+        bool extended = frame.isExtended();
+        for (size_t i = 0; i < N; i++) {
+            const CanMessageDef& message = messages[i];
+            if (message.extended == extended && ((frame.id ^ message.id) & message.mask) == 0) {
+                return &message;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Rohwert eines Signals aus den geladenen Nutzdaten
+     * @param little Nutzdaten als Little-Endian Wort (Byte 0 = Bits 0..7)
+     * @param big Nutzdaten als Big-Endian Wort (Byte 0 = Bits 56..63)
+     */
+    static int64_t extractRaw(const CanSignal& signal, uint64_t little, uint64_t big) {
+        uint64_t raw;
+        if (signal.byteOrder == SIGNAL_LITTLE_ENDIAN) {
+            raw = little >> (signal.startByte * 8 + signal.bitOffset);
+        } else {
+            uint32_t bytes = (signal.bitOffset + signal.bitLength + 7) / 8;
+            raw = big >> (64 - (signal.startByte + bytes) * 8 + signal.bitOffset);
+        }
+
+        uint32_t unused = 64 - signal.bitLength;
+        if (signal.isSigned) {
+            return (int64_t)(raw << unused) >> unused;
+        }
+        return (int64_t)((raw << unused) >> unused);
+    }
+
+    /**
+     * @brief Physikalischer Wert eines Signals (Faktor und Offset)
+     */
+    static float extractValue(const CanSignal& signal, uint64_t little, uint64_t big) {
+        return (float)extractRaw(signal, little, big) * signal.scale + signal.offset;
+    }
+
+    /**
+     * @brief Decodiert alle Signale eines Frames nach data
+     * @param message Nachricht aus find()
+     * @param frame Empfangener Frame
+     * @param data Ziel, wird nur bei DECODE_OK verändert
+     * @param values Optional: physikalische Werte je Signal (für Ausgaben)
+     * @param fields Optional: gesetzte Zielfelder (signalBit())
+     */
+    static Result decode(const CanMessageDef& message, const CanFrame& frame, bms_data_t& data,
+                         float* values = nullptr, uint32_t* fields = nullptr) {
+        if (frame.length < message.minLength) {
+            return DECODE_TOO_SHORT;
+        }
+
+        CanPayload payload = CanPayload::load(frame);
+        uint64_t little = payload.little;
+        uint64_t big = payload.big();
+
+        float scratch[MAX_SIGNALS];
+        if (!values) {
+            values = scratch;
+        }
+
+        size_t count = message.signalCount <= MAX_SIGNALS ? message.signalCount : MAX_SIGNALS;
+        for (size_t i = 0; i < count; i++) {
+            const CanSignal& signal = message.signals[i];
+            float value = extractValue(signal, little, big);
+            if (signal.minValue <= signal.maxValue &&
+                (value < signal.minValue || value > signal.maxValue)) {
+                return DECODE_OUT_OF_RANGE;
+            }
+            values[i] = value;
+        }
+
+        uint32_t written = 0;
+        uint32_t alarm = 0;
+        uint32_t status = 0;
+        for (size_t i = 0; i < count; i++) {
+            float value = values[i];
+            switch (message.signals[i].target) {
+                case SIGNAL_VOLTAGE:
+                    data.voltage = value;
+                    break;
+                case SIGNAL_CURRENT:
+                    data.current = value;
+                    data.charging = (value > 0.5f);
+                    data.discharging = (value < -0.5f);
+                    break;
+                case SIGNAL_SOC:
+                    data.soc = value;
+                    break;
+                case SIGNAL_TEMPERATURE:
+                    data.temperature = value;
+                    break;
+                case SIGNAL_CYCLES:
+                    data.cycles = (uint16_t)value;
+                    break;
+                case SIGNAL_STATUS:
+                    status = (uint32_t)value;
+                    break;
+                case SIGNAL_ALARM:
+                    alarm = (uint32_t)value;
+                    break;
+                case SIGNAL_NONE:
+                default:
+                    break;
+            }
+            written |= signalBit(message.signals[i].target);
+        }
+
+        if (written & (signalBit(SIGNAL_CYCLES) | signalBit(SIGNAL_STATUS) | signalBit(SIGNAL_ALARM))) {
+            formatStatus(data, written, status, alarm);
+        }
+
+        if (fields) {
+            *fields = written & ~signalBit(SIGNAL_NONE);
+        }
+        return DECODE_OK;
+    }
+
+    /**
+     * @brief Nachkommastellen für Ausgaben aus dem Faktor
+     */
+    static int decimals(const CanSignal& signal) {
+        if (signal.scale >= 1.0f) {
+            return 0;
+        }
+        return signal.scale >= 0.1f ? 1 : 2;
+    }
+
+private:
+    /**
+     * @brief status_text: "Online" bzw. "ALARM 0x..", dann Status und Zyklen
+     */
+    static void formatStatus(bms_data_t& data, uint32_t written, uint32_t status, uint32_t alarm) {
+        char* text = data.status_text;
+        size_t size = sizeof(data.status_text);
+        int length;
+
+        if (alarm != 0) {
+            length = snprintf(text, size, "ALARM 0x%02lX", (unsigned long)alarm);
+        } else {
+            length = snprintf(text, size, "Online");
+        }
+        if ((written & signalBit(SIGNAL_STATUS)) && length > 0 && (size_t)length < size) {
+            length += snprintf(text + length, size - length, " - Status: 0x%02lX", (unsigned long)status);
+        }
+        if ((written & signalBit(SIGNAL_CYCLES)) && length > 0 && (size_t)length < size) {
+            snprintf(text + length, size - length, " - %u Zyklen", data.cycles);
+        }
+    }
+};
+
+/**
+ * @brief Byte hinter dem letzten Byte eines Signals (Nutzdaten-Länge,
+ *        die das Signal mindestens braucht)
+ */
+constexpr uint32_t signalEndByte(const CanSignal& signal) {
+    return signal.byteOrder == SIGNAL_LITTLE_ENDIAN
+        ? (signal.startByte * 8u + signal.bitOffset + signal.bitLength + 7u) / 8u
+        : signal.startByte + (signal.bitOffset + signal.bitLength + 7u) / 8u;
+}
+
+/**
+ * @brief Signal mit 1..32 Bit, vollständig in den ersten length Bytes
+ *
+ * extractRaw() schiebt um 64 - bitLength bzw. um die Position im
+ * 64-Bit Wort - außerhalb dieser Grenzen wäre das undefiniert.
+ */
+constexpr bool validSignal(const CanSignal& signal, uint8_t length) {
+    return signal.bitLength >= 1 && signal.bitLength <= 32 &&
+           signalEndByte(signal) <= 8 && signalEndByte(signal) <= length;
+}
+
+/**
+ * @brief Prüft eine Nachrichtentabelle zur Compile-Zeit
+ *
+ * Jede Tabelle (auch die generierten) wird damit per static_assert
+ * geprüft: höchstens 32 Nachrichten (Bitmasken), höchstens MAX_SIGNALS
+ * Signale je Nachricht, jedes Signal innerhalb von minLength.
+ */
+template <size_t N>
+constexpr bool validMessageTable(const CanMessageDef (&messages)[N]) {
+    if (N > 32) {
+        return false;
+    }
+    for (size_t i = 0; i < N; i++) {
+        if (messages[i].minLength > 8 || messages[i].signalCount > CanSignalDecoder::MAX_SIGNALS) {
+            return false;
+        }
+        for (size_t s = 0; s < messages[i].signalCount; s++) {
+            if (!validSignal(messages[i].signals[s], messages[i].minLength)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+#endif // CAN_SIGNAL_DECODER_H
@@ -13,14 +13,66 @@
 
 class DalyCan : public CanProtocolBase {
 private:
-    static constexpr uint32_t ID_VOLTAGE = 0x18FF50E5;
-    static constexpr uint32_t ID_CURRENT = 0x18FF51E5;
-    static constexpr uint32_t ID_SOC     = 0x18FF52E5;
-    static constexpr uint32_t ID_TEMP    = 0x18FF53E5;
-    static constexpr uint32_t ID_STATUS  = 0x18FF54E5;
-    static constexpr uint32_t ID_CELLS   = 0x18FF55E5;
+    // J1939-Aufbau: Priorität 6, PGN 0xFF50..0xFF56, Quelladresse im
+    // untersten Byte (Pack-Adresse, Werkseinstellung 0xE5)
+    static constexpr uint32_t ID_VOLTAGE = 0x18FF5000;
+    static constexpr uint32_t ID_CURRENT = 0x18FF5100;
+    static constexpr uint32_t ID_SOC     = 0x18FF5200;
+    static constexpr uint32_t ID_TEMP    = 0x18FF5300;
+    static constexpr uint32_t ID_STATUS  = 0x18FF5400;
+    static constexpr uint32_t ID_CELLS   = 0x18FF5500;
+    static constexpr uint32_t ID_CELL_TEMPS = 0x18FF5600;
+    
+    static constexpr uint32_t ID_PGN_MASK    = 0x1FFFFF00;
+    static constexpr uint32_t ID_SOURCE_MASK = 0x000000FF;
+    
+    // Zellframes: Byte 0 = Framenummer ab 1, danach die Werte der Gruppe
+    static constexpr uint8_t CELLS_PER_FRAME = 3;       // Bytes 1..6, uint16 mV (LE)
+    static constexpr uint8_t TEMPS_PER_FRAME = 7;       // Bytes 1..7, uint8 °C + 40
+    static constexpr int16_t TEMP_OFFSET_C = 40;
+    
+    // Signaltabellen (Little-Endian!)
+    static constexpr CanSignal SIG_VOLTAGE[] = {
+        {"Voltage", "V", 0, 0, 16, SIGNAL_LITTLE_ENDIAN, false, 0.1f, 0.0f, 40.0f, 60.0f, SIGNAL_VOLTAGE}
+    };
+    static constexpr CanSignal SIG_CURRENT[] = {
+        {"Current", "A", 0, 0, 16, SIGNAL_LITTLE_ENDIAN, true, 0.1f, 0.0f,
+         SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_CURRENT}
+    };
+    static constexpr CanSignal SIG_SOC[] = {
+        {"SOC", "%", 0, 0, 16, SIGNAL_LITTLE_ENDIAN, false, 0.1f, 0.0f, 0.0f, 100.0f, SIGNAL_SOC}
+    };
+    static constexpr CanSignal SIG_TEMP[] = {
+        {"Temperature", "°C", 0, 0, 16, SIGNAL_LITTLE_ENDIAN, true, 0.1f, 0.0f, -20.0f, 60.0f, SIGNAL_TEMPERATURE}
+    };
+    static constexpr CanSignal SIG_STATUS[] = {
+        {"Status", "", 0, 0, 8, SIGNAL_LITTLE_ENDIAN, false, 1.0f, 0.0f,
+         SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE},
+        {"Alarm", "", 1, 0, 8, SIGNAL_LITTLE_ENDIAN, false, 1.0f, 0.0f,
+         SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_ALARM},
+        {"Cycles", "", 4, 0, 16, SIGNAL_LITTLE_ENDIAN, false, 1.0f, 0.0f,
+         SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_CYCLES}
+    };
     
 public:
+    // Nachrichtentabelle (CanSignalDecoder), Zuordnung über die PGN ohne Quelladresse
+    static constexpr CanMessageDef MESSAGES[] = {
+        canMessage(ID_VOLTAGE, ID_PGN_MASK, true, 8, SIG_VOLTAGE),
+        canMessage(ID_CURRENT, ID_PGN_MASK, true, 8, SIG_CURRENT),
+        canMessage(ID_SOC,     ID_PGN_MASK, true, 8, SIG_SOC),
+        canMessage(ID_TEMP,    ID_PGN_MASK, true, 8, SIG_TEMP),
+        canMessage(ID_STATUS,  ID_PGN_MASK, true, 8, SIG_STATUS),
+        canMessage(ID_CELLS,   ID_PGN_MASK, true, 8),
+        canMessage(ID_CELL_TEMPS, ID_PGN_MASK, true, 8)
+    };
+    
+    static constexpr uint8_t DEFAULT_SOURCE_ADDRESS = 0xE5;
+    
+    // Empfangene IDs (Hardware-Filter, ProtocolSet): PGN 0xFF50..0xFF57, jede Quelladresse
+    static constexpr CanIdFilter ROUTES[] = {
+        {ID_VOLTAGE, 0x1FFFF800, true}
+    };
+    
     DalyCan() : CanProtocolBase() {}
     
     const char* getName() const override { 
@@ -31,105 +83,97 @@ public:
         return BMS_DALY; 
     }
     
-    bool canAcceptMessage(uint32_t canId) const override {
-        return (canId == ID_VOLTAGE || 
-                canId == ID_CURRENT || 
-                canId == ID_SOC || 
-                canId == ID_TEMP ||
-                canId == ID_STATUS ||
-                canId == ID_CELLS);
+    bool canAcceptMessage(uint32_t canId, bool extended) const override {
+        uint32_t pgn = canId & ID_PGN_MASK;
+        return extended &&
+               (pgn == ID_VOLTAGE || 
+                pgn == ID_CURRENT || 
+                pgn == ID_SOC || 
+                pgn == ID_TEMP ||
+                pgn == ID_STATUS ||
+                pgn == ID_CELLS ||
+                pgn == ID_CELL_TEMPS);
     }
     
-    bool parseMessage(uint32_t canId, const uint8_t* data, uint8_t length) override {
-        if (length < 8) {
-            markError();
+    /**
+     * @brief Pack-Adresse = J1939-Quelladresse
+     */
+    uint8_t getNodeAddress(const CanFrame& frame) const override {
+        return (uint8_t)(frame.id & ID_SOURCE_MASK);
+    }
+    
+    size_t getIdFilters(CanIdFilter* filters, size_t maxFilters) const override {
+        return copyFilters(ROUTES, filters, maxFilters);
+    }
+    
+    // Zyklus pro Pack: PGN 0x50..0x54 (Zellwerte 0x55/0x56 zählen nicht)
+    uint32_t getCycleMessages() const override {
+        static constexpr uint32_t CYCLE = messageMaskFor(MESSAGES, CYCLE_FIELDS);
+        return CYCLE;
+    }
+    
+    // Gemeinsame Zielfelder laut Tabelle (Payload-Cache)
+    uint32_t getSharedMessages() const override {
+        static constexpr uint32_t SHARED = sharedMessageMask(MESSAGES);
+        return SHARED;
+    }
+    
+    bool parseMessage(const CanFrame& frame) override {
+        if (!decodeTableSignals(MESSAGES, frame)) {
             return false;
         }
         
-        bool parsed = false;
-        
-        switch (canId) {
-            case ID_VOLTAGE: {
-                uint16_t voltageRaw = extractUint16(data, 0, false);  // Little-Endian!
-                m_data.voltage = voltageRaw * 0.1f;
-                
-                if (validateRange(m_data.voltage, 40.0f, 60.0f)) {
-                    parsed = true;
-                    Serial.printf("[DALY] Voltage: %.2f V\n", m_data.voltage);
-                }
-                break;
-            }
-            
-            case ID_CURRENT: {
-                int16_t currentRaw = extractInt16(data, 0, false);  // Little-Endian!
-                m_data.current = currentRaw * 0.1f;
-                
-                m_data.charging = (m_data.current > 0.5f);
-                m_data.discharging = (m_data.current < -0.5f);
-                
-                parsed = true;
-                Serial.printf("[DALY] Current: %.1f A\n", m_data.current);
-                break;
-            }
-            
-            case ID_SOC: {
-                uint16_t socRaw = extractUint16(data, 0, false);  // Little-Endian!
-                m_data.soc = socRaw * 0.1f;
-                
-                if (validateRange(m_data.soc, 0.0f, 100.0f)) {
-                    parsed = true;
-                    Serial.printf("[DALY] SOC: %.1f %%\n", m_data.soc);
-                }
+        bool valid = true;
+        switch (frame.id & ID_PGN_MASK) {
+            case ID_CELLS:
+                valid = parseCellVoltages(frame);
                 break;
-            }
-            
-            case ID_TEMP: {
-                int16_t tempRaw = extractInt16(data, 0, false);  // Little-Endian!
-                m_data.temperature = tempRaw * 0.1f;
-                
-                if (validateRange(m_data.temperature, -20.0f, 60.0f)) {
-                    parsed = true;
-                    Serial.printf("[DALY] Temperature: %.1f °C\n", m_data.temperature);
-                }
+            case ID_CELL_TEMPS:
+                valid = parseCellTemperatures(frame);
                 break;
-            }
-            
-            case ID_STATUS: {
-                uint8_t statusFlags = data[0];
-                uint8_t alarmFlags = data[1];
-                m_data.cycles = extractUint16(data, 4, false);  // Little-Endian!
-                
-                if (alarmFlags != 0) {
-                    snprintf(m_data.status_text, sizeof(m_data.status_text),
-                            "ALARM 0x%02X - %u Zyklen", alarmFlags, m_data.cycles);
-                } else {
-                    snprintf(m_data.status_text, sizeof(m_data.status_text),
-                            "Online - %u Zyklen", m_data.cycles);
-                }
-                
-                parsed = true;
-                Serial.printf("[DALY] Status: 0x%02X, Alarm: 0x%02X, Cycles: %u\n",
-                            statusFlags, alarmFlags, m_data.cycles);
-                break;
-            }
-            
-            case ID_CELLS: {
-                parsed = true;
-                break;
-            }
-            
             default:
-                return false;
+                break;
         }
-        
-        if (parsed) {
-            markUpdated();
-        } else {
+        if (valid) {
+            markUpdated(frame);
+        }
+        return valid;
+    }
+    
+private:
+    bool parseCellVoltages(const CanFrame& frame) {
+        uint8_t number = CanU8<0>::get(frame.data);
+        if (number == 0 || (number - 1) * CELLS_PER_FRAME >= BmsCellStore::MAX_CELLS) {
+            markError();
+            return false;
+        }
+        CanPayload payload = CanPayload::load(frame);
+        const uint16_t values[CELLS_PER_FRAME] = {
+            LeU16<1>::get(payload), LeU16<3>::get(payload), LeU16<5>::get(payload)
+        };
+        return storeCellVoltages((uint8_t)((number - 1) * CELLS_PER_FRAME), values, CELLS_PER_FRAME);
+    }
+    
+    bool parseCellTemperatures(const CanFrame& frame) {
+        uint8_t number = CanU8<0>::get(frame.data);
+        if (number == 0 || (number - 1) * TEMPS_PER_FRAME >= BmsCellStore::MAX_TEMPS) {
             markError();
+            return false;
         }
-        
-        return parsed;
+        // Letzter Frame reicht über MAX_TEMPS hinaus: Rest ignorieren
+        uint8_t first = (uint8_t)((number - 1) * TEMPS_PER_FRAME);
+        size_t count = BmsCellStore::MAX_TEMPS - first;
+        if (count > TEMPS_PER_FRAME) {
+            count = TEMPS_PER_FRAME;
+        }
+        int16_t values[TEMPS_PER_FRAME];
+        for (size_t i = 0; i < count; i++) {
+            values[i] = (int16_t)((frame.data[1 + i] - TEMP_OFFSET_C) * 10);
+        }
+        return storeCellTemperatures(first, values, count);
     }
 };
 
+static_assert(validMessageTable(DalyCan::MESSAGES), "DalyCan: Signal außerhalb der Nutzdaten");
+
 #endif // DALY_CAN_H
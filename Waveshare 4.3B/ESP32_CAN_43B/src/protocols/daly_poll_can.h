@@ -0,0 +1,228 @@
+/**
+ * @file daly_poll_can.h
+ * @brief DALY BMS CAN-Protokoll, Request/Response-Schnittstelle
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * Die Standard-Firmware der DALY Smart-BMS sendet nicht von sich aus,
+ * sondern beantwortet Anfragen nach Data-IDs (0x90..0x98):
+ *   Request:  0x18 <Data-ID> <BMS-Adresse> 0x40   (8 Byte, Inhalt 0)
+ *   Antwort:  0x18 <Data-ID> 0x40 <BMS-Adresse>
+ * Die Klasse decodiert die Antworten (Big-Endian), die Anfragen stellt
+ * der DalyPoller (src/managers/daly_poller.h). Mehrere Packs am Bus
+ * unterscheiden sich in der BMS-Adresse (Pack-Adresse).
+ *
+ * SPEICHERN ALS: src/protocols/daly_poll_can.h
+ */
+
+#ifndef DALY_POLL_CAN_H
+#define DALY_POLL_CAN_H
+
+#include "protocol_base_can.h"
+
+class DalyPollCan : public CanProtocolBase {
+public:
+    // Data-IDs
+    static constexpr uint8_t DATA_SUMMARY     = 0x90;   // Spannung, Strom, SOC
+    static constexpr uint8_t DATA_CELL_RANGE  = 0x91;   // Min/Max Zellspannung
+    static constexpr uint8_t DATA_TEMP_RANGE  = 0x92;   // Min/Max Temperatur
+    static constexpr uint8_t DATA_MOS         = 0x93;   // Lade-/Entlade-MOSFET, Restkapazität
+    static constexpr uint8_t DATA_STATUS      = 0x94;   // Zellen, Sensoren, Zyklen
+    static constexpr uint8_t DATA_CELL_VOLTAGES = 0x95; // Mehrere Frames, je 3 Zellen
+    static constexpr uint8_t DATA_CELL_TEMPS  = 0x96;   // Mehrere Frames, je 7 Sensoren
+    static constexpr uint8_t DATA_BALANCE     = 0x97;
+    static constexpr uint8_t DATA_FAILURE     = 0x98;
+
+    static constexpr uint8_t HOST_ADDRESS = 0x40;       // Adresse des Abfragenden
+    static constexpr uint8_t DEFAULT_BMS_ADDRESS = 0x01;
+
+    /**
+     * @brief Abfragerunde pro Pack (DalyPoller)
+     *
+     * Zellwerte zuerst: Der Sendezyklus (0x90, 0x92, 0x94) schließt
+     * damit nach den Zellframes derselben Runde ab.
+     */
+    static constexpr uint8_t POLL_ROUND[] = {
+        DATA_CELL_VOLTAGES, DATA_CELL_TEMPS, DATA_SUMMARY, DATA_TEMP_RANGE, DATA_STATUS
+    };
+
+private:
+    static constexpr uint32_t ID_PRIORITY = 0x18000000;
+    static constexpr uint32_t ID_RESPONSE = ID_PRIORITY | ((uint32_t)HOST_ADDRESS << 8);
+    static constexpr uint32_t ID_RESPONSE_MASK = 0x1FFFFF00;   // Data-ID und Ziel, jede BMS-Adresse
+    static constexpr uint32_t ID_RESPONSE_RANGE = ID_RESPONSE | 0x00900000;
+    static constexpr uint32_t ID_RESPONSE_RANGE_MASK = 0x1FF0FF00;  // Data-ID 0x90..0x9F
+
+    static constexpr uint32_t ID_SUMMARY       = ID_RESPONSE | ((uint32_t)DATA_SUMMARY << 16);
+    static constexpr uint32_t ID_TEMP_RANGE    = ID_RESPONSE | ((uint32_t)DATA_TEMP_RANGE << 16);
+    static constexpr uint32_t ID_STATUS        = ID_RESPONSE | ((uint32_t)DATA_STATUS << 16);
+    static constexpr uint32_t ID_CELL_VOLTAGES = ID_RESPONSE | ((uint32_t)DATA_CELL_VOLTAGES << 16);
+    static constexpr uint32_t ID_CELL_TEMPS    = ID_RESPONSE | ((uint32_t)DATA_CELL_TEMPS << 16);
+
+    // Zellframes: Byte 0 = Framenummer ab 1, danach die Werte der Gruppe
+    static constexpr uint8_t CELLS_PER_FRAME = 3;       // Bytes 1..6, uint16 mV (BE)
+    static constexpr uint8_t TEMPS_PER_FRAME = 7;       // Bytes 1..7, uint8 °C + 40, 0xFF = kein Sensor
+    static constexpr uint8_t MAX_FRAMES = 16;           // DALY: bis 48 Zellen
+    static constexpr int16_t TEMP_OFFSET_C = 40;
+
+    // Signaltabellen (Big-Endian)
+    static constexpr CanSignal SIG_SUMMARY[] = {
+        {"Voltage", "V", 0, 0, 16, SIGNAL_BIG_ENDIAN, false, 0.1f, 0.0f, 40.0f, 60.0f, SIGNAL_VOLTAGE},
+        {"Current", "A", 4, 0, 16, SIGNAL_BIG_ENDIAN, false, 0.1f, -3000.0f,
+         SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_CURRENT},
+        {"SOC", "%", 6, 0, 16, SIGNAL_BIG_ENDIAN, false, 0.1f, 0.0f, 0.0f, 100.0f, SIGNAL_SOC}
+    };
+    static constexpr CanSignal SIG_TEMP_RANGE[] = {
+        {"Temperature", "°C", 0, 0, 8, SIGNAL_BIG_ENDIAN, false, 1.0f, -40.0f, -20.0f, 60.0f, SIGNAL_TEMPERATURE},
+        {"Min Temperature", "°C", 2, 0, 8, SIGNAL_BIG_ENDIAN, false, 1.0f, -40.0f,
+         SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE}
+    };
+    static constexpr CanSignal SIG_STATUS[] = {
+        {"Cells", "", 0, 0, 8, SIGNAL_BIG_ENDIAN, false, 1.0f, 0.0f,
+         SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE},
+        {"Sensors", "", 1, 0, 8, SIGNAL_BIG_ENDIAN, false, 1.0f, 0.0f,
+         SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE},
+        {"Cycles", "", 5, 0, 16, SIGNAL_BIG_ENDIAN, false, 1.0f, 0.0f,
+         SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_CYCLES}
+    };
+
+public:
+    // Nachrichtentabelle (CanSignalDecoder), Zuordnung über Data-ID und Ziel
+    static constexpr CanMessageDef MESSAGES[] = {
+        canMessage(ID_SUMMARY,       ID_RESPONSE_MASK, true, 8, SIG_SUMMARY),
+        canMessage(ID_TEMP_RANGE,    ID_RESPONSE_MASK, true, 8, SIG_TEMP_RANGE),
+        canMessage(ID_STATUS,        ID_RESPONSE_MASK, true, 8, SIG_STATUS),
+        canMessage(ID_CELL_VOLTAGES, ID_RESPONSE_MASK, true, 8),
+        canMessage(ID_CELL_TEMPS,    ID_RESPONSE_MASK, true, 8)
+    };
+
+    // Empfangene IDs (Hardware-Filter, ProtocolSet): Antworten 0x90..0x9F an 0x40
+    static constexpr CanIdFilter ROUTES[] = {
+        {ID_RESPONSE_RANGE, ID_RESPONSE_RANGE_MASK, true}
+    };
+
+    DalyPollCan() : CanProtocolBase() {}
+
+    // ========================================================================
+    // Request/Response-IDs (DalyPoller)
+    // ========================================================================
+
+    /**
+     * @brief Anfrage nach einer Data-ID an ein BMS
+     */
+    static CanFrame makeRequest(uint8_t dataId, uint8_t address) {
+        CanFrame frame = {};
+        frame.id = ID_PRIORITY | ((uint32_t)dataId << 16) | ((uint32_t)address << 8) | HOST_ADDRESS;
+        frame.flags = CanFrame::FLAG_EXTENDED;
+        frame.length = 8;
+        return frame;
+    }
+
+    /**
+     * @brief Zerlegt die ID einer Antwort
+     * @return false wenn der Frame keine DALY-Antwort ist
+     */
+    static bool parseResponse(const CanFrame& frame, uint8_t& dataId, uint8_t& address) {
+        if (!frame.isExtended() || (frame.id & ID_RESPONSE_RANGE_MASK) != ID_RESPONSE_RANGE) {
+            return false;
+        }
+        dataId = (uint8_t)(frame.id >> 16);
+        address = (uint8_t)frame.id;
+        return true;
+    }
+
+    // ========================================================================
+    // CanProtocolBase
+    // ========================================================================
+
+    const char* getName() const override {
+        return "DALY BMS CAN (Poll)";
+    }
+
+    bms_type_t getType() const override {
+        return BMS_DALY;
+    }
+
+    bool canAcceptMessage(uint32_t canId, bool extended) const override {
+        return extended && (canId & ID_RESPONSE_RANGE_MASK) == ID_RESPONSE_RANGE;
+    }
+
+    /**
+     * @brief Pack-Adresse = BMS-Adresse (Quelle der Antwort)
+     */
+    uint8_t getNodeAddress(const CanFrame& frame) const override {
+        return (uint8_t)frame.id;
+    }
+
+    size_t getIdFilters(CanIdFilter* filters, size_t maxFilters) const override {
+        return copyFilters(ROUTES, filters, maxFilters);
+    }
+
+    // Zyklus pro Pack: 0x90, 0x92, 0x94 (Zellwerte zählen nicht)
+    uint32_t getCycleMessages() const override {
+        static constexpr uint32_t CYCLE = messageMaskFor(MESSAGES, CYCLE_FIELDS);
+        return CYCLE;
+    }
+
+    // Gemeinsame Zielfelder laut Tabelle (Payload-Cache)
+    uint32_t getSharedMessages() const override {
+        static constexpr uint32_t SHARED = sharedMessageMask(MESSAGES);
+        return SHARED;
+    }
+
+    bool parseMessage(const CanFrame& frame) override {
+        if (!decodeTableSignals(MESSAGES, frame)) {
+            return false;
+        }
+
+        bool valid = true;
+        switch ((uint8_t)(frame.id >> 16)) {
+            case DATA_CELL_VOLTAGES:
+                valid = parseCellVoltages(frame);
+                break;
+            case DATA_CELL_TEMPS:
+                valid = parseCellTemperatures(frame);
+                break;
+            default:
+                break;
+        }
+        if (valid) {
+            markUpdated(frame);
+        }
+        return valid;
+    }
+
+private:
+    // Frames hinter MAX_CELLS bzw. MAX_TEMPS (Packs mit mehr Zellen) werden ignoriert
+    bool parseCellVoltages(const CanFrame& frame) {
+        uint8_t number = CanU8<0>::get(frame.data);
+        if (number == 0 || number > MAX_FRAMES) {
+            markError();
+            return false;
+        }
+        CanPayload payload = CanPayload::load(frame);
+        const uint16_t values[CELLS_PER_FRAME] = {
+            BeU16<1>::get(payload), BeU16<3>::get(payload), BeU16<5>::get(payload)
+        };
+        return storeCellVoltages((uint8_t)((number - 1) * CELLS_PER_FRAME), values, CELLS_PER_FRAME);
+    }
+
+    bool parseCellTemperatures(const CanFrame& frame) {
+        uint8_t number = CanU8<0>::get(frame.data);
+        if (number == 0 || number > MAX_FRAMES) {
+            markError();
+            return false;
+        }
+        int16_t values[TEMPS_PER_FRAME];
+        size_t count = 0;
+        while (count < TEMPS_PER_FRAME && frame.data[1 + count] != 0xFF) {
+            values[count] = (int16_t)((frame.data[1 + count] - TEMP_OFFSET_C) * 10);
+            count++;
+        }
+        return storeCellTemperatures((uint8_t)((number - 1) * TEMPS_PER_FRAME), values, count);
+    }
+};
+
+static_assert(validMessageTable(DalyPollCan::MESSAGES), "DalyPollCan: Signal außerhalb der Nutzdaten");
+
+#endif // DALY_POLL_CAN_H
@@ -0,0 +1,102 @@
+/**
+ * @file dbc_can_protocol.h
+ * @brief CAN-Protokoll aus einer generierten DBC-Tabelle
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * host/dbc_gen erzeugt aus Vector-DBC-Dateien (Verzeichnis dbc/) Header in
+ * src/protocols/generated/. Jeder Header enthält eine Tabellen-Struktur
+ *
+ *   struct SmaBmsCanDbc {
+ *       static constexpr const char* NAME;
+ *       static constexpr bms_type_t TYPE;
+ *       static constexpr CanMessageDef MESSAGES[];
+ *       static constexpr CanIdFilter ROUTES[];
+ *   };
+ *
+ * und DbcCanProtocol<SmaBmsCanDbc> macht daraus ein normales Protokoll
+ * für ProtocolManager und ProtocolSet. Zur Laufzeit wird nichts geparst,
+ * die Tabellen liegen als constexpr im Flash.
+ *
+ * Welche DBCs enthalten sind, legt die Generierung fest (host/Makefile,
+ * Variable DBC); generated/dbc_protocols.h listet sie in DBC_PROTOCOLS.
+ *
+ * SPEICHERN ALS: src/protocols/dbc_can_protocol.h
+ */
+
+#ifndef DBC_CAN_PROTOCOL_H
+#define DBC_CAN_PROTOCOL_H
+
+#include <tuple>
+#include "protocol_base_can.h"
+
+template <typename Dbc>
+class DbcCanProtocol : public CanProtocolBase {
+public:
+    // Für ProtocolSet und Benchmarks wie bei den handgeschriebenen Protokollen
+    static constexpr const CanMessageDef (&MESSAGES)[sizeof(Dbc::MESSAGES) / sizeof(CanMessageDef)] = Dbc::MESSAGES;
+    static constexpr const CanIdFilter (&ROUTES)[sizeof(Dbc::ROUTES) / sizeof(CanIdFilter)] = Dbc::ROUTES;
+
+    DbcCanProtocol() : CanProtocolBase() {}
+
+    const char* getName() const override {
+        return Dbc::NAME;
+    }
+
+    bms_type_t getType() const override {
+        return Dbc::TYPE;
+    }
+
+    bool canAcceptMessage(uint32_t canId, bool extended) const override {
+        for (const CanIdFilter& route : ROUTES) {
+            if (route.matches(canId, extended)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t getIdFilters(CanIdFilter* filters, size_t maxFilters) const override {
+        return copyFilters(ROUTES, filters, maxFilters);
+    }
+
+    // Zyklus: alle Nachrichten mit BmsTarget-Signalen
+    uint32_t getCycleMessages() const override {
+        static constexpr uint32_t CYCLE = messageMaskFor(MESSAGES, ~signalBit(SIGNAL_NONE));
+        return CYCLE;
+    }
+    
+    // Mehrfach belegte BmsTargets der DBC werden immer decodiert
+    uint32_t getSharedMessages() const override {
+        static constexpr uint32_t SHARED = sharedMessageMask(MESSAGES);
+        return SHARED;
+    }
+    
+    bool parseMessage(const CanFrame& frame) override {
+        return decodeSignals(MESSAGES, frame);
+    }
+};
+
+/**
+ * @brief Instanzen mehrerer DBC-Protokolle (z.B. DbcProtocolBundle<DBC_PROTOCOLS>)
+ */
+template <typename... Protocols>
+class DbcProtocolBundle {
+private:
+    std::tuple<Protocols...> m_protocols;
+
+public:
+    static constexpr size_t PROTOCOL_COUNT = sizeof...(Protocols);
+
+    /**
+     * @brief Registriert alle Protokolle beim ProtocolManager
+     */
+    template <typename Manager>
+    void registerAll(Manager& manager) {
+        std::apply([&manager](auto&... protocols) {
+            (manager.registerProtocol(&protocols), ...);
+        }, m_protocols);
+    }
+};
+
+#endif // DBC_CAN_PROTOCOL_H
@@ -0,0 +1,21 @@
+/**
+ * @file dbc_protocols.h
+ * @brief Alle aus DBC-Dateien generierten Protokolle
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * NICHT VON HAND BEARBEITEN - erzeugt von host/dbc_gen (make dbc).
+ * Verwendung: DbcProtocolBundle<DBC_PROTOCOLS> dbcProtocols;
+ *
+ * SPEICHERN ALS: src/protocols/generated/dbc_protocols.h
+ */
+
+#ifndef DBC_PROTOCOLS_H
+#define DBC_PROTOCOLS_H
+
+#include "../dbc_can_protocol.h"
+#include "sma_bms_can_dbc.h"
+
+#define DBC_PROTOCOLS SmaBmsCan
+
+#endif // DBC_PROTOCOLS_H
@@ -0,0 +1,81 @@
+/**
+ * @file sma_bms_can_dbc.h
+ * @brief SMA BMS CAN - aus sma_bms_can.dbc generiert
+ * @author BMS Monitor Team
+ * @date 2025
+ *
+ * NICHT VON HAND BEARBEITEN - erzeugt von host/dbc_gen (make dbc).
+ *
+ * SPEICHERN ALS: src/protocols/generated/sma_bms_can_dbc.h
+ */
+
+#ifndef SMA_BMS_CAN_DBC_H
+#define SMA_BMS_CAN_DBC_H
+
+#include "../dbc_can_protocol.h"
+
+struct SmaBmsCanDbc {
+    static constexpr const char* NAME = "SMA BMS CAN";
+    static constexpr bms_type_t TYPE = BMS_DBC;
+
+    // BMS_Limits
+    static constexpr CanSignal SIG_BMS_Limits[] = {
+        {"ChargeVoltageLimit", "V", 0, 0, 16, SIGNAL_LITTLE_ENDIAN, false, 0.1f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE},
+        {"ChargeCurrentLimit", "A", 2, 0, 16, SIGNAL_LITTLE_ENDIAN, true, 0.1f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE},
+        {"DischargeCurrentLimit", "A", 4, 0, 16, SIGNAL_LITTLE_ENDIAN, true, 0.1f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE},
+        {"DischargeVoltageLimit", "V", 6, 0, 16, SIGNAL_LITTLE_ENDIAN, false, 0.1f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE}
+    };
+
+    // BMS_SOC
+    static constexpr CanSignal SIG_BMS_SOC[] = {
+        {"SOC", "%", 0, 0, 16, SIGNAL_LITTLE_ENDIAN, false, 1.0f, 0.0f, 0.0f, 100.0f, SIGNAL_SOC},
+        {"SOH", "%", 2, 0, 16, SIGNAL_LITTLE_ENDIAN, false, 1.0f, 0.0f, 0.0f, 100.0f, SIGNAL_NONE}
+    };
+
+    // BMS_Measurements
+    static constexpr CanSignal SIG_BMS_Measurements[] = {
+        {"Voltage", "V", 0, 0, 16, SIGNAL_LITTLE_ENDIAN, true, 0.01f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_VOLTAGE},
+        {"Current", "A", 2, 0, 16, SIGNAL_LITTLE_ENDIAN, true, 0.1f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_CURRENT},
+        {"Temperature", "C", 4, 0, 16, SIGNAL_LITTLE_ENDIAN, true, 0.1f, 0.0f, -40.0f, 100.0f, SIGNAL_TEMPERATURE}
+    };
+
+    // BMS_Protection
+    static constexpr CanSignal SIG_BMS_Protection[] = {
+        {"ProtectionFlags", "", 0, 0, 8, SIGNAL_LITTLE_ENDIAN, false, 1.0f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_ALARM},
+        {"ProtectionFlags2", "", 1, 0, 8, SIGNAL_LITTLE_ENDIAN, false, 1.0f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE},
+        {"WarningFlags", "", 2, 0, 8, SIGNAL_LITTLE_ENDIAN, false, 1.0f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE},
+        {"WarningFlags2", "", 3, 0, 8, SIGNAL_LITTLE_ENDIAN, false, 1.0f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE},
+        {"ModuleCount", "", 4, 0, 8, SIGNAL_LITTLE_ENDIAN, false, 1.0f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE}
+    };
+
+    // BMS_Request
+    static constexpr CanSignal SIG_BMS_Request[] = {
+        {"ChargeEnable", "", 0, 7, 1, SIGNAL_LITTLE_ENDIAN, false, 1.0f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE},
+        {"DischargeEnable", "", 0, 6, 1, SIGNAL_LITTLE_ENDIAN, false, 1.0f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE},
+        {"ForceChargeRequest", "", 0, 5, 1, SIGNAL_LITTLE_ENDIAN, false, 1.0f, 0.0f, SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_NONE}
+    };
+
+    static constexpr CanMessageDef MESSAGES[] = {
+        canMessage(0x351, CAN_STD_ID_MASK, false, 8, SIG_BMS_Limits),
+        canMessage(0x355, CAN_STD_ID_MASK, false, 8, SIG_BMS_SOC),
+        canMessage(0x356, CAN_STD_ID_MASK, false, 8, SIG_BMS_Measurements),
+        canMessage(0x359, CAN_STD_ID_MASK, false, 8, SIG_BMS_Protection),
+        canMessage(0x35C, CAN_STD_ID_MASK, false, 2, SIG_BMS_Request),
+        canMessage(0x35E, CAN_STD_ID_MASK, false, 8)
+    };
+
+    static constexpr CanIdFilter ROUTES[] = {
+        {0x351, CAN_STD_ID_MASK, false},
+        {0x355, CAN_STD_ID_MASK, false},
+        {0x356, CAN_STD_ID_MASK, false},
+        {0x359, CAN_STD_ID_MASK, false},
+        {0x35C, CAN_STD_ID_MASK, false},
+        {0x35E, CAN_STD_ID_MASK, false}
+    };
+};
+
+static_assert(validMessageTable(SmaBmsCanDbc::MESSAGES), "SmaBmsCan: Signal außerhalb der Nutzdaten");
+
+using SmaBmsCan = DbcCanProtocol<SmaBmsCanDbc>;
+
+#endif // SMA_BMS_CAN_DBC_H
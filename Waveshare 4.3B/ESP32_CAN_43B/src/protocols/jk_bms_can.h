@@ -21,13 +21,52 @@ private:
     static constexpr uint8_t MSG_SOC = 0x03;
     static constexpr uint8_t MSG_TEMP = 0x04;
     static constexpr uint8_t MSG_STATUS = 0x05;
-    static constexpr uint8_t MSG_CELLS = 0x10;
+    static constexpr uint8_t MSG_CELLS = 0x10;         // 0x10..0x17: je 4 Zellen, uint16 mV
+    static constexpr uint8_t MSG_CELL_TEMPS = 0x18;    // 0x18..0x1B: je 4 Sensoren, int16 0.1 °C
     
-    uint8_t getMessageType(uint32_t canId) const {
-        return (uint8_t)(canId & 0xFF);
-    }
+    // Gruppe im untersten ID-Byte
+    static constexpr uint32_t CELL_GROUP_MASK = 0x07;
+    static constexpr uint32_t TEMP_GROUP_MASK = 0x03;
+    static constexpr uint8_t VALUES_PER_FRAME = 4;
+    
+    // Signaltabellen (Big-Endian)
+    static constexpr CanSignal SIG_VOLTAGE[] = {
+        {"Voltage", "V", 0, 0, 32, SIGNAL_BIG_ENDIAN, false, 0.001f, 0.0f, 40.0f, 60.0f, SIGNAL_VOLTAGE}
+    };
+    static constexpr CanSignal SIG_CURRENT[] = {
+        {"Current", "A", 0, 0, 32, SIGNAL_BIG_ENDIAN, true, 0.001f, 0.0f,
+         SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_CURRENT}
+    };
+    static constexpr CanSignal SIG_SOC[] = {
+        {"SOC", "%", 0, 0, 16, SIGNAL_BIG_ENDIAN, false, 0.01f, 0.0f, 0.0f, 100.0f, SIGNAL_SOC}
+    };
+    static constexpr CanSignal SIG_TEMP[] = {
+        {"Temperature", "°C", 0, 0, 16, SIGNAL_BIG_ENDIAN, true, 0.1f, 0.0f, -20.0f, 60.0f, SIGNAL_TEMPERATURE}
+    };
+    static constexpr CanSignal SIG_STATUS[] = {
+        {"Status", "", 0, 0, 8, SIGNAL_BIG_ENDIAN, false, 1.0f, 0.0f,
+         SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_STATUS},
+        {"Cycles", "", 2, 0, 16, SIGNAL_BIG_ENDIAN, false, 1.0f, 0.0f,
+         SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_CYCLES}
+    };
     
 public:
+    // Nachrichtentabelle (CanSignalDecoder), Nachrichtentyp im untersten ID-Byte
+    static constexpr CanMessageDef MESSAGES[] = {
+        canMessage(ID_BASE | MSG_VOLTAGE, CAN_EXT_ID_MASK, true, 8, SIG_VOLTAGE),
+        canMessage(ID_BASE | MSG_CURRENT, CAN_EXT_ID_MASK, true, 8, SIG_CURRENT),
+        canMessage(ID_BASE | MSG_SOC,     CAN_EXT_ID_MASK, true, 8, SIG_SOC),
+        canMessage(ID_BASE | MSG_TEMP,    CAN_EXT_ID_MASK, true, 8, SIG_TEMP),
+        canMessage(ID_BASE | MSG_STATUS,  CAN_EXT_ID_MASK, true, 8, SIG_STATUS),
+        canMessage(ID_BASE | MSG_CELLS,   CAN_EXT_ID_MASK & ~CELL_GROUP_MASK, true, 8),
+        canMessage(ID_BASE | MSG_CELL_TEMPS, CAN_EXT_ID_MASK & ~TEMP_GROUP_MASK, true, 8)
+    };
+    
+    // Empfangene IDs (Hardware-Filter, ProtocolSet)
+    static constexpr CanIdFilter ROUTES[] = {
+        {ID_BASE, ID_MASK & CAN_EXT_ID_MASK, true}     // 256 IDs, Nachrichtentyp im untersten Byte
+    };
+    
     JkBmsCan() : CanProtocolBase() {}
     
     const char* getName() const override { 
@@ -38,96 +77,65 @@ public:
         return BMS_JK_BMS; 
     }
     
-    bool canAcceptMessage(uint32_t canId) const override {
-        return (canId & ID_MASK) == ID_BASE;
+    bool canAcceptMessage(uint32_t canId, bool extended) const override {
+        return extended && (canId & ID_MASK) == ID_BASE;
+    }
+    
+    size_t getIdFilters(CanIdFilter* filters, size_t maxFilters) const override {
+        return copyFilters(ROUTES, filters, maxFilters);
+    }
+    
+    // Zyklus: Nachrichten 0x01..0x05 (Zellwerte 0x10..0x1B zählen nicht)
+    uint32_t getCycleMessages() const override {
+        static constexpr uint32_t CYCLE = messageMaskFor(MESSAGES, CYCLE_FIELDS);
+        return CYCLE;
+    }
+    
+    // Gemeinsame Zielfelder laut Tabelle (Payload-Cache)
+    uint32_t getSharedMessages() const override {
+        static constexpr uint32_t SHARED = sharedMessageMask(MESSAGES);
+        return SHARED;
     }
     
-    bool parseMessage(uint32_t canId, const uint8_t* data, uint8_t length) override {
-        if (length < 8) {
-            markError();
+    bool parseMessage(const CanFrame& frame) override {
+        if (!decodeTableSignals(MESSAGES, frame)) {
             return false;
         }
         
-        uint8_t msgType = getMessageType(canId);
-        bool parsed = false;
-        
-        switch (msgType) {
-            case MSG_VOLTAGE: {
-                uint32_t voltageMillivolts = extractUint32(data, 0, true);
-                m_data.voltage = voltageMillivolts / 1000.0f;
-                
-                if (validateRange(m_data.voltage, 40.0f, 60.0f)) {
-                    parsed = true;
-                    Serial.printf("[JK BMS] Voltage: %.2f V\n", m_data.voltage);
-                }
-                break;
-            }
-            
-            case MSG_CURRENT: {
-                int32_t currentMilliamps = extractInt32(data, 0, true);
-                m_data.current = currentMilliamps / 1000.0f;
-                
-                m_data.charging = (m_data.current > 0.5f);
-                m_data.discharging = (m_data.current < -0.5f);
-                
-                parsed = true;
-                Serial.printf("[JK BMS] Current: %.1f A\n", m_data.current);
-                break;
-            }
-            
-            case MSG_SOC: {
-                uint16_t socRaw = extractUint16(data, 0, true);
-                m_data.soc = socRaw * 0.01f;
-                
-                if (validateRange(m_data.soc, 0.0f, 100.0f)) {
-                    parsed = true;
-                    Serial.printf("[JK BMS] SOC: %.1f %%\n", m_data.soc);
-                }
-                break;
-            }
-            
-            case MSG_TEMP: {
-                int16_t tempRaw = extractInt16(data, 0, true);
-                m_data.temperature = tempRaw * 0.1f;
-                
-                if (validateRange(m_data.temperature, -20.0f, 60.0f)) {
-                    parsed = true;
-                    Serial.printf("[JK BMS] Temperature: %.1f °C\n", m_data.temperature);
-                }
-                break;
-            }
-            
-            case MSG_STATUS: {
-                uint8_t statusByte = data[0];
-                m_data.cycles = extractUint16(data, 2, true);
-                
-                snprintf(m_data.status_text, sizeof(m_data.status_text),
-                        "Online - Status: 0x%02X - %u Zyklen", 
-                        statusByte, m_data.cycles);
-                
-                parsed = true;
-                Serial.printf("[JK BMS] Status: 0x%02X, Cycles: %u\n", 
-                            statusByte, m_data.cycles);
-                break;
-            }
-            
-            case MSG_CELLS: {
-                parsed = true;
-                break;
-            }
-            
-            default:
-                return false;
+        if (!parseCellValues(frame)) {
+            return false;
         }
-        
-        if (parsed) {
-            markUpdated();
-        } else {
-            markError();
+        markUpdated(frame);
+        return true;
+    }
+    
+private:
+    /**
+     * @brief Zellspannungen bzw. -temperaturen (andere Nachrichten: true)
+     */
+    bool parseCellValues(const CanFrame& frame) {
+        uint8_t type = (uint8_t)(frame.id & ~ID_MASK);
+        CanPayload payload = CanPayload::load(frame);
+        if ((type & ~CELL_GROUP_MASK) == MSG_CELLS) {
+            const uint16_t values[VALUES_PER_FRAME] = {
+                BeU16<0>::get(payload), BeU16<2>::get(payload),
+                BeU16<4>::get(payload), BeU16<6>::get(payload)
+            };
+            return storeCellVoltages((uint8_t)((type & CELL_GROUP_MASK) * VALUES_PER_FRAME),
+                                     values, VALUES_PER_FRAME);
         }
-        
-        return parsed;
+        if ((type & ~TEMP_GROUP_MASK) == MSG_CELL_TEMPS) {
+            const int16_t values[VALUES_PER_FRAME] = {
+                BeI16<0>::get(payload), BeI16<2>::get(payload),
+                BeI16<4>::get(payload), BeI16<6>::get(payload)
+            };
+            return storeCellTemperatures((uint8_t)((type & TEMP_GROUP_MASK) * VALUES_PER_FRAME),
+                                         values, VALUES_PER_FRAME);
+        }
+        return true;
     }
 };
 
+static_assert(validMessageTable(JkBmsCan::MESSAGES), "JkBmsCan: Signal außerhalb der Nutzdaten");
+
 #endif // JK_BMS_CAN_H
@@ -12,25 +12,43 @@
 
 #include <Arduino.h>
 #include "../core/bms_data_types.h"
+#include "../core/can_types.h"
+#include "../core/deferred_log.h"
+#include "can_signal_decoder.h"
 
 /**
  * @brief Abstrakte Basis-Klasse für CAN-Protokolle
  */
 class CanProtocolBase {
+public:
+    static constexpr uint8_t NO_MESSAGE_INDEX = 0xFF;
+    
+    // Zielfelder eines vollständigen Zyklus (für getCycleMessages())
+    static constexpr uint32_t CYCLE_FIELDS = signalBit(SIGNAL_VOLTAGE) | signalBit(SIGNAL_CURRENT) |
+                                             signalBit(SIGNAL_SOC) | signalBit(SIGNAL_TEMPERATURE) |
+                                             signalBit(SIGNAL_CYCLES);
+    
+    // Plausibilitätsgrenzen der Zellwerte (storeCellVoltages/-Temperatures)
+    static constexpr uint16_t CELL_MIN_MV = 1000;
+    static constexpr uint16_t CELL_MAX_MV = 5000;
+    static constexpr int16_t CELL_MIN_DECI_C = -400;
+    static constexpr int16_t CELL_MAX_DECI_C = 1200;
+    
 protected:
     bms_data_t m_data;
     bool m_connected;
     uint32_t m_lastUpdate;
+    int64_t m_lastFrameUs;          ///< RX-Zeitstempel des letzten gültigen Frames
+    uint32_t m_lastInterArrivalUs;  ///< Abstand zum vorherigen gültigen Frame
     uint32_t m_messageCount;
     uint32_t m_errorCount;
+    uint8_t m_lastMessageIndex;     ///< Tabellenindex des zuletzt decodierten Frames
     
-    // Helper-Funktionen
+    // Helper-Funktionen (Offset zur Laufzeit; feste Positionen: CanField)
     uint16_t extractUint16(const uint8_t* data, size_t offset, bool bigEndian = true) {
-        if (bigEndian) {
-            return (uint16_t)(data[offset] << 8) | data[offset + 1];
-        } else {
-            return (uint16_t)(data[offset + 1] << 8) | data[offset];
-        }
+        uint16_t value;
+        memcpy(&value, data + offset, sizeof(value));
+        return bigEndian ? __builtin_bswap16(value) : value;
     }
     
     int16_t extractInt16(const uint8_t* data, size_t offset, bool bigEndian = true) {
@@ -38,17 +56,9 @@ protected:
     }
     
     uint32_t extractUint32(const uint8_t* data, size_t offset, bool bigEndian = true) {
-        if (bigEndian) {
-            return ((uint32_t)data[offset] << 24) |
-                   ((uint32_t)data[offset + 1] << 16) |
-                   ((uint32_t)data[offset + 2] << 8) |
-                   ((uint32_t)data[offset + 3]);
-        } else {
-            return ((uint32_t)data[offset + 3] << 24) |
-                   ((uint32_t)data[offset + 2] << 16) |
-                   ((uint32_t)data[offset + 1] << 8) |
-                   ((uint32_t)data[offset]);
-        }
+        uint32_t value;
+        memcpy(&value, data + offset, sizeof(value));
+        return bigEndian ? __builtin_bswap32(value) : value;
     }
     
     int32_t extractInt32(const uint8_t* data, size_t offset, bool bigEndian = true) {
@@ -59,8 +69,31 @@ protected:
         return (value >= min && value <= max);
     }
     
-    void markUpdated() {
-        m_lastUpdate = millis();
+    /**
+     * @brief Kopiert die statische Routenliste (ROUTES) eines Protokolls
+     */
+    template <size_t N>
+    static size_t copyFilters(const CanIdFilter (&routes)[N], CanIdFilter* filters, size_t maxFilters) {
+        size_t count = 0;
+        for (const CanIdFilter& route : routes) {
+            if (count >= maxFilters) break;
+            filters[count++] = route;
+        }
+        return count;
+    }
+    
+    /**
+     * @brief Markiert einen erfolgreich geparsten Frame
+     * 
+     * Verwendet den RX-Zeitstempel des Frames statt der Parse-Zeit.
+     * millis() basiert ebenfalls auf esp_timer, die Zeitbasis ist gleich.
+     */
+    void markUpdated(const CanFrame& frame) {
+        if (m_lastFrameUs > 0) {
+            m_lastInterArrivalUs = (uint32_t)(frame.timestampUs - m_lastFrameUs);
+        }
+        m_lastFrameUs = frame.timestampUs;
+        m_lastUpdate = (uint32_t)(frame.timestampUs / 1000);
         m_connected = true;
         m_messageCount++;
     }
@@ -68,13 +101,115 @@ protected:
     void markError() {
         m_errorCount++;
     }
+    
+    /**
+     * @brief parseMessage() für tabellengesteuerte Protokolle
+     * 
+     * Decodiert den Frame über die Nachrichtentabelle in m_data, gibt die
+     * Signale über das verzögerte Log aus und führt die Statistik nach.
+     * @param messages Nachrichtentabelle des Protokolls
+     * @param frame Empfangener Frame
+     * @param fields Optional: gesetzte Zielfelder (signalBit())
+     * @return false bei unbekannter ID (ohne Fehler) oder ungültigem Frame
+     */
+    template <size_t N>
+    bool decodeSignals(const CanMessageDef (&messages)[N], const CanFrame& frame,
+                       uint32_t* fields = nullptr) {
+        if (!decodeTableSignals(messages, frame, fields)) {
+            return false;
+        }
+        markUpdated(frame);
+        return true;
+    }
+    
+    /**
+     * @brief decodeSignals() ohne markUpdated()
+     * 
+     * Für Protokolle, die den Frame danach noch prüfen (Zellwerte): erst
+     * wenn auch das gelingt, ruft parseMessage() markUpdated() auf - ein
+     * verworfener Frame frischt Zeitstempel und Zähler nicht auf.
+     */
+    template <size_t N>
+    bool decodeTableSignals(const CanMessageDef (&messages)[N], const CanFrame& frame,
+                            uint32_t* fields = nullptr) {
+        const CanMessageDef* message = CanSignalDecoder::find(messages, frame);
+        if (!message) {
+            return false;
+        }
+        
+        float values[CanSignalDecoder::MAX_SIGNALS];
+        if (CanSignalDecoder::decode(*message, frame, m_data, values, fields) != CanSignalDecoder::DECODE_OK) {
+            markError();
+            return false;
+        }
+        
+        for (size_t i = 0; i < message->signalCount; i++) {
+            const CanSignal& signal = message->signals[i];
+            BMS_LOG_INFO("[%s] %s: %.*f %s\n", getName(), signal.name,
+                         CanSignalDecoder::decimals(signal), values[i], signal.unit);
+        }
+        
+        m_lastMessageIndex = (uint8_t)(message - messages);
+        return true;
+    }
+
+    /**
+     * @brief Übernimmt die Zellspannungen eines Frames in m_data.cells
+     * 
+     * Erst wenn alle Werte plausibel sind, wird gespeichert.
+     * @param first Index der ersten Zelle im Frame
+     * @param values Spannungen in mV, 0 = Zelle nicht bestückt
+     * @param count Anzahl Werte
+     * @return false bei unplausibler Spannung (Frame verworfen)
+     */
+    bool storeCellVoltages(uint8_t first, const uint16_t* values, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            if (values[i] != 0 && (values[i] < CELL_MIN_MV || values[i] > CELL_MAX_MV)) {
+                markError();
+                return false;
+            }
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (values[i] != 0) {
+                m_data.cells.setVoltage((uint8_t)(first + i), values[i]);
+            }
+        }
+        BMS_LOG_DEBUG("[%s] Cells %u..%u: min %u mV (#%u), delta %u mV\n", getName(),
+                      (unsigned)first + 1, (unsigned)(first + count),
+                      (unsigned)m_data.cells.getMinMv(), m_data.cells.getWeakestCell() + 1u,
+                      (unsigned)m_data.cells.getDeltaMv());
+        return true;
+    }
+    
+    /**
+     * @brief Übernimmt die Sensor-Temperaturen eines Frames in m_data.cells
+     * @param first Index des ersten Sensors im Frame
+     * @param values Temperaturen in 0.1 °C
+     * @param count Anzahl Werte
+     * @return false bei unplausibler Temperatur (Frame verworfen)
+     */
+    bool storeCellTemperatures(uint8_t first, const int16_t* values, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            if (values[i] < CELL_MIN_DECI_C || values[i] > CELL_MAX_DECI_C) {
+                markError();
+                return false;
+            }
+        }
+        for (size_t i = 0; i < count; i++) {
+            m_data.cells.setTemperature((uint8_t)(first + i), values[i]);
+        }
+        return true;
+    }
 
 public:
     CanProtocolBase() 
         : m_connected(false)
         , m_lastUpdate(0)
+        , m_lastFrameUs(0)
+        , m_lastInterArrivalUs(0)
         , m_messageCount(0)
         , m_errorCount(0)
+        , m_lastMessageIndex(NO_MESSAGE_INDEX)
     {
         memset(&m_data, 0, sizeof(m_data));
         m_data.type = BMS_NONE;
@@ -85,13 +220,84 @@ public:
     // Abstrakte Methoden
     virtual const char* getName() const = 0;
     virtual bms_type_t getType() const = 0;
-    virtual bool canAcceptMessage(uint32_t canId) const = 0;
-    virtual bool parseMessage(uint32_t canId, const uint8_t* data, uint8_t length) = 0;
+    
+    /**
+     * @brief Prüft ob ein Frame zu diesem Protokoll gehört
+     * @param canId CAN-Identifier
+     * @param extended true = 29-Bit Frame (IDE gesetzt)
+     */
+    virtual bool canAcceptMessage(uint32_t canId, bool extended) const = 0;
+    virtual bool parseMessage(const CanFrame& frame) = 0;
+    
+    /**
+     * @brief Pack-Adresse eines Frames (Multi-Pack)
+     * 
+     * Protokolle, bei denen mehrere Packs am selben Bus senden, leiten
+     * die Adresse aus dem Identifier ab. 0 = nur ein Pack.
+     */
+    virtual uint8_t getNodeAddress(const CanFrame& frame) const {
+        return 0;
+    }
+    
+    /**
+     * @brief Nachrichten eines Sendezyklus (Bit i = Index i der Tabelle)
+     * 
+     * Der ProtocolManager veröffentlicht einen neuen Stand erst, wenn
+     * diese Nachrichten eingetroffen sind (CanCycleAggregator).
+     * 0 = jeder decodierte Frame ist eine Aktualisierung.
+     */
+    virtual uint32_t getCycleMessages() const {
+        return 0;
+    }
+    
+    /**
+     * @brief Nachrichten mit gemeinsamen Zielfeldern (Bit i = Index i)
+     * 
+     * Der Payload-Cache überspringt diese Nachrichten nie: Ein
+     * unveränderter Frame muss wiederherstellen, was eine andere
+     * Nachricht inzwischen überschrieben hat (sharedMessageMask()).
+     */
+    virtual uint32_t getSharedMessages() const {
+        return 0;
+    }
+    
+    /**
+     * @brief Tabellenindex des zuletzt decodierten Frames (decodeSignals())
+     */
+    uint8_t getLastMessageIndex() const {
+        return m_lastMessageIndex;
+    }
+    
+    /**
+     * @brief Frame mit unveränderten Nutzdaten (Payload-Cache)
+     * 
+     * Die Werte gelten weiter, nur Zeitstempel und Verbindungsstatus
+     * werden aktualisiert.
+     */
+    void refresh(const CanFrame& frame) {
+        markUpdated(frame);
+    }
+    
+    /**
+     * @brief Liefert die ID-Filter des Protokolls (für Hardware-Filter)
+     * 
+     * Protokolle mit festen IDs deklarieren diese zusätzlich als
+     * static constexpr CanIdFilter ROUTES[] - daraus baut ProtocolSet
+     * seine Routing-Tabelle zur Compile-Zeit.
+     * @param filters Ziel-Array
+     * @param maxFilters Größe des Ziel-Arrays
+     * @return Anzahl Filter, 0 = keine Angabe (alles akzeptieren)
+     */
+    virtual size_t getIdFilters(CanIdFilter* filters, size_t maxFilters) const {
+        return 0;
+    }
     
     // Standard-Implementation
     virtual bool initialize() {
         m_connected = false;
         m_lastUpdate = 0;
+        m_lastFrameUs = 0;
+        m_lastInterArrivalUs = 0;
         m_messageCount = 0;
         m_errorCount = 0;
         memset(&m_data, 0, sizeof(m_data));
@@ -117,6 +323,21 @@ public:
         return ((millis() - m_lastUpdate) < timeoutMs);
     }
     
+    /**
+     * @brief Decodierzustand eines Packs laden bzw. lesen
+     * 
+     * Der ProtocolManager lädt vor dem Decodieren den Stand des Packs,
+     * von dem der Frame stammt, und übernimmt danach das Ergebnis in die
+     * Pack-Tabelle. Frames verschiedener Packs vermischen sich so nicht.
+     */
+    void loadPackData(const bms_data_t& data) {
+        m_data = data;
+    }
+    
+    const bms_data_t& getPackData() const {
+        return m_data;
+    }
+    
     bool getData(bms_data_t& data) const {
         if (!isConnected()) {
             return false;
@@ -131,6 +352,13 @@ public:
         return millis() - m_lastUpdate;
     }
     
+    /**
+     * @brief Abstand der letzten beiden gültigen Frames in µs
+     */
+    uint32_t getLastInterArrivalUs() const {
+        return m_lastInterArrivalUs;
+    }
+    
     void getStats(uint32_t& msgCount, uint32_t& errCount) const {
         msgCount = m_messageCount;
         errCount = m_errorCount;
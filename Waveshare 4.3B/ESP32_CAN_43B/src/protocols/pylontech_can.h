@@ -20,17 +20,55 @@ private:
     static constexpr uint32_t ID_STATUS  = 0x35E;
     static constexpr uint32_t ID_ALARM   = 0x35A;
     
-    bool m_voltageReceived;
-    bool m_currentReceived;
-    bool m_socReceived;
+    // Signaltabellen (Big-Endian)
+    static constexpr CanSignal SIG_VOLTAGE[] = {
+        {"Voltage", "V", 0, 0, 16, SIGNAL_BIG_ENDIAN, false, 0.01f, 0.0f, 40.0f, 60.0f, SIGNAL_VOLTAGE}
+    };
+    static constexpr CanSignal SIG_CURRENT[] = {
+        {"Current", "A", 0, 0, 16, SIGNAL_BIG_ENDIAN, true, 0.1f, 0.0f,
+         SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_CURRENT}
+    };
+    static constexpr CanSignal SIG_SOC[] = {
+        {"SOC", "%", 0, 0, 16, SIGNAL_BIG_ENDIAN, false, 0.1f, 0.0f, 0.0f, 100.0f, SIGNAL_SOC}
+    };
+    static constexpr CanSignal SIG_TEMP[] = {
+        {"Temperature", "°C", 0, 0, 16, SIGNAL_BIG_ENDIAN, true, 0.1f, 0.0f, -20.0f, 60.0f, SIGNAL_TEMPERATURE}
+    };
+    static constexpr CanSignal SIG_STATUS[] = {
+        {"Cycles", "", 0, 0, 16, SIGNAL_BIG_ENDIAN, false, 1.0f, 0.0f,
+         SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_CYCLES}
+    };
+    static constexpr CanSignal SIG_ALARM[] = {
+        {"Alarm", "", 0, 0, 8, SIGNAL_BIG_ENDIAN, false, 1.0f, 0.0f,
+         SIGNAL_UNCHECKED_MIN, SIGNAL_UNCHECKED_MAX, SIGNAL_ALARM}
+    };
     
 public:
-    PylontechCan() 
-        : CanProtocolBase()
-        , m_voltageReceived(false)
-        , m_currentReceived(false)
-        , m_socReceived(false)
-    {}
+    // Nachrichtentabelle (CanSignalDecoder)
+    static constexpr CanMessageDef MESSAGES[] = {
+        canMessage(ID_VOLTAGE, CAN_STD_ID_MASK, false, 8, SIG_VOLTAGE),
+        canMessage(ID_CURRENT, CAN_STD_ID_MASK, false, 8, SIG_CURRENT),
+        canMessage(ID_SOC,     CAN_STD_ID_MASK, false, 8, SIG_SOC),
+        canMessage(ID_TEMP,    CAN_STD_ID_MASK, false, 8, SIG_TEMP),
+        canMessage(ID_STATUS,  CAN_STD_ID_MASK, false, 8, SIG_STATUS),
+        canMessage(ID_ALARM,   CAN_STD_ID_MASK, false, 8, SIG_ALARM)
+    };
+    
+    // Keep-Alive, das der Wechselrichter an das BMS sendet (Gateway-Betrieb)
+    static constexpr uint32_t ID_INVERTER_KEEPALIVE = 0x305;
+    static constexpr uint32_t KEEPALIVE_PERIOD_MS   = 1000;
+    
+    // Empfangene IDs (Hardware-Filter, ProtocolSet)
+    static constexpr CanIdFilter ROUTES[] = {
+        {ID_VOLTAGE, CAN_STD_ID_MASK, false},
+        {ID_CURRENT, CAN_STD_ID_MASK, false},
+        {ID_SOC,     CAN_STD_ID_MASK, false},
+        {ID_TEMP,    CAN_STD_ID_MASK, false},
+        {ID_STATUS,  CAN_STD_ID_MASK, false},
+        {ID_ALARM,   CAN_STD_ID_MASK, false}
+    };
+    
+    PylontechCan() : CanProtocolBase() {}
     
     const char* getName() const override { 
         return "Pylontech CAN"; 
@@ -40,8 +78,9 @@ public:
         return BMS_PYLONTECH; 
     }
     
-    bool canAcceptMessage(uint32_t canId) const override {
-        return (canId == ID_VOLTAGE || 
+    bool canAcceptMessage(uint32_t canId, bool extended) const override {
+        return !extended &&
+               (canId == ID_VOLTAGE || 
                 canId == ID_CURRENT || 
                 canId == ID_SOC || 
                 canId == ID_TEMP ||
@@ -49,113 +88,27 @@ public:
                 canId == ID_ALARM);
     }
     
-    bool parseMessage(uint32_t canId, const uint8_t* data, uint8_t length) override {
-        if (length < 8) {
-            markError();
-            return false;
-        }
-        
-        bool parsed = false;
-        
-        switch (canId) {
-            case ID_VOLTAGE: {
-                uint16_t rawVoltage = extractUint16(data, 0, true);
-                m_data.voltage = rawVoltage * 0.01f;
-                
-                if (validateRange(m_data.voltage, 40.0f, 60.0f)) {
-                    m_voltageReceived = true;
-                    parsed = true;
-                    Serial.printf("[Pylontech] Voltage: %.2f V\n", m_data.voltage);
-                }
-                break;
-            }
-            
-            case ID_CURRENT: {
-                int16_t rawCurrent = extractInt16(data, 0, true);
-                m_data.current = rawCurrent * 0.1f;
-                
-                m_data.charging = (m_data.current > 0.5f);
-                m_data.discharging = (m_data.current < -0.5f);
-                
-                m_currentReceived = true;
-                parsed = true;
-                
-                const char* status = m_data.charging ? "Charging" : 
-                                    (m_data.discharging ? "Discharging" : "Idle");
-                Serial.printf("[Pylontech] Current: %.1f A (%s)\n", m_data.current, status);
-                break;
-            }
-            
-            case ID_SOC: {
-                uint16_t rawSoc = extractUint16(data, 0, true);
-                m_data.soc = rawSoc * 0.1f;
-                
-                if (validateRange(m_data.soc, 0.0f, 100.0f)) {
-                    m_socReceived = true;
-                    parsed = true;
-                    Serial.printf("[Pylontech] SOC: %.1f %%\n", m_data.soc);
-                }
-                break;
-            }
-            
-            case ID_TEMP: {
-                int16_t rawTemp = extractInt16(data, 0, true);
-                m_data.temperature = rawTemp * 0.1f;
-                
-                if (validateRange(m_data.temperature, -20.0f, 60.0f)) {
-                    parsed = true;
-                    Serial.printf("[Pylontech] Temperature: %.1f °C\n", m_data.temperature);
-                }
-                break;
-            }
-            
-            case ID_STATUS: {
-                m_data.cycles = extractUint16(data, 0, true);
-                snprintf(m_data.status_text, sizeof(m_data.status_text), 
-                         "Online - %u Zyklen", m_data.cycles);
-                parsed = true;
-                Serial.printf("[Pylontech] Cycles: %u\n", m_data.cycles);
-                break;
-            }
-            
-            case ID_ALARM: {
-                uint8_t alarmByte = data[0];
-                
-                if (alarmByte != 0) {
-                    snprintf(m_data.status_text, sizeof(m_data.status_text), 
-                             "ALARM 0x%02X", alarmByte);
-                    Serial.printf("[Pylontech] ALARM: 0x%02X\n", alarmByte);
-                } else {
-                    snprintf(m_data.status_text, sizeof(m_data.status_text), 
-                             "Online");
-                }
-                
-                parsed = true;
-                break;
-            }
-            
-            default:
-                return false;
-        }
-        
-        if (parsed) {
-            markUpdated();
-        } else {
-            markError();
-        }
-        
-        return parsed;
+    size_t getIdFilters(CanIdFilter* filters, size_t maxFilters) const override {
+        return copyFilters(ROUTES, filters, maxFilters);
     }
     
-    bool hasCompleteData() const {
-        return m_voltageReceived && m_currentReceived && m_socReceived;
+    // Zyklus: 0x359, 0x35C, 0x355, 0x356, 0x35E (0x35A nur bei Alarm)
+    uint32_t getCycleMessages() const override {
+        static constexpr uint32_t CYCLE = messageMaskFor(MESSAGES, CYCLE_FIELDS);
+        return CYCLE;
     }
     
-    void resetReceivedFlags() {
-        m_voltageReceived = false;
-        m_currentReceived = false;
-        m_socReceived = false;
+    // 0x35E und 0x35A schreiben beide status_text, daher nie aus dem Cache
+    uint32_t getSharedMessages() const override {
+        static constexpr uint32_t SHARED = sharedMessageMask(MESSAGES);
+        return SHARED;
+    }
+    
+    bool parseMessage(const CanFrame& frame) override {
+        return decodeSignals(MESSAGES, frame);
     }
 };
 
+static_assert(validMessageTable(PylontechCan::MESSAGES), "PylontechCan: Signal außerhalb der Nutzdaten");
+
 #endif // PYLONTECH_CAN_H
@@ -56,6 +56,7 @@ private:
     lv_obj_t* m_bmsSocLabel;
     lv_obj_t* m_bmsTempLabel;
     lv_obj_t* m_bmsCyclesLabel;
+    lv_obj_t* m_bmsCellsLabel;
     lv_obj_t* m_bmsAgeLabel;
     
     // Display Settings Widgets
@@ -72,6 +73,7 @@ private:
     lv_obj_t* m_canAutoDetectSwitch;
     lv_obj_t* m_canProtocolDropdown;
     lv_obj_t* m_canStatusLabel;
+    lv_obj_t* m_canMonitorLabel;
     
     // RS485 Config Widgets
     lv_obj_t* m_rs485BaudrateDropdown;
@@ -200,6 +202,7 @@ public:
     
     // CAN/RS485 Status Update
     void updateCanStatus(const char* status);
+    void updateCanMonitor(const char* text);
     void updateRs485Status(const char* status);
     void updateMqttStatus(const char* status);
     void updateWlanStatus(const char* status, const char* ip = nullptr);
@@ -227,6 +230,7 @@ UIManager::UIManager()
     , m_bmsSocLabel(nullptr)
     , m_bmsTempLabel(nullptr)
     , m_bmsCyclesLabel(nullptr)
+    , m_bmsCellsLabel(nullptr)
     , m_bmsAgeLabel(nullptr)
     , m_brightnessSlider(nullptr)
     , m_brightnessLabel(nullptr)
@@ -236,6 +240,7 @@ UIManager::UIManager()
     , m_canAutoDetectSwitch(nullptr)
     , m_canProtocolDropdown(nullptr)
     , m_canStatusLabel(nullptr)
+    , m_canMonitorLabel(nullptr)
     , m_rs485BaudrateDropdown(nullptr)
     , m_rs485SlaveIdSpinbox(nullptr)
     , m_rs485AutoDetectSwitch(nullptr)
@@ -428,6 +433,7 @@ void UIManager::createBmsDataScreen() {
     m_bmsSocLabel = createLabel(cont, "SOC: -- %", 20, 220, 24);
     m_bmsTempLabel = createLabel(cont, "Temperature: -- °C", 20, 260, 24);
     m_bmsCyclesLabel = createLabel(cont, "Cycles: --", 20, 300, 24);
+    m_bmsCellsLabel = createLabel(cont, "Cells: --", 20, 340, 24);
 }
 
 // ============================================================================
@@ -475,6 +481,11 @@ void UIManager::createCanScreen() {
     
     // Status
     m_canStatusLabel = createLabel(cont, "Status: CAN Bus active, waiting for messages...", 20, y, 16);
+    
+    y += 35;
+    
+    // Bus-Monitor (Buslast, Top-IDs)
+    m_canMonitorLabel = createLabel(cont, "Bus load: --", 20, y, 16);
 }
 
 // ============================================================================
@@ -759,6 +770,16 @@ void UIManager::updateBmsData(const bms_data_t& data) {
     lv_label_set_text_fmt(m_bmsTempLabel, "Temperature: %.1f °C", data.temperature);
     lv_label_set_text_fmt(m_bmsCyclesLabel, "Cycles: %u", data.cycles);
     
+    // Zelldrift
+    const BmsCellStore& cells = data.cells;
+    if (cells.getCellCount() > 0) {
+        lv_label_set_text_fmt(m_bmsCellsLabel, "Cells: %u, %u..%u mV, Delta %u mV (low #%u)",
+                              cells.getCellCount(), cells.getMinMv(), cells.getMaxMv(),
+                              cells.getDeltaMv(), cells.getWeakestCell() + 1u);
+    } else {
+        lv_label_set_text(m_bmsCellsLabel, "Cells: --");
+    }
+    
     lvgl_port_unlock();
 }
 
@@ -774,6 +795,7 @@ void UIManager::showNoConnection() {
     lv_label_set_text(m_bmsSocLabel, "SOC: -- %");
     lv_label_set_text(m_bmsTempLabel, "Temperature: -- °C");
     lv_label_set_text(m_bmsCyclesLabel, "Cycles: --");
+    lv_label_set_text(m_bmsCellsLabel, "Cells: --");
     lvgl_port_unlock();
 }
 
@@ -788,6 +810,13 @@ void UIManager::updateCanStatus(const char* status) {
     lvgl_port_unlock();
 }
 
+void UIManager::updateCanMonitor(const char* text) {
+    if (!m_canMonitorLabel) return;
+    lvgl_port_lock(-1);
+    lv_label_set_text(m_canMonitorLabel, text);
+    lvgl_port_unlock();
+}
+
 void UIManager::updateRs485Status(const char* status) {
     if (!m_rs485StatusLabel) return;
     lvgl_port_lock(-1);